@@ -0,0 +1,141 @@
+/**
+ * @file      : arena.c
+ * @brief     : Defines a growable array whose memory never moves, built
+ *              from fixed-size blocks inside one reserved address range.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#define _DEFAULT_SOURCE // Needed for MAP_ANONYMOUS and MAP_NORESERVE under -std=c11
+
+#include "arena.h"
+#include <stdlib.h>
+#include <sys/mman.h>
+
+/**
+ * @brief Rounds a size up to a whole number of blocks.
+ * @param bytes - The size to round.
+ * @return The rounded size.
+ */
+static size_t round_to_blocks(size_t bytes) {
+    return (bytes + ARENA_BLOCK_BYTES - 1) / ARENA_BLOCK_BYTES * ARENA_BLOCK_BYTES;
+}
+
+/**
+ * @brief Reserves address space for an arena of up to max_bytes.
+ * @param arena - The arena to initialize.
+ * @param max_bytes - Largest size the arena may ever grow to.
+ * @param initial_bytes - Bytes to make usable immediately.
+ * @return 1 if successful, 0 if no memory could be obtained.
+ */
+int arena_init(Arena *arena, size_t max_bytes, size_t initial_bytes) {
+    arena->base = NULL;
+    arena->committed = 0;
+    arena->reserved = round_to_blocks(max_bytes);
+
+    // Inaccessible, unbacked pages: reserving them costs address space only
+    void *base = mmap(NULL, arena->reserved, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        arena->reserved = 0;
+    } else {
+        arena->base = base;
+    }
+    return arena_commit(arena, initial_bytes);
+}
+
+/**
+ * @brief Makes at least bytes bytes of the arena usable.
+ * @param arena - The arena to grow.
+ * @param bytes - Required usable size.
+ * @return 1 if successful, 0 if the reservation is exhausted or memory
+ *         could not be committed.
+ */
+int arena_commit(Arena *arena, size_t bytes) {
+    if (bytes <= arena->committed) {
+        return 1;
+    }
+    size_t target = round_to_blocks(bytes);
+
+    if (arena->reserved == 0) {
+        // Heap fallback: keep growth geometric so appends stay amortized O(1)
+        if (target < arena->committed * 2) {
+            target = arena->committed * 2;
+        }
+        char *temp = realloc(arena->base, target);
+        if (!temp) {
+            return 0;
+        }
+        arena->base = temp;
+        arena->committed = target;
+        return 1;
+    }
+
+    if (target > arena->reserved) {
+        return 0;
+    }
+    if (mprotect(arena->base + arena->committed, target - arena->committed,
+                 PROT_READ | PROT_WRITE) != 0) {
+        return 0;
+    }
+    arena->committed = target;
+    return 1;
+}
+
+/**
+ * @brief Returns the memory beyond the first bytes bytes to the system.
+ * @param arena - The arena to shrink.
+ * @param bytes - Bytes that must stay usable.
+ * @return 1 if successful, 0 if the memory could not be released (the
+ *         arena is unchanged).
+ */
+int arena_trim(Arena *arena, size_t bytes) {
+    size_t target = round_to_blocks(bytes);
+    if (target >= arena->committed) {
+        return 1;
+    }
+
+    if (arena->reserved == 0) {
+        if (target == 0) {
+            free(arena->base);
+            arena->base = NULL;
+            arena->committed = 0;
+            return 1;
+        }
+        char *temp = realloc(arena->base, target);
+        if (!temp) {
+            return 0;
+        }
+        arena->base = temp;
+        arena->committed = target;
+        return 1;
+    }
+
+    // Mapping fresh inaccessible pages over the tail frees its memory and
+    // leaves it reserved, just as arena_init did
+    if (mmap(arena->base + target, arena->committed - target, PROT_NONE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0) == MAP_FAILED) {
+        return 0;
+    }
+    arena->committed = target;
+    return 1;
+}
+
+/**
+ * @brief Releases the arena's memory and address space.
+ * @param arena - The arena to free.
+ */
+void arena_free(Arena *arena) {
+    if (arena->reserved > 0) {
+        munmap(arena->base, arena->reserved);
+    } else {
+        free(arena->base);
+    }
+    arena->base = NULL;
+    arena->reserved = 0;
+    arena->committed = 0;
+}
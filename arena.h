@@ -0,0 +1,73 @@
+/**
+ * @file      : arena.h
+ * @brief     : Declares a growable array whose memory never moves, built
+ *              from fixed-size blocks inside one reserved address range.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_BYTES ((size_t)1 << 16)   /**< Granularity of growth (64 KiB). */
+
+/**
+ * @brief A contiguous array that grows in place.
+ *
+ * The whole maximum size is reserved as inaccessible address space up
+ * front, which costs no memory. Growing makes the next fixed-size blocks
+ * readable and writable, so it is O(1) per block, copies nothing, and
+ * pointers into the array stay valid for its whole life. Where address
+ * space cannot be reserved the arena falls back to realloc, which keeps
+ * the contents but may move them.
+ */
+typedef struct {
+    char *base;          /**< Start of the array. */
+    size_t reserved;     /**< Bytes of address space reserved (0 if heap-backed). */
+    size_t committed;    /**< Bytes currently usable. */
+} Arena;
+
+/**
+ * @brief Reserves address space for an arena of up to max_bytes.
+ * @param arena The arena to initialize.
+ * @param max_bytes Largest size the arena may ever grow to.
+ * @param initial_bytes Bytes to make usable immediately.
+ * @return 1 if successful, 0 if no memory could be obtained.
+ */
+int arena_init(Arena *arena, size_t max_bytes, size_t initial_bytes);
+
+/**
+ * @brief Makes at least bytes bytes of the arena usable.
+ * @param arena The arena to grow.
+ * @param bytes Required usable size.
+ * @return 1 if successful, 0 if the reservation is exhausted or memory
+ *         could not be committed.
+ */
+int arena_commit(Arena *arena, size_t bytes);
+
+/**
+ * @brief Returns the memory beyond the first bytes bytes to the system.
+ *
+ * The released blocks stay reserved, so the arena can grow into them
+ * again. A heap-backed arena is shrunk with realloc and may move.
+ *
+ * @param arena The arena to shrink.
+ * @param bytes Bytes that must stay usable (rounded up to whole blocks).
+ * @return 1 if successful, 0 if the memory could not be released (the
+ *         arena is unchanged).
+ */
+int arena_trim(Arena *arena, size_t bytes);
+
+/**
+ * @brief Releases the arena's memory and address space.
+ * @param arena The arena to free.
+ */
+void arena_free(Arena *arena);
+
+#endif /* ARENA_H */
@@ -0,0 +1,650 @@
+/**
+ * @file      : bench.c
+ * @brief     : Benchmark harness for the vector store's hot paths, built
+ *              optimized by 'make bench'.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ *
+ * Algorithm:
+ * 1. Parse the options (size range, repetitions, threads, output files).
+ * 2. For each store size from --min to --max, in powers of ten, generate a
+ *    synthetic store of that many vectors from a fixed seed.
+ * 3. Run every benchmark once to warm up, then --reps more times, timing
+ *    each repetition with the monotonic clock.
+ * 4. Report the median and best ns per operation, operations per second
+ *    and, for file I/O, MB per second; append a row per benchmark and
+ *    size to the CSV results file.
+ * 5. With --baseline, compare each median against an earlier results
+ *    file and exit with status 1 if any is more than 10% slower.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vector.h"
+#include "io.h"
+#include "expr.h"
+#include "bulk.h"
+#include "pool.h"
+#include "reduce.h"
+#include "simd.h"
+#include "transform.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ===========================================================
+ *                Local Constant Definitions
+ * =========================================================== */
+#define BENCH_MIN_SIZE       1000
+#define BENCH_MAX_SIZE       10000000
+#define BENCH_REPS           5
+#define BENCH_WARMUP         1
+#define BENCH_LOOKUPS        1000000   /**< Lookups / evaluations per repetition. */
+#define BENCH_QUERIES        10000     /**< Nearest-neighbour queries per repetition. */
+#define BENCH_NEAREST_K      10
+#define BENCH_REGRESSION     0.10      /**< Slowdown reported as a regression. */
+#define BENCH_RESULTS        "bench_results.csv"
+#define BENCH_EXPRESSION     "(v1 + v2) x v3 * 2 - v4"
+#define BENCH_NAME_LEN       32
+
+/* ===========================================================
+ *                   Types
+ * =========================================================== */
+
+/**
+ * @brief State shared by the benchmarks of one store size.
+ */
+typedef struct {
+    VectorStore store;     /**< The synthetic store, size vectors. */
+    VectorStore scratch;   /**< Store rebuilt by the add and load benchmarks. */
+    int size;              /**< Vectors in the synthetic store. */
+    char **names;          /**< Name of vector i ("v<i>"). */
+    const char **order;    /**< Names of the store in shuffled order. */
+    Transform rotation;    /**< Transform applied by the transform benchmark. */
+    char csv_path[256];    /**< Scratch CSV file. */
+    char vbin_path[256];   /**< Scratch vbin file. */
+    size_t file_bytes;     /**< Size of the last file written or read. */
+} BenchContext;
+
+/**
+ * @brief One benchmark: untimed setup, the timed run, untimed teardown.
+ * run returns the number of operations it performed.
+ */
+typedef struct {
+    const char *name;
+    void (*setup)(BenchContext *ctx);
+    long long (*run)(BenchContext *ctx);
+    void (*teardown)(BenchContext *ctx);
+    int moves_bytes;       /**< Nonzero to report MB/s from ctx->file_bytes. */
+} Benchmark;
+
+/**
+ * @brief Timing summary of one benchmark at one size.
+ */
+typedef struct {
+    char name[BENCH_NAME_LEN];
+    int size;
+    long long ops;         /**< Operations per repetition. */
+    double median_ns;      /**< Median ns per operation. */
+    double min_ns;         /**< Best ns per operation. */
+    double mb_per_sec;     /**< Throughput of the median run, or 0. */
+} BenchResult;
+
+static volatile float sink;   /**< Keeps results observable to the optimizer. */
+static WorkerPool *bench_pool;
+
+/* ===========================================================
+ *                   Helpers
+ * =========================================================== */
+
+/**
+ * @brief Reads the monotonic clock.
+ * @return Nanoseconds since an arbitrary fixed point.
+ */
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * @brief Returns the next value of a fixed-seed xorshift generator, so
+ * every run benchmarks the same data.
+ * @param state The generator state (nonzero).
+ * @return A pseudo-random 32-bit value.
+ */
+static unsigned int next_random(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Returns a pseudo-random component in [-100, 100).
+ * @param state The generator state.
+ * @return The component.
+ */
+static float random_component(unsigned int *state)
+{
+    return (float)(next_random(state) % 200000) / 1000.0f - 100.0f;
+}
+
+/**
+ * @brief Starts a store that shares the benchmark's worker pool.
+ * @param store The store to initialize.
+ */
+static void start_store(VectorStore *store)
+{
+    init_store(store);
+    store->quiet = 1;
+    store->pool = bench_pool;
+}
+
+/**
+ * @brief Frees a store started with start_store, keeping the shared pool.
+ * @param store The store to free.
+ */
+static void stop_store(VectorStore *store)
+{
+    store->pool = NULL;
+    free_store(store);
+}
+
+/**
+ * @brief Returns the size of a file.
+ * @param path The file.
+ * @return Its size in bytes, or 0 if it cannot be read.
+ */
+static size_t file_size(const char *path)
+{
+    struct stat info;
+    return stat(path, &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+/**
+ * @brief Sorts doubles in place (insertion sort; there are only a few).
+ * @param values The values.
+ * @param count Number of values.
+ */
+static void sort_doubles(double *values, int count)
+{
+    for (int i = 1; i < count; i++) {
+        double value = values[i];
+        int j = i - 1;
+        for (; j >= 0 && values[j] > value; j--) {
+            values[j + 1] = values[j];
+        }
+        values[j + 1] = value;
+    }
+}
+
+/* ===========================================================
+ *                   Context
+ * =========================================================== */
+
+/**
+ * @brief Generates the synthetic store and lookup order for one size.
+ * @param ctx The context to fill.
+ * @param size Number of vectors.
+ * @param dir Directory for the scratch files.
+ * @return 1 if successful, 0 if memory ran out.
+ */
+static int context_init(BenchContext *ctx, int size, const char *dir)
+{
+    unsigned int state = 2463534242u;
+    char error[TRANSFORM_ERROR_LEN];
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->size = size;
+    snprintf(ctx->csv_path, sizeof(ctx->csv_path), "%s/vectorcalc_bench_%d.csv", dir, (int)getpid());
+    snprintf(ctx->vbin_path, sizeof(ctx->vbin_path), "%s/vectorcalc_bench_%d.vbin", dir, (int)getpid());
+    start_store(&ctx->store);
+    ctx->names = malloc((size_t)size * sizeof(char *));
+    ctx->order = malloc((size_t)size * sizeof(char *));
+    if (!ctx->names || !ctx->order || !reserve_vectors(&ctx->store, size)) {
+        return 0;
+    }
+    for (int i = 0; i < size; i++) {
+        char name[BENCH_NAME_LEN];
+        int length = snprintf(name, sizeof(name), "v%d", i);
+        vector v;
+        v.x = random_component(&state);
+        v.y = random_component(&state);
+        v.z = random_component(&state);
+        v.id = store_name(&ctx->store, name, (size_t)length);
+        if (v.id == NO_NAME || !add_vector(&ctx->store, v)) {
+            return 0;
+        }
+    }
+    // Name pointers are taken only once the name table has stopped growing
+    for (int i = 0; i < size; i++) {
+        ctx->names[i] = (char *)vector_name(&ctx->store, &ctx->store.vectors[i]);
+        ctx->order[i] = ctx->names[i];
+    }
+    // Fisher-Yates shuffle so lookups do not walk memory in order
+    for (int i = size - 1; i > 0; i--) {
+        int j = (int)(next_random(&state) % (unsigned int)(i + 1));
+        const char *temp = ctx->order[i];
+        ctx->order[i] = ctx->order[j];
+        ctx->order[j] = temp;
+    }
+
+    transform_parse("quat 0.9 0.1 0.3 0.2", &ctx->rotation, error);
+    return 1;
+}
+
+/**
+ * @brief Frees a context and removes its scratch files.
+ * @param ctx The context to free.
+ */
+static void context_free(BenchContext *ctx)
+{
+    stop_store(&ctx->store);
+    free(ctx->names);
+    free(ctx->order);
+    remove(ctx->csv_path);
+    remove(ctx->vbin_path);
+}
+
+/* ===========================================================
+ *                   Benchmarks
+ * =========================================================== */
+
+static void setup_scratch(BenchContext *ctx)
+{
+    start_store(&ctx->scratch);
+}
+
+static void teardown_scratch(BenchContext *ctx)
+{
+    stop_store(&ctx->scratch);
+}
+
+// Interns a name and appends a vector, growing the store from empty
+static long long run_add(BenchContext *ctx)
+{
+    for (int i = 0; i < ctx->size; i++) {
+        vector v = ctx->store.vectors[i];
+        v.id = store_name(&ctx->scratch, ctx->names[i], strlen(ctx->names[i]));
+        add_vector(&ctx->scratch, v);
+    }
+    return ctx->size;
+}
+
+// Looks names up in shuffled order
+static long long run_find(BenchContext *ctx)
+{
+    float sum = 0;
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        vector *v = find_vector(&ctx->store, ctx->order[i % ctx->size]);
+        sum += v->x;
+    }
+    sink = sum;
+    return BENCH_LOOKUPS;
+}
+
+// Evaluates a cached expression with four operands
+static long long run_expression(BenchContext *ctx)
+{
+    vector result;
+    float sum = 0;
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        evaluate_expression(&ctx->store, BENCH_EXPRESSION, &result);
+        sum += result.x;
+    }
+    sink = sum;
+    return BENCH_LOOKUPS;
+}
+
+static long long run_save_csv(BenchContext *ctx)
+{
+    save_vectors(&ctx->store, ctx->csv_path);
+    ctx->file_bytes = file_size(ctx->csv_path);
+    return ctx->size;
+}
+
+static void setup_load_csv(BenchContext *ctx)
+{
+    save_vectors(&ctx->store, ctx->csv_path);
+    ctx->file_bytes = file_size(ctx->csv_path);
+    start_store(&ctx->scratch);
+}
+
+static long long run_load_csv(BenchContext *ctx)
+{
+    load_vectors(&ctx->scratch, ctx->csv_path);
+    return ctx->size;
+}
+
+static long long run_save_vbin(BenchContext *ctx)
+{
+    save_vectors_vbin(&ctx->store, ctx->vbin_path);
+    ctx->file_bytes = file_size(ctx->vbin_path);
+    return ctx->size;
+}
+
+static void setup_load_vbin(BenchContext *ctx)
+{
+    save_vectors_vbin(&ctx->store, ctx->vbin_path);
+    ctx->file_bytes = file_size(ctx->vbin_path);
+    start_store(&ctx->scratch);
+}
+
+static long long run_load_vbin(BenchContext *ctx)
+{
+    load_vectors_vbin(&ctx->scratch, ctx->vbin_path);
+    return ctx->size;
+}
+
+// Scales every vector by a factor close to 1, so values stay bounded
+static long long run_broadcast(BenchContext *ctx)
+{
+    char error[EXPR_ERROR_LEN];
+    int updated;
+    broadcast_vectors(&ctx->store, "all", "all * 0.999", &updated, error);
+    return ctx->size;
+}
+
+static long long run_reduce(BenchContext *ctx)
+{
+    Reduction red;
+    reduce_store(&ctx->store, &red);
+    sink = red.sum.x;
+    return ctx->size;
+}
+
+static long long run_transform(BenchContext *ctx)
+{
+    transform_vectors(&ctx->store, "all", &ctx->rotation);
+    return ctx->size;
+}
+
+// Builds the k-d tree untimed, then times queries
+static void setup_nearest(BenchContext *ctx)
+{
+    vector *found[BENCH_NEAREST_K];
+    float dist[BENCH_NEAREST_K];
+    nearest_vectors(&ctx->store, ctx->store.vectors[0], BENCH_NEAREST_K, found, dist);
+}
+
+static long long run_nearest(BenchContext *ctx)
+{
+    vector *found[BENCH_NEAREST_K];
+    float dist[BENCH_NEAREST_K];
+    int queries = BENCH_QUERIES;
+    for (int i = 0; i < queries; i++) {
+        vector q = ctx->store.vectors[(int)((long long)i * 7919 % ctx->size)];
+        q.x += 0.5f;
+        nearest_vectors(&ctx->store, q, BENCH_NEAREST_K, found, dist);
+    }
+    sink = dist[0];
+    return queries;
+}
+
+static const Benchmark benchmarks[] = {
+    { "add_vector", setup_scratch, run_add, teardown_scratch, 0 },
+    { "find_vector", NULL, run_find, NULL, 0 },
+    { "expression", NULL, run_expression, NULL, 0 },
+    { "save_csv", NULL, run_save_csv, NULL, 1 },
+    { "load_csv", setup_load_csv, run_load_csv, teardown_scratch, 1 },
+    { "save_vbin", NULL, run_save_vbin, NULL, 1 },
+    { "load_vbin", setup_load_vbin, run_load_vbin, teardown_scratch, 1 },
+    { "broadcast", NULL, run_broadcast, NULL, 0 },
+    { "reduce", NULL, run_reduce, NULL, 0 },
+    { "transform", NULL, run_transform, NULL, 0 },
+    { "nearest", setup_nearest, run_nearest, NULL, 0 },
+};
+
+/* ===========================================================
+ *                   Driver
+ * =========================================================== */
+
+/**
+ * @brief Runs one benchmark with warmup and repetitions.
+ *
+ * Setup and teardown run around every repetition, untimed, so each
+ * repetition starts from the same state (e.g., an empty scratch store).
+ *
+ * @param bench The benchmark.
+ * @param ctx The context for the current size.
+ * @param reps Timed repetitions.
+ * @param out Receives the summary.
+ */
+static void run_benchmark(const Benchmark *bench, BenchContext *ctx, int reps, BenchResult *out)
+{
+    double times[BENCH_WARMUP + 64];
+    long long ops = 0;
+
+    for (int i = 0; i < BENCH_WARMUP + reps; i++) {
+        if (bench->setup) {
+            bench->setup(ctx);
+        }
+        double start = now_ns();
+        ops = bench->run(ctx);
+        double elapsed = now_ns() - start;
+        if (bench->teardown) {
+            bench->teardown(ctx);
+        }
+        if (i >= BENCH_WARMUP) {
+            times[i - BENCH_WARMUP] = elapsed;
+        }
+    }
+
+    sort_doubles(times, reps);
+    double median = reps % 2 ? times[reps / 2] : (times[reps / 2 - 1] + times[reps / 2]) / 2;
+    snprintf(out->name, sizeof(out->name), "%s", bench->name);
+    out->size = ctx->size;
+    out->ops = ops;
+    out->median_ns = median / (double)ops;
+    out->min_ns = times[0] / (double)ops;
+    out->mb_per_sec = bench->moves_bytes ? (double)ctx->file_bytes / (median / 1e9) / 1e6 : 0;
+}
+
+/**
+ * @brief Looks up a benchmark's median in a baseline results file.
+ * @param baseline Contents of the baseline file, one CSV row per line.
+ * @param result The result to match by name and size.
+ * @return The baseline median ns per operation, or 0 if absent.
+ */
+static double baseline_median(const char *baseline, const BenchResult *result)
+{
+    char prefix[BENCH_NAME_LEN + 16];
+    int length = snprintf(prefix, sizeof(prefix), "%s,%d,", result->name, result->size);
+    for (const char *line = baseline; line != NULL && *line != '\0'; ) {
+        if (strncmp(line, prefix, (size_t)length) == 0) {
+            long long ops;
+            double median;
+            if (sscanf(line + length, "%lld,%lf", &ops, &median) == 2) {
+                return median;
+            }
+        }
+        line = strchr(line, '\n');
+        line = line ? line + 1 : NULL;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads a whole text file.
+ * @param path The file.
+ * @return The contents (caller frees), or NULL if unreadable.
+ */
+static char *read_text(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return NULL;
+    }
+    size_t size = file_size(path);
+    char *text = malloc(size + 1);
+    if (text != NULL) {
+        text[fread(text, 1, size, file)] = '\0';
+    }
+    fclose(file);
+    return text;
+}
+
+/**
+ * @brief Prints the harness's options.
+ */
+static void print_usage(void)
+{
+    printf("Usage: ./vectorcalc_bench [OPTION]...\n\n");
+    printf("  --min N          Smallest store size (default %d)\n", BENCH_MIN_SIZE);
+    printf("  --max N          Largest store size, sizes step by 10x (default %d)\n",
+           BENCH_MAX_SIZE);
+    printf("  --reps N         Timed repetitions after %d warmup run (default %d)\n",
+           BENCH_WARMUP, BENCH_REPS);
+    printf("  -j N             Worker threads for the parallel paths (default 1)\n");
+    printf("  --only NAME      Run only benchmarks whose name contains NAME\n");
+    printf("  --out FILE       Results CSV (default %s)\n", BENCH_RESULTS);
+    printf("  --baseline FILE  Compare with an earlier results CSV; exit 1 if any\n");
+    printf("                   median is more than %.0f%% slower\n", BENCH_REGRESSION * 100);
+    printf("  --dir DIR        Directory for scratch files (default $TMPDIR or /tmp)\n");
+}
+
+/**
+ * @brief Parses a positive integer option value.
+ * @param text The value.
+ * @param out Receives the value.
+ * @return 1 if text is a positive integer, 0 otherwise.
+ */
+static int parse_count(const char *text, int *out)
+{
+    char *end;
+    long value = strtol(text, &end, 10);
+    if (*end != '\0' || value < 1 || value > BENCH_MAX_SIZE * 10L) {
+        return 0;
+    }
+    *out = (int)value;
+    return 1;
+}
+
+/**
+ * @brief Main entry point for the benchmark harness.
+ * @param argc The count of command-line arguments.
+ * @param argv The command-line arguments.
+ * @return 0 on success, 1 on a bad option or a regression, 4 on an I/O error.
+ */
+int main(int argc, char *argv[])
+{
+    int min_size = BENCH_MIN_SIZE;
+    int max_size = BENCH_MAX_SIZE;
+    int reps = BENCH_REPS;
+    int threads = 1;
+    const char *only = NULL;
+    const char *out_path = BENCH_RESULTS;
+    const char *baseline_path = NULL;
+    const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+
+    for (int i = 1; i < argc; i++) {
+        int ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--min") == 0) {
+            ok = parse_count(argv[++i], &min_size);
+        } else if (ok && strcmp(argv[i], "--max") == 0) {
+            ok = parse_count(argv[++i], &max_size);
+        } else if (ok && strcmp(argv[i], "--reps") == 0) {
+            ok = parse_count(argv[++i], &reps) && reps <= 64;
+        } else if (ok && strcmp(argv[i], "-j") == 0) {
+            ok = parse_count(argv[++i], &threads);
+        } else if (ok && strcmp(argv[i], "--only") == 0) {
+            only = argv[++i];
+        } else if (ok && strcmp(argv[i], "--out") == 0) {
+            out_path = argv[++i];
+        } else if (ok && strcmp(argv[i], "--baseline") == 0) {
+            baseline_path = argv[++i];
+        } else if (ok && strcmp(argv[i], "--dir") == 0) {
+            dir = argv[++i];
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            print_usage();
+            return 1;
+        }
+    }
+
+    char *baseline = NULL;
+    if (baseline_path != NULL && (baseline = read_text(baseline_path)) == NULL) {
+        fprintf(stderr, "Error: could not read the baseline '%s'\n", baseline_path);
+        return 4;
+    }
+    FILE *out = fopen(out_path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Error: could not open file '%s'\n", out_path);
+        free(baseline);
+        return 4;
+    }
+    bench_pool = threads > 1 ? pool_create(threads) : NULL;
+
+    printf("vectorcalc benchmarks: simd %s, %d thread%s, %d warmup + %d reps\n\n",
+           simd_level_name(simd_level()), threads, threads == 1 ? "" : "s", BENCH_WARMUP, reps);
+    printf("%-12s %10s %12s %12s %14s %10s%s\n", "benchmark", "size", "median ns/op",
+           "best ns/op", "ops/s", "MB/s", baseline ? "  vs baseline" : "");
+    fprintf(out, "benchmark,size,ops,median_ns_per_op,min_ns_per_op,ops_per_sec,mb_per_sec,simd,threads\n");
+
+    int regressions = 0;
+    int status = 0;
+    for (long long size = min_size; size <= max_size && status == 0; size *= 10) {
+        BenchContext ctx;
+        if (!context_init(&ctx, (int)size, dir)) {
+            fprintf(stderr, "Memory allocation failed at size %lld.\n", size);
+            context_free(&ctx);
+            status = 4;
+            break;
+        }
+        for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+            if (only != NULL && strstr(benchmarks[b].name, only) == NULL) {
+                continue;
+            }
+            BenchResult result;
+            run_benchmark(&benchmarks[b], &ctx, reps, &result);
+
+            printf("%-12s %10d %12.1f %12.1f %14.0f", result.name, result.size,
+                   result.median_ns, result.min_ns, 1e9 / result.median_ns);
+            if (result.mb_per_sec > 0) {
+                printf(" %10.1f", result.mb_per_sec);
+            } else {
+                printf(" %10s", "-");
+            }
+            double base = baseline ? baseline_median(baseline, &result) : 0;
+            if (base > 0) {
+                double change = (result.median_ns - base) / base;
+                bool slower = change > BENCH_REGRESSION;
+                regressions += slower;
+                printf("  %+6.1f%%%s", change * 100, slower ? "  REGRESSION" : "");
+            }
+            printf("\n");
+            fflush(stdout);
+
+            fprintf(out, "%s,%d,%lld,%.3f,%.3f,%.0f,%.1f,%s,%d\n", result.name, result.size,
+                    result.ops, result.median_ns, result.min_ns, 1e9 / result.median_ns,
+                    result.mb_per_sec, simd_level_name(simd_level()), threads);
+        }
+        context_free(&ctx);
+    }
+
+    fclose(out);
+    pool_free(bench_pool);
+    free(baseline);
+    printf("\nResults written to %s.\n", out_path);
+    if (regressions > 0) {
+        printf("%d benchmark%s regressed by more than %.0f%%.\n", regressions,
+               regressions == 1 ? "" : "s", BENCH_REGRESSION * 100);
+        return status ? status : 1;
+    }
+    return status;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file      : bulk.c
+ * @brief     : Defines whole-store broadcast operations that apply one
+ *              expression or transformation to every matching vector.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "bulk.h"
+#include "expr.h"
+#include "pool.h"
+#include "soa.h"
+#include "util.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Runs body once for every vector v in [begin, end) selected by the
+ * pattern. Selecting "all" skips the name test entirely, so the loop
+ * touches only the components.
+ */
+#define FOR_EACH_MATCH(job, begin, end, v, body)                          \
+    do {                                                                  \
+        for (vector *v = (begin); v < (end); v++) {                       \
+            if ((job)->match_all ||                                       \
+                glob_match((job)->pattern, vector_name((job)->store, v))) {\
+                body                                                      \
+            }                                                             \
+        }                                                                 \
+    } while (0)
+
+/**
+ * @brief State shared by the chunk tasks of one bulk job.
+ */
+typedef struct {
+    VectorStore *store;        /**< The store being updated. */
+    const char *pattern;       /**< Pattern selecting the targets. */
+    int match_all;             /**< Nonzero when pattern is "all". */
+    const BroadcastPlan *plan; /**< Prepared broadcast, if any. */
+    int *updated;              /**< Vectors changed, one count per chunk. */
+} BulkJob;
+
+/**
+ * @brief Sets up a bulk job and its per-chunk counters.
+ * @param job - The job to initialize.
+ * @param store - The store being updated.
+ * @param pattern - Pattern selecting the targets.
+ * @param chunks - Number of chunks the store is split into.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+static int bulk_job_init(BulkJob *job, VectorStore *store, const char *pattern, int chunks) {
+    job->store = store;
+    job->pattern = pattern;
+    job->match_all = strcmp(pattern, BULK_ALL) == 0;
+    job->plan = NULL;
+    job->updated = calloc(chunks > 0 ? (size_t)chunks : 1, sizeof(int));
+    return job->updated != NULL;
+}
+
+/**
+ * @brief Adds up the per-chunk counters and frees them.
+ * @param job - The finished job.
+ * @param chunks - Number of chunks.
+ * @return The total number of vectors changed.
+ */
+static int bulk_job_finish(BulkJob *job, int chunks) {
+    int total = 0;
+    for (int i = 0; i < chunks; i++) {
+        total += job->updated[i];
+    }
+    free(job->updated);
+    return total;
+}
+
+/**
+ * @brief Maps a fixed-operation broadcast onto its column kernel.
+ * @param kind - The plan's kind.
+ * @param op - Receives the matching soa_op_t.
+ * @return 1 if the kind has a column kernel, 0 otherwise.
+ */
+static int column_op(bcast_kind_t kind, soa_op_t *op) {
+    switch (kind) {
+    case BCAST_NEGATE: *op = SOA_NEGATE; return 1;
+    case BCAST_ADD:    *op = SOA_ADD;    return 1;
+    case BCAST_SUB:    *op = SOA_SUB;    return 1;
+    case BCAST_RSUB:   *op = SOA_RSUB;   return 1;
+    case BCAST_MULT:   *op = SOA_MULT;   return 1;
+    case BCAST_CROSS:  *op = SOA_CROSS;  return 1;
+    case BCAST_RCROSS: *op = SOA_RCROSS; return 1;
+    case BCAST_DOT:    *op = SOA_DOT;    return 1;
+    default:           return 0;
+    }
+}
+
+/**
+ * @brief Applies a broadcast plan to one chunk of the store.
+ * @param context - The BulkJob.
+ * @param task - Index of the chunk.
+ */
+static void broadcast_chunk(void *context, int task) {
+    BulkJob *job = context;
+    const BroadcastPlan *plan = job->plan;
+    int first = task * POOL_CHUNK_VECTORS;
+    int last = first + POOL_CHUNK_VECTORS;
+    if (last > job->store->count) {
+        last = job->store->count;
+    }
+    vector *begin = job->store->vectors + first;
+    vector *end = job->store->vectors + last;
+    int count = 0;
+    soa_op_t op;
+
+    if (column_op(plan->kind, &op)) {
+        // Transpose the matches into columns so the kernels use full-width loads
+        float columns[3][POOL_CHUNK_VECTORS];
+        int slots[POOL_CHUNK_VECTORS];
+        const int *picked = NULL;
+        if (job->match_all) {
+            count = last - first;
+        } else {
+            FOR_EACH_MATCH(job, begin, end, v, { slots[count++] = (int)(v - begin); });
+            picked = slots;
+        }
+        vector c = plan->c;
+        if (op == SOA_MULT) {
+            c.x = plan->s;
+        }
+        soa_gather(begin, picked, count, columns[0], columns[1], columns[2]);
+        soa_apply(op, c, columns[0], columns[1], columns[2], count);
+        soa_scatter(begin, picked, count, columns[0], columns[1], columns[2]);
+    } else if (plan->kind == BCAST_IDENTITY) {
+        FOR_EACH_MATCH(job, begin, end, v, { count++; });
+    } else {
+        FOR_EACH_MATCH(job, begin, end, v, {
+            ExprValue value;
+            expr_eval_element(plan, v, &value);
+            if (value.type == EXPR_SCALAR) {
+                v->x = value.s; v->y = 0; v->z = 0;
+            } else {
+                v->x = value.v.x; v->y = value.v.y; v->z = value.v.z;
+            }
+            count++;
+        });
+    }
+    job->updated[task] = count;
+}
+
+/**
+ * @brief Normalizes the matching vectors of one chunk of the store.
+ * @param context - The BulkJob.
+ * @param task - Index of the chunk.
+ */
+static void normalize_chunk(void *context, int task) {
+    BulkJob *job = context;
+    int first = task * POOL_CHUNK_VECTORS;
+    int last = first + POOL_CHUNK_VECTORS;
+    if (last > job->store->count) {
+        last = job->store->count;
+    }
+    int count = 0;
+
+    FOR_EACH_MATCH(job, job->store->vectors + first, job->store->vectors + last, v, {
+        float length_sq = v->x * v->x + v->y * v->y + v->z * v->z;
+        if (length_sq > 0.0f) {
+            float inverse = 1.0f / sqrtf(length_sq);
+            v->x *= inverse; v->y *= inverse; v->z *= inverse;
+            count++;
+        }
+    });
+    job->updated[task] = count;
+}
+
+/**
+ * @brief Checks whether a left-hand side names a set of vectors.
+ * @param pattern - The candidate pattern.
+ * @return 1 for "all" or any text containing '*' or '?', 0 otherwise.
+ */
+int is_broadcast_pattern(const char *pattern) {
+    return strcmp(pattern, BULK_ALL) == 0 || strpbrk(pattern, "*?") != NULL;
+}
+
+/**
+ * @brief Replaces every vector matching pattern with source evaluated for it.
+ * @param store - The store to update.
+ * @param pattern - "all" or a '*' / '?' pattern selecting the targets.
+ * @param source - The right-hand side expression.
+ * @param updated - Receives the number of vectors changed.
+ * @param error - Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK or one of the EXPR_* error codes.
+ */
+int broadcast_vectors(VectorStore *store, const char *pattern, const char *source,
+                      int *updated, char *error) {
+    Expr *expr;
+    BroadcastPlan plan;
+
+    *updated = 0;
+    refresh_vectors(store);
+    int status = expr_cache_get(store, source, pattern, &expr, error);
+    if (status == EXPR_OK) {
+        status = expr_plan_broadcast(expr, store, &plan, error);
+    }
+    if (status != EXPR_OK) {
+        return status;
+    }
+
+    // Chunks only touch their own vectors; the plan holds copies of the rest
+    BulkJob job;
+    int chunks = pool_chunks(store->count);
+    if (!bulk_job_init(&job, store, pattern, chunks)) {
+        snprintf(error, EXPR_ERROR_LEN, "Memory allocation failed.");
+        return EXPR_NO_MEMORY;
+    }
+    job.plan = &plan;
+    pool_run(store->pool, chunks, broadcast_chunk, &job);
+    *updated = bulk_job_finish(&job, chunks);
+    note_vector_change(store, -1);
+    return EXPR_OK;
+}
+
+/**
+ * @brief Scales every vector matching pattern to unit length.
+ * @param store - The store to update.
+ * @param pattern - "all", a '*' / '?' pattern, or a single name.
+ * @return The number of vectors normalized.
+ */
+int normalize_vectors(VectorStore *store, const char *pattern) {
+    BulkJob job;
+    refresh_vectors(store);
+    int chunks = pool_chunks(store->count);
+    if (!bulk_job_init(&job, store, pattern, chunks)) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return 0;
+    }
+    pool_run(store->pool, chunks, normalize_chunk, &job);
+    note_vector_change(store, -1);
+    return bulk_job_finish(&job, chunks);
+}
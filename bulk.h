@@ -0,0 +1,57 @@
+/**
+ * @file      : bulk.h
+ * @brief     : Declares whole-store broadcast operations that apply one
+ *              expression or transformation to every matching vector.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef BULK_H
+#define BULK_H
+
+#include "vector.h"
+
+#define BULK_ALL "all"     /**< Pattern that selects every stored vector. */
+
+/**
+ * @brief Checks whether a left-hand side names a set of vectors rather
+ * than a single one.
+ * @param pattern The candidate pattern.
+ * @return 1 for "all" or any text containing '*' or '?', 0 otherwise.
+ */
+int is_broadcast_pattern(const char *pattern);
+
+/**
+ * @brief Replaces every vector matching pattern with source evaluated
+ * for that vector (e.g., pattern "all" and source "all * 2").
+ *
+ * Inside source, the exact pattern text stands for the vector being
+ * updated. The expression is compiled once, every other named operand is
+ * read once before the loop, and the common "element op constant" forms
+ * run as a single fixed operation per vector. A scalar result is stored
+ * in x with y and z set to 0.
+ *
+ * @param store The store to update.
+ * @param pattern "all" or a '*' / '?' pattern selecting the targets.
+ * @param source The right-hand side expression.
+ * @param updated Receives the number of vectors changed.
+ * @param error Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK or one of the EXPR_* error codes.
+ */
+int broadcast_vectors(VectorStore *store, const char *pattern, const char *source,
+                      int *updated, char *error);
+
+/**
+ * @brief Scales every vector matching pattern to unit length.
+ * Zero-length vectors are left unchanged.
+ * @param store The store to update.
+ * @param pattern "all", a '*' / '?' pattern, or a single name.
+ * @return The number of vectors normalized.
+ */
+int normalize_vectors(VectorStore *store, const char *pattern);
+
+#endif /* BULK_H */
@@ -0,0 +1,1114 @@
+/**
+ * @file      : expr.c
+ * @brief     : Defines the vector expression compiler, its bytecode
+ *              interpreter and the per-store cache of compiled expressions.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "expr.h"
+#include "util.h"
+#include "formula.h"
+#include "wide.h"
+#include "stats.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EXPR_CACHE_INITIAL 16
+#define EXPR_CACHE_LIMIT   4096   /**< Entries kept before the cache is flushed. */
+
+/**
+ * @brief Open-addressing table of compiled expressions keyed by source.
+ */
+struct ExprCache {
+    Expr **entries;    /**< Buckets; NULL marks an empty bucket. */
+    int capacity;      /**< Number of buckets (power of two). */
+    int count;         /**< Number of cached expressions. */
+};
+
+/* ==================== Lexer ==================== */
+
+/** Kinds of token produced by the lexer. */
+typedef enum {
+    TOK_END,           /**< End of the expression text. */
+    TOK_NUMBER,        /**< A numeric literal. */
+    TOK_NAME,          /**< A vector name (or a bare x used as cross). */
+    TOK_ELEM,          /**< The broadcast element pattern. */
+    TOK_SYMBOL,        /**< One of + - * ( ). */
+    TOK_INVALID        /**< Any other character. */
+} token_kind_t;
+
+/**
+ * @brief One token, pointing back into the source text.
+ */
+typedef struct {
+    token_kind_t kind;
+    const char *start;     /**< First character of the token. */
+    int length;            /**< Number of characters in the token. */
+    float value;           /**< Value of a TOK_NUMBER. */
+} Token;
+
+/**
+ * @brief State shared by the recursive-descent compiler.
+ */
+typedef struct {
+    const char *cursor;    /**< Next unread character. */
+    const char *end;       /**< End of the source text. */
+    const char *element;   /**< Broadcast pattern, or NULL. */
+    size_t element_length; /**< Length of the broadcast pattern. */
+    Token token;           /**< Current lookahead token. */
+    Expr *expr;            /**< Expression being built. */
+    int code_capacity;
+    int const_capacity;
+    int operand_capacity;
+    int vec_depth;         /**< Vectors on the stack at this point of the code. */
+    int scalar_depth;      /**< Scalars on the stack at this point of the code. */
+    int status;            /**< First error, EXPR_OK while none. */
+    char *error;           /**< Message buffer supplied by the caller. */
+} Parser;
+
+/**
+ * @brief Reads the next token from the source into parser->token.
+ * @param parser - The compiler state.
+ */
+static void next_token(Parser *parser) {
+    const char *p = parser->cursor;
+    while (p < parser->end && isspace((unsigned char)*p)) {
+        p++;
+    }
+
+    Token *token = &parser->token;
+    token->start = p;
+    token->length = 0;
+
+    size_t remaining = (size_t)(parser->end - p);
+    const char *after_element = p + parser->element_length;
+
+    if (p == parser->end) {
+        token->kind = TOK_END;
+    } else if (parser->element != NULL && remaining >= parser->element_length &&
+               memcmp(p, parser->element, parser->element_length) == 0 &&
+               (after_element == parser->end ||
+                !(isalnum((unsigned char)*after_element) || *after_element == '_'))) {
+        // The pattern must appear exactly as written on the left-hand side
+        token->kind = TOK_ELEM;
+        token->length = (int)parser->element_length;
+    } else if (isdigit((unsigned char)*p) || *p == '.') {
+        const char *after = parse_float(p, parser->end, &token->value);
+        if (after == NULL) {
+            token->kind = TOK_INVALID;
+            token->length = 1;
+        } else {
+            token->kind = TOK_NUMBER;
+            token->length = (int)(after - p);
+        }
+    } else if (isalpha((unsigned char)*p) || *p == '_') {
+        const char *q = p;
+        while (q < parser->end && (isalnum((unsigned char)*q) || *q == '_')) {
+            q++;
+        }
+        token->kind = TOK_NAME;
+        token->length = (int)(q - p);
+    } else if (strchr("+-*()", *p) != NULL) {
+        token->kind = TOK_SYMBOL;
+        token->length = 1;
+    } else {
+        token->kind = TOK_INVALID;
+        token->length = 1;
+    }
+    parser->cursor = p + token->length;
+}
+
+/**
+ * @brief Tests whether the current token is a given single-character symbol.
+ * @param parser - The compiler state.
+ * @param symbol - The symbol to test for.
+ * @return 1 if it matches, 0 otherwise.
+ */
+static int token_is(const Parser *parser, char symbol) {
+    return parser->token.kind == TOK_SYMBOL && parser->token.start[0] == symbol;
+}
+
+/**
+ * @brief Tests whether the current token is the cross product operator.
+ * @param parser - The compiler state.
+ * @return 1 if the token is a bare x or X, 0 otherwise.
+ */
+static int token_is_cross(const Parser *parser) {
+    return parser->token.kind == TOK_NAME && parser->token.length == 1 &&
+           (parser->token.start[0] == 'x' || parser->token.start[0] == 'X');
+}
+
+/* ==================== Code Generation ==================== */
+
+/**
+ * @brief Records the first compile error.
+ * @param parser - The compiler state.
+ * @param status - The EXPR_* code.
+ * @param message - Text copied into the caller's error buffer.
+ */
+static void fail(Parser *parser, int status, const char *message) {
+    if (parser->status == EXPR_OK) {
+        parser->status = status;
+        snprintf(parser->error, EXPR_ERROR_LEN, "%s", message);
+    }
+}
+
+/**
+ * @brief Reports a syntax error at the current token.
+ * @param parser - The compiler state.
+ */
+static void fail_syntax(Parser *parser) {
+    char message[EXPR_ERROR_LEN];
+    if (parser->token.kind == TOK_END) {
+        snprintf(message, sizeof(message), "Unexpected end of expression.");
+    } else {
+        snprintf(message, sizeof(message), "Syntax error near '%.*s'.",
+                 parser->token.length, parser->token.start);
+    }
+    fail(parser, EXPR_SYNTAX, message);
+}
+
+/**
+ * @brief Grows an array to hold at least one more element.
+ * @param array - Address of the array pointer.
+ * @param capacity - Address of the current capacity.
+ * @param count - Number of elements in use.
+ * @param size - Size of one element.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+static int grow(void **array, int *capacity, int count, size_t size) {
+    if (count < *capacity) {
+        return 1;
+    }
+    int new_capacity = *capacity > 0 ? *capacity * 2 : 8;
+    void *temp = realloc(*array, (size_t)new_capacity * size);
+    if (!temp) {
+        return 0;
+    }
+    *array = temp;
+    *capacity = new_capacity;
+    return 1;
+}
+
+/**
+ * @brief Appends an instruction and tracks the resulting stack depths.
+ * @param parser - The compiler state.
+ * @param op - The opcode to emit.
+ * @param arg - The opcode's argument (ignored by most opcodes).
+ */
+static void emit(Parser *parser, expr_op_t op, int arg) {
+    Expr *expr = parser->expr;
+    if (!grow((void **)&expr->code, &parser->code_capacity,
+              expr->code_length, sizeof(ExprInstr))) {
+        fail(parser, EXPR_NO_MEMORY, "Memory allocation failed.");
+        return;
+    }
+    expr->code[expr->code_length].op = (unsigned char)op;
+    expr->code[expr->code_length].arg = arg;
+    expr->code_length++;
+
+    switch (op) {
+    case OP_LOAD_VEC:
+    case OP_LOAD_ELEM:  parser->vec_depth++; break;
+    case OP_LOAD_CONST: parser->scalar_depth++; break;
+    case OP_VADD:
+    case OP_VSUB:
+    case OP_VCROSS:     parser->vec_depth--; break;
+    case OP_VDOT:       parser->vec_depth -= 2; parser->scalar_depth++; break;
+    case OP_SVMUL:
+    case OP_VSMUL:
+    case OP_SADD:
+    case OP_SSUB:
+    case OP_SMUL:       parser->scalar_depth--; break;
+    case OP_VNEG:
+    case OP_SNEG:       break;
+    }
+    if (parser->vec_depth > EXPR_MAX_STACK || parser->scalar_depth > EXPR_MAX_STACK) {
+        fail(parser, EXPR_SYNTAX, "Expression is nested too deeply.");
+    }
+}
+
+/**
+ * @brief Returns the operand slot for a name, adding it if new.
+ * @param parser - The compiler state.
+ * @param name - Start of the name in the source.
+ * @param length - Length of the name.
+ * @return The slot index, or -1 if allocation failed.
+ */
+static int operand_slot(Parser *parser, const char *name, int length) {
+    Expr *expr = parser->expr;
+    for (int i = 0; i < expr->operand_count; i++) {
+        if ((int)strlen(expr->operands[i]) == length &&
+            strncmp(expr->operands[i], name, length) == 0) {
+            return i;
+        }
+    }
+
+    if (expr->operand_count >= EXPR_MAX_OPERANDS) {
+        fail(parser, EXPR_SYNTAX, "Expression uses too many different vectors.");
+        return -1;
+    }
+
+    int old_capacity = parser->operand_capacity;
+    if (!grow((void **)&expr->operands, &parser->operand_capacity,
+              expr->operand_count, sizeof(char *))) {
+        fail(parser, EXPR_NO_MEMORY, "Memory allocation failed.");
+        return -1;
+    }
+    if (parser->operand_capacity != old_capacity) {
+        vector_handle *temp = realloc(expr->handles,
+                                      parser->operand_capacity * sizeof(vector_handle));
+        if (!temp) {
+            fail(parser, EXPR_NO_MEMORY, "Memory allocation failed.");
+            return -1;
+        }
+        expr->handles = temp;
+    }
+
+    char *copy = malloc((size_t)length + 1);
+    if (!copy) {
+        fail(parser, EXPR_NO_MEMORY, "Memory allocation failed.");
+        return -1;
+    }
+    memcpy(copy, name, (size_t)length);
+    copy[length] = '\0';
+    expr->operands[expr->operand_count] = copy;
+    expr->handles[expr->operand_count] = NO_HANDLE;
+    return expr->operand_count++;
+}
+
+/**
+ * @brief Adds a scalar literal to the constant pool.
+ * @param parser - The compiler state.
+ * @param value - The literal's value.
+ * @return Its index in the pool, or -1 if allocation failed.
+ */
+static int add_constant(Parser *parser, float value) {
+    Expr *expr = parser->expr;
+    if (!grow((void **)&expr->consts, &parser->const_capacity,
+              expr->const_count, sizeof(float))) {
+        fail(parser, EXPR_NO_MEMORY, "Memory allocation failed.");
+        return -1;
+    }
+    expr->consts[expr->const_count] = value;
+    return expr->const_count++;
+}
+
+/* ==================== Parser ==================== */
+
+static expr_type_t parse_expr(Parser *parser);
+
+/**
+ * @brief primary := number | name | element | '(' expr ')'
+ * @param parser - The compiler state.
+ * @return The type of the value the primary pushes.
+ */
+static expr_type_t parse_primary(Parser *parser) {
+    Token token = parser->token;
+
+    if (token.kind == TOK_ELEM) {
+        next_token(parser);
+        emit(parser, OP_LOAD_ELEM, 0);
+        return EXPR_VECTOR;
+    }
+    if (token.kind == TOK_NUMBER) {
+        next_token(parser);
+        emit(parser, OP_LOAD_CONST, add_constant(parser, token.value));
+        return EXPR_SCALAR;
+    }
+    if (token.kind == TOK_NAME) {
+        next_token(parser);
+        emit(parser, OP_LOAD_VEC, operand_slot(parser, token.start, token.length));
+        return EXPR_VECTOR;
+    }
+    if (token_is(parser, '(')) {
+        next_token(parser);
+        expr_type_t type = parse_expr(parser);
+        if (!token_is(parser, ')')) {
+            fail(parser, EXPR_SYNTAX, "Expected ')'.");
+            return type;
+        }
+        next_token(parser);
+        return type;
+    }
+    fail_syntax(parser);
+    return EXPR_SCALAR;
+}
+
+/**
+ * @brief unary := ('-' | '+') unary | primary
+ *
+ * A minus applied directly to a literal is folded into the constant.
+ *
+ * @param parser - The compiler state.
+ * @return The type of the value the unary expression pushes.
+ */
+static expr_type_t parse_unary(Parser *parser) {
+    if (token_is(parser, '+')) {
+        next_token(parser);
+        return parse_unary(parser);
+    }
+    if (token_is(parser, '-')) {
+        next_token(parser);
+        int start = parser->expr->code_length;
+        expr_type_t type = parse_unary(parser);
+        Expr *expr = parser->expr;
+        if (parser->status != EXPR_OK) {
+            return type;
+        }
+        if (expr->code_length == start + 1 && expr->code[start].op == OP_LOAD_CONST) {
+            expr->consts[expr->code[start].arg] = -expr->consts[expr->code[start].arg];
+        } else {
+            emit(parser, type == EXPR_VECTOR ? OP_VNEG : OP_SNEG, 0);
+        }
+        return type;
+    }
+    return parse_primary(parser);
+}
+
+/**
+ * @brief term := unary (('*' | 'x' | 'X') unary)*
+ * @param parser - The compiler state.
+ * @return The type of the value the term pushes.
+ */
+static expr_type_t parse_term(Parser *parser) {
+    expr_type_t left = parse_unary(parser);
+
+    while (parser->status == EXPR_OK && (token_is(parser, '*') || token_is_cross(parser))) {
+        int cross = token_is_cross(parser);
+        next_token(parser);
+        expr_type_t right = parse_unary(parser);
+        if (parser->status != EXPR_OK) {
+            break;
+        }
+
+        if (cross) {
+            if (left != EXPR_VECTOR || right != EXPR_VECTOR) {
+                fail(parser, EXPR_TYPE, "Cross product needs two vectors.");
+                break;
+            }
+            emit(parser, OP_VCROSS, 0);
+        } else if (left == EXPR_VECTOR && right == EXPR_VECTOR) {
+            emit(parser, OP_VDOT, 0);
+            left = EXPR_SCALAR;
+        } else if (left == EXPR_SCALAR && right == EXPR_VECTOR) {
+            emit(parser, OP_SVMUL, 0);
+            left = EXPR_VECTOR;
+        } else if (left == EXPR_VECTOR) {
+            emit(parser, OP_VSMUL, 0);
+        } else {
+            emit(parser, OP_SMUL, 0);
+        }
+    }
+    return left;
+}
+
+/**
+ * @brief expr := term (('+' | '-') term)*
+ * @param parser - The compiler state.
+ * @return The type of the value the expression pushes.
+ */
+static expr_type_t parse_expr(Parser *parser) {
+    expr_type_t left = parse_term(parser);
+
+    while (parser->status == EXPR_OK && (token_is(parser, '+') || token_is(parser, '-'))) {
+        int subtract = token_is(parser, '-');
+        next_token(parser);
+        expr_type_t right = parse_term(parser);
+        if (parser->status != EXPR_OK) {
+            break;
+        }
+        if (left != right) {
+            fail(parser, EXPR_TYPE, subtract ? "Cannot subtract a vector and a scalar."
+                                             : "Cannot add a vector and a scalar.");
+            break;
+        }
+        if (left == EXPR_VECTOR) {
+            emit(parser, subtract ? OP_VSUB : OP_VADD, 0);
+        } else {
+            emit(parser, subtract ? OP_SSUB : OP_SADD, 0);
+        }
+    }
+    return left;
+}
+
+/**
+ * @brief Duplicates a string with malloc.
+ * @param str - The string to copy.
+ * @return The copy, or NULL if allocation failed.
+ */
+static char *copy_string(const char *str) {
+    size_t length = strlen(str) + 1;
+    char *copy = malloc(length);
+    if (copy) {
+        memcpy(copy, str, length);
+    }
+    return copy;
+}
+
+/**
+ * @brief Compiles expression text to bytecode.
+ * @param source - The expression text.
+ * @param element - Broadcast pattern text, or NULL for an ordinary expression.
+ * @param out - Receives the newly allocated expression on success.
+ * @param error - Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK, or EXPR_SYNTAX / EXPR_TYPE / EXPR_NO_MEMORY.
+ */
+int expr_compile(const char *source, const char *element, Expr **out, char *error) {
+    Expr *expr = calloc(1, sizeof(Expr));
+    if (expr) {
+        expr->source = copy_string(source);
+        expr->element = element ? copy_string(element) : NULL;
+    }
+    if (!expr || !expr->source || (element && !expr->element)) {
+        expr_free(expr);
+        snprintf(error, EXPR_ERROR_LEN, "Memory allocation failed.");
+        return EXPR_NO_MEMORY;
+    }
+    expr->generation = -1;
+
+    Parser parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.cursor = source;
+    parser.end = source + strlen(source);
+    parser.element = element;
+    parser.element_length = element ? strlen(element) : 0;
+    parser.expr = expr;
+    parser.status = EXPR_OK;
+    parser.error = error;
+
+    next_token(&parser);
+    expr->type = parse_expr(&parser);
+    if (parser.status == EXPR_OK && parser.token.kind != TOK_END) {
+        fail_syntax(&parser);
+    }
+
+    if (parser.status != EXPR_OK) {
+        expr_free(expr);
+        return parser.status;
+    }
+    *out = expr;
+    return EXPR_OK;
+}
+
+/**
+ * @brief Frees a compiled expression.
+ * @param expr - The expression to free (NULL is allowed).
+ */
+void expr_free(Expr *expr) {
+    if (expr == NULL) {
+        return;
+    }
+    for (int i = 0; i < expr->operand_count; i++) {
+        free(expr->operands[i]);
+    }
+    free(expr->operands);
+    free(expr->handles);
+    free(expr->consts);
+    free(expr->code);
+    free(expr->source);
+    free(expr->element);
+    free(expr);
+}
+
+/* ==================== Interpreter ==================== */
+
+/**
+ * @brief Makes sure every operand has a valid handle into the store.
+ *
+ * Handles survive growth and later insertions, so after the first run
+ * this is a single generation compare plus a validity check per operand;
+ * names are only looked up again after a clear or once a vector is gone.
+ *
+ * @param expr - The expression whose handles to refresh.
+ * @param store - The store to resolve names in.
+ * @param error - Buffer for a "not found" message.
+ * @return EXPR_OK, or EXPR_NOT_FOUND naming the first missing vector.
+ */
+static int resolve_operands(Expr *expr, VectorStore *store, char *error) {
+    int stale = expr->generation != store->generation;
+    int status = EXPR_OK;
+    for (int i = 0; i < expr->operand_count; i++) {
+        if (stale || handle_vector(store, expr->handles[i]) == NULL) {
+            expr->handles[i] = find_handle(store, expr->operands[i]);
+        }
+        if (expr->handles[i] == NO_HANDLE && status == EXPR_OK) {
+            snprintf(error, EXPR_ERROR_LEN, "Vector '%s' not found.", expr->operands[i]);
+            status = EXPR_NOT_FOUND;
+        }
+    }
+    // Only written when it changes, so warm expressions stay read-only
+    if (stale) {
+        expr->generation = store->generation;
+    }
+    return status;
+}
+
+/**
+ * @brief Executes instructions [from, to) of an expression.
+ *
+ * The range must leave exactly one value on the stack; it is returned
+ * in out with its type.
+ *
+ * @param expr - The compiled expression.
+ * @param from - First instruction to run.
+ * @param to - One past the last instruction to run.
+ * @param operands - Values of the operand slots.
+ * @param element - Current broadcast element (NULL if there is none).
+ * @param out - Receives the single value the range produces.
+ */
+static void run_code(const Expr *expr, int from, int to, const vector *operands,
+                     const vector *element, ExprValue *out) {
+    vector vecs[EXPR_MAX_STACK];
+    float scalars[EXPR_MAX_STACK];
+    int vt = 0;
+    int st = 0;
+
+    for (int pc = from; pc < to; pc++) {
+        const ExprInstr *in = &expr->code[pc];
+        switch ((expr_op_t)in->op) {
+        case OP_LOAD_VEC:
+            vecs[vt++] = operands[in->arg];
+            break;
+        case OP_LOAD_CONST:
+            scalars[st++] = expr->consts[in->arg];
+            break;
+        case OP_LOAD_ELEM:
+            vecs[vt++] = *element;
+            break;
+        case OP_VADD:
+            vt--;
+            vecs[vt - 1] = add(vecs[vt - 1], vecs[vt]);
+            break;
+        case OP_VSUB:
+            vt--;
+            vecs[vt - 1] = sub(vecs[vt - 1], vecs[vt]);
+            break;
+        case OP_VNEG:
+            vecs[vt - 1].x = -vecs[vt - 1].x;
+            vecs[vt - 1].y = -vecs[vt - 1].y;
+            vecs[vt - 1].z = -vecs[vt - 1].z;
+            break;
+        case OP_VDOT:
+            vt -= 2;
+            scalars[st++] = dot_prod(vecs[vt], vecs[vt + 1]);
+            break;
+        case OP_VCROSS:
+            vt--;
+            vecs[vt - 1] = cross_prod(vecs[vt - 1], vecs[vt]);
+            break;
+        case OP_SVMUL:
+        case OP_VSMUL: {
+            float scalar = scalars[--st];
+            vecs[vt - 1].x *= scalar;
+            vecs[vt - 1].y *= scalar;
+            vecs[vt - 1].z *= scalar;
+            break;
+        }
+        case OP_SADD:
+            st--;
+            scalars[st - 1] += scalars[st];
+            break;
+        case OP_SSUB:
+            st--;
+            scalars[st - 1] -= scalars[st];
+            break;
+        case OP_SMUL:
+            st--;
+            scalars[st - 1] *= scalars[st];
+            break;
+        case OP_SNEG:
+            scalars[st - 1] = -scalars[st - 1];
+            break;
+        }
+    }
+
+    out->v.id = NO_NAME;
+    if (vt > 0) {
+        out->type = EXPR_VECTOR;
+        out->v.x = vecs[0].x;
+        out->v.y = vecs[0].y;
+        out->v.z = vecs[0].z;
+        out->s = 0;
+    } else {
+        out->type = EXPR_SCALAR;
+        out->v.x = out->v.y = out->v.z = 0;
+        out->s = scalars[0];
+    }
+}
+
+/**
+ * @brief Resolves an expression's operands and copies their values.
+ * @param expr - The compiled expression.
+ * @param store - The store supplying the named vectors.
+ * @param operands - Receives one value per operand slot.
+ * @param error - Buffer for a "not found" message.
+ * @return EXPR_OK, or EXPR_NOT_FOUND naming the first missing vector.
+ */
+static int gather_operands(Expr *expr, VectorStore *store, vector *operands, char *error) {
+    int status = resolve_operands(expr, store, error);
+    if (status != EXPR_OK) {
+        return status;
+    }
+    for (int i = 0; i < expr->operand_count; i++) {
+        // Operands bound to formulas are recomputed if their inputs changed
+        formula_refresh(store, expr->handles[i]);
+        operands[i] = *handle_vector(store, expr->handles[i]);
+    }
+    return EXPR_OK;
+}
+
+/**
+ * @brief Runs an expression over a store whose vectors are rows of any
+ * dimension other than 3.
+ *
+ * Mirrors run_code with the wide kernels. Operands are read straight from
+ * the store's rows and every level of the vector stack owns one scratch
+ * row, so no operand is copied.
+ *
+ * @param expr - The compiled expression (no broadcast element).
+ * @param store - The store supplying the named vectors.
+ * @param out - Receives the result; out->row must hold store->dim floats.
+ * @param error - Buffer for a message on failure.
+ * @return EXPR_OK, or EXPR_NOT_FOUND / EXPR_DIMENSION / EXPR_NO_MEMORY.
+ */
+static int run_rows(Expr *expr, VectorStore *store, ExprValue *out, char *error) {
+    int status = resolve_operands(expr, store, error);
+    if (status != EXPR_OK) {
+        return status;
+    }
+    for (int pc = 0; pc < expr->code_length; pc++) {
+        if (expr->code[pc].op == OP_VCROSS) {
+            snprintf(error, EXPR_ERROR_LEN, "The cross product needs 3-dimensional vectors.");
+            return EXPR_DIMENSION;
+        }
+    }
+
+    int dim = store->dim;
+    size_t stride = (size_t)store->row_stride;
+    float *scratch = malloc(EXPR_MAX_STACK * stride * sizeof(float));
+    if (!scratch) {
+        snprintf(error, EXPR_ERROR_LEN, "Memory allocation failed.");
+        return EXPR_NO_MEMORY;
+    }
+    const float *vecs[EXPR_MAX_STACK];
+    float scalars[EXPR_MAX_STACK];
+    int vt = 0;
+    int st = 0;
+
+    for (int pc = 0; pc < expr->code_length; pc++) {
+        const ExprInstr *in = &expr->code[pc];
+        float *top = scratch + (size_t)(vt > 0 ? vt - 1 : 0) * stride;
+        switch ((expr_op_t)in->op) {
+        case OP_LOAD_VEC:
+            vecs[vt++] = vector_row(store, handle_vector(store, expr->handles[in->arg]));
+            break;
+        case OP_LOAD_CONST:
+            scalars[st++] = expr->consts[in->arg];
+            break;
+        case OP_LOAD_ELEM:
+        case OP_VCROSS:
+            break;
+        case OP_VADD:
+            vt--;
+            top -= stride;
+            wide_add(vecs[vt - 1], vecs[vt], top, dim);
+            vecs[vt - 1] = top;
+            break;
+        case OP_VSUB:
+            vt--;
+            top -= stride;
+            wide_sub(vecs[vt - 1], vecs[vt], top, dim);
+            vecs[vt - 1] = top;
+            break;
+        case OP_VNEG:
+            wide_scale(-1.0f, vecs[vt - 1], top, dim);
+            vecs[vt - 1] = top;
+            break;
+        case OP_VDOT:
+            vt -= 2;
+            scalars[st++] = wide_dot(vecs[vt], vecs[vt + 1], dim);
+            break;
+        case OP_SVMUL:
+        case OP_VSMUL:
+            wide_scale(scalars[--st], vecs[vt - 1], top, dim);
+            vecs[vt - 1] = top;
+            break;
+        case OP_SADD:
+            st--;
+            scalars[st - 1] += scalars[st];
+            break;
+        case OP_SSUB:
+            st--;
+            scalars[st - 1] -= scalars[st];
+            break;
+        case OP_SMUL:
+            st--;
+            scalars[st - 1] *= scalars[st];
+            break;
+        case OP_SNEG:
+            scalars[st - 1] = -scalars[st - 1];
+            break;
+        }
+    }
+
+    out->v.id = NO_NAME;
+    out->v.x = out->v.y = out->v.z = 0;
+    if (vt > 0) {
+        out->type = EXPR_VECTOR;
+        memcpy(out->row, vecs[0], (size_t)dim * sizeof(float));
+        out->s = 0;
+    } else {
+        out->type = EXPR_SCALAR;
+        out->s = scalars[0];
+    }
+    free(scratch);
+    return EXPR_OK;
+}
+
+/**
+ * @brief Runs a compiled expression against a store (the body of
+ * expr_eval, which adds the timing).
+ * @param expr - The compiled expression.
+ * @param store - The store supplying the named vectors.
+ * @param out - Receives the result.
+ * @param error - Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK, or EXPR_NOT_FOUND if a named vector does not exist.
+ */
+static int eval_expr(Expr *expr, VectorStore *store, ExprValue *out, char *error) {
+    if (expr->element != NULL) {
+        snprintf(error, EXPR_ERROR_LEN, "'%s' can only be used in a broadcast.", expr->element);
+        return EXPR_SYNTAX;
+    }
+    if (store->rows != NULL) {
+        return run_rows(expr, store, out, error);
+    }
+    vector operands[EXPR_MAX_OPERANDS];
+    int status = gather_operands(expr, store, operands, error);
+    if (status != EXPR_OK) {
+        return status;
+    }
+    run_code(expr, 0, expr->code_length, operands, NULL, out);
+    return EXPR_OK;
+}
+
+/**
+ * @brief Runs a compiled expression against a store.
+ * @param expr - The compiled expression.
+ * @param store - The store supplying the named vectors.
+ * @param out - Receives the result.
+ * @param error - Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK, or EXPR_NOT_FOUND if a named vector does not exist.
+ */
+int expr_eval(Expr *expr, VectorStore *store, ExprValue *out, char *error) {
+    STATS_START(start);
+    int status = eval_expr(expr, store, out, error);
+    STATS_STOP(STAT_EXPR, start);
+    if (status != EXPR_OK) {
+        STATS_COUNT(STAT_EXPR_ERRORS, 1);
+    }
+    return status;
+}
+
+/**
+ * @brief Checks whether a range of instructions is one complete operand
+ * that does not depend on the broadcast element.
+ * @param expr - The compiled expression.
+ * @param from - First instruction of the range.
+ * @param to - One past the last instruction of the range.
+ * @return 1 if the range leaves exactly one value and never reads the
+ *         element or values pushed before it, 0 otherwise.
+ */
+static int is_constant_operand(const Expr *expr, int from, int to) {
+    int depth = 0;
+    for (int pc = from; pc < to; pc++) {
+        switch ((expr_op_t)expr->code[pc].op) {
+        case OP_LOAD_ELEM:
+            return 0;
+        case OP_LOAD_VEC:
+        case OP_LOAD_CONST:
+            depth++;
+            break;
+        case OP_VNEG:
+        case OP_SNEG:
+            if (depth < 1) {
+                return 0;
+            }
+            break;
+        default:
+            // Every other opcode pops two values and pushes one
+            if (depth < 2) {
+                return 0;
+            }
+            depth--;
+            break;
+        }
+    }
+    return depth == 1;
+}
+
+/**
+ * @brief Prepares a broadcast expression for a bulk loop.
+ *
+ * In postfix form "e op C" is [ELEM, C..., op] and "C op e" is
+ * [C..., ELEM, op]. When the element appears only in that one position,
+ * C is run once here and the loop applies a single fixed operation.
+ *
+ * @param expr - An expression compiled with an element pattern.
+ * @param store - The store supplying the named vectors.
+ * @param plan - Receives the prepared plan.
+ * @param error - Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK, or EXPR_NOT_FOUND if a named vector does not exist.
+ */
+int expr_plan_broadcast(Expr *expr, VectorStore *store, BroadcastPlan *plan, char *error) {
+    int status = gather_operands(expr, store, plan->operands, error);
+    if (status != EXPR_OK) {
+        return status;
+    }
+
+    plan->kind = BCAST_GENERIC;
+    plan->expr = expr;
+    plan->c.x = plan->c.y = plan->c.z = 0;
+    plan->s = 0;
+
+    int n = expr->code_length;
+    const ExprInstr *code = expr->code;
+    if (n == 1 && code[0].op == OP_LOAD_ELEM) {
+        plan->kind = BCAST_IDENTITY;
+        return EXPR_OK;
+    }
+    if (n == 2 && code[0].op == OP_LOAD_ELEM && code[1].op == OP_VNEG) {
+        plan->kind = BCAST_NEGATE;
+        return EXPR_OK;
+    }
+    if (n < 3) {
+        return EXPR_OK;
+    }
+
+    expr_op_t op = (expr_op_t)code[n - 1].op;
+    int element_left = code[0].op == OP_LOAD_ELEM && is_constant_operand(expr, 1, n - 1);
+    int element_right = code[n - 2].op == OP_LOAD_ELEM && is_constant_operand(expr, 0, n - 2);
+    if (!element_left && !element_right) {
+        return EXPR_OK;
+    }
+
+    // Evaluate the side that does not involve the element exactly once
+    ExprValue constant;
+    if (element_left) {
+        run_code(expr, 1, n - 1, plan->operands, NULL, &constant);
+    } else {
+        run_code(expr, 0, n - 2, plan->operands, NULL, &constant);
+    }
+    plan->c = constant.v;
+    plan->s = constant.s;
+
+    switch (op) {
+    case OP_VADD:   plan->kind = BCAST_ADD; break;
+    case OP_VSUB:   plan->kind = element_left ? BCAST_SUB : BCAST_RSUB; break;
+    case OP_VCROSS: plan->kind = element_left ? BCAST_CROSS : BCAST_RCROSS; break;
+    case OP_VDOT:   plan->kind = BCAST_DOT; break;
+    case OP_SVMUL:
+    case OP_VSMUL:  plan->kind = BCAST_MULT; break;
+    default:        plan->kind = BCAST_GENERIC; break;
+    }
+    return EXPR_OK;
+}
+
+/**
+ * @brief Runs a BCAST_GENERIC plan's bytecode for one element.
+ * @param plan - The prepared plan.
+ * @param element - The current element.
+ * @param out - Receives the result.
+ */
+void expr_eval_element(const BroadcastPlan *plan, const vector *element, ExprValue *out) {
+    run_code(plan->expr, 0, plan->expr->code_length, plan->operands, element, out);
+}
+
+/**
+ * @brief Compiles (or fetches from the store's cache) and evaluates text.
+ * @param store - The store supplying the named vectors and the cache.
+ * @param source - The expression text.
+ * @param out - Receives the result.
+ * @param error - Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK or one of the EXPR_* error codes.
+ */
+int expr_run(VectorStore *store, const char *source, ExprValue *out, char *error) {
+    Expr *expr;
+    int status = expr_cache_get(store, source, NULL, &expr, error);
+    if (status != EXPR_OK) {
+        return status;
+    }
+    return expr_eval(expr, store, out, error);
+}
+
+/* ==================== Cache ==================== */
+
+/**
+ * @brief Frees every cached expression and empties the table.
+ * @param cache - The cache to flush.
+ */
+static void cache_flush(ExprCache *cache) {
+    for (int i = 0; i < cache->capacity; i++) {
+        expr_free(cache->entries[i]);
+        cache->entries[i] = NULL;
+    }
+    cache->count = 0;
+}
+
+/**
+ * @brief Places an expression into the first free bucket for its source.
+ * @param cache - The cache to insert into (must have a free bucket).
+ * @param expr - The expression to insert.
+ */
+static void cache_insert(ExprCache *cache, Expr *expr) {
+    unsigned int mask = (unsigned int)cache->capacity - 1;
+    unsigned int i = hash_string(expr->source) & mask;
+    while (cache->entries[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    cache->entries[i] = expr;
+    cache->count++;
+}
+
+/**
+ * @brief Creates the cache or makes room for one more entry.
+ *
+ * The table doubles until it holds EXPR_CACHE_LIMIT entries; past that the
+ * whole cache is flushed, which bounds memory for scripts that generate
+ * endless distinct expressions.
+ *
+ * @param store - The store owning the cache.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+static int cache_reserve(VectorStore *store) {
+    ExprCache *cache = store->exprs;
+    if (cache == NULL) {
+        cache = calloc(1, sizeof(ExprCache));
+        if (!cache) {
+            return 0;
+        }
+        cache->entries = calloc(EXPR_CACHE_INITIAL, sizeof(Expr *));
+        if (!cache->entries) {
+            free(cache);
+            return 0;
+        }
+        cache->capacity = EXPR_CACHE_INITIAL;
+        store->exprs = cache;
+    }
+
+    if ((cache->count + 1) * 2 <= cache->capacity) {
+        return 1;
+    }
+    if (cache->count >= EXPR_CACHE_LIMIT) {
+        cache_flush(cache);
+        return 1;
+    }
+
+    ExprCache grown = {calloc((size_t)cache->capacity * 2, sizeof(Expr *)),
+                       cache->capacity * 2, 0};
+    if (!grown.entries) {
+        return 0;
+    }
+    for (int i = 0; i < cache->capacity; i++) {
+        if (cache->entries[i] != NULL) {
+            cache_insert(&grown, cache->entries[i]);
+        }
+    }
+    free(cache->entries);
+    *cache = grown;
+    return 1;
+}
+
+/**
+ * @brief Looks up the compiled form of source, compiling it on a miss.
+ * @param store - The store owning the cache (created on first use).
+ * @param source - The expression text.
+ * @param element - Broadcast pattern text, or NULL for an ordinary expression.
+ * @param out - Receives the cached expression (owned by the cache).
+ * @param error - Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK or one of the EXPR_* compile error codes.
+ */
+int expr_cache_get(VectorStore *store, const char *source, const char *element,
+                   Expr **out, char *error) {
+    ExprCache *cache = store->exprs;
+    if (cache != NULL) {
+        unsigned int mask = (unsigned int)cache->capacity - 1;
+        unsigned int i = hash_string(source) & mask;
+        while (cache->entries[i] != NULL) {
+            const Expr *entry = cache->entries[i];
+            if (strcmp(entry->source, source) == 0 &&
+                (entry->element == NULL ? element == NULL
+                                        : element != NULL && strcmp(entry->element, element) == 0)) {
+                *out = cache->entries[i];
+                return EXPR_OK;
+            }
+            i = (i + 1) & mask;
+        }
+    }
+
+    Expr *expr;
+    int status = expr_compile(source, element, &expr, error);
+    if (status != EXPR_OK) {
+        return status;
+    }
+    if (!cache_reserve(store)) {
+        expr_free(expr);
+        snprintf(error, EXPR_ERROR_LEN, "Memory allocation failed.");
+        return EXPR_NO_MEMORY;
+    }
+    cache_insert(store->exprs, expr);
+    *out = expr;
+    return EXPR_OK;
+}
+
+/**
+ * @brief Checks whether evaluating source would only read the store.
+ * @param store - The store owning the cache.
+ * @param source - The expression text.
+ * @return 1 if source is cached as an ordinary expression and every operand
+ * handle is resolved for the store's current generation.
+ */
+int expr_cache_ready(VectorStore *store, const char *source) {
+    const ExprCache *cache = store->exprs;
+    if (cache == NULL) {
+        return 0;
+    }
+    unsigned int mask = (unsigned int)cache->capacity - 1;
+    unsigned int i = hash_string(source) & mask;
+    while (cache->entries[i] != NULL) {
+        const Expr *entry = cache->entries[i];
+        if (entry->element == NULL && strcmp(entry->source, source) == 0) {
+            if (entry->generation != store->generation) {
+                return 0;
+            }
+            for (int j = 0; j < entry->operand_count; j++) {
+                if (handle_vector(store, entry->handles[j]) == NULL) {
+                    return 0;
+                }
+            }
+            return 1;
+        }
+        i = (i + 1) & mask;
+    }
+    return 0;
+}
+
+/**
+ * @brief Frees a cache and every expression in it.
+ * @param cache - The cache to free (NULL is allowed).
+ */
+void expr_cache_free(ExprCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    cache_flush(cache);
+    free(cache->entries);
+    free(cache);
+}
@@ -0,0 +1,256 @@
+/**
+ * @file      : expr.h
+ * @brief     : Declares the vector expression compiler, its bytecode
+ *              interpreter and the per-store cache of compiled expressions.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "vector.h"
+#include <stddef.h>
+
+#define EXPR_MAX_STACK   32    /**< Deepest operand stack an expression may need. */
+#define EXPR_MAX_OPERANDS 64   /**< Most distinct vector names in one expression. */
+#define EXPR_ERROR_LEN   128   /**< Size of the error message buffers. */
+
+/* Status codes returned by the compiler and interpreter */
+#define EXPR_OK          0
+#define EXPR_SYNTAX      1     /**< The text is not a valid expression. */
+#define EXPR_TYPE        2     /**< Operands have the wrong kind (e.g., a + 2). */
+#define EXPR_NOT_FOUND   3     /**< A named vector does not exist. */
+#define EXPR_NO_MEMORY   4     /**< An allocation failed. */
+#define EXPR_DIMENSION   5     /**< The operation needs 3-dimensional vectors. */
+
+/**
+ * @brief The kind of value an expression (or sub-expression) produces.
+ */
+typedef enum {
+    EXPR_VECTOR,       /**< A 3D vector. */
+    EXPR_SCALAR        /**< A single float, e.g., a dot product. */
+} expr_type_t;
+
+/**
+ * @brief Bytecode operations. Operand types are known at compile time,
+ * so every arithmetic opcode is specialized and the interpreter never
+ * checks types while running.
+ */
+typedef enum {
+    OP_LOAD_VEC,       /**< Push the vector in operand slot arg. */
+    OP_LOAD_CONST,     /**< Push the scalar constant consts[arg]. */
+    OP_LOAD_ELEM,      /**< Push the current element of a broadcast. */
+    OP_VADD,           /**< vector + vector */
+    OP_VSUB,           /**< vector - vector */
+    OP_VNEG,           /**< -vector */
+    OP_VDOT,           /**< vector * vector (dot product, scalar result) */
+    OP_VCROSS,         /**< vector x vector */
+    OP_SVMUL,          /**< scalar * vector */
+    OP_VSMUL,          /**< vector * scalar */
+    OP_SADD,           /**< scalar + scalar */
+    OP_SSUB,           /**< scalar - scalar */
+    OP_SMUL,           /**< scalar * scalar */
+    OP_SNEG            /**< -scalar */
+} expr_op_t;
+
+/**
+ * @brief One bytecode instruction.
+ */
+typedef struct {
+    unsigned char op;  /**< An expr_op_t. */
+    int arg;           /**< Operand slot or constant index, if any. */
+} ExprInstr;
+
+/**
+ * @brief A compiled expression.
+ *
+ * Named operands are deduplicated into operand slots. Each slot caches the
+ * handle of its vector, resolved once and refreshed only when the store's
+ * generation changes (clear) or the handle no longer refers to a vector.
+ */
+typedef struct {
+    char *source;          /**< The text this was compiled from. */
+    char *element;         /**< Broadcast pattern standing for each element, or NULL. */
+    ExprInstr *code;       /**< Postfix instruction stream. */
+    int code_length;       /**< Number of instructions. */
+    float *consts;         /**< Scalar literals. */
+    int const_count;       /**< Number of scalar literals. */
+    char **operands;       /**< Distinct vector names referenced. */
+    vector_handle *handles; /**< Handle of each operand, NO_HANDLE if unresolved. */
+    int operand_count;     /**< Number of distinct vector names. */
+    int generation;        /**< Store generation the handles were resolved against. */
+    expr_type_t type;      /**< Type of the final result. */
+} Expr;
+
+/**
+ * @brief The result of evaluating an expression.
+ */
+typedef struct {
+    expr_type_t type;      /**< Which of the fields below is meaningful. */
+    vector v;              /**< Result for EXPR_VECTOR (name left empty). */
+    float s;               /**< Result for EXPR_SCALAR. */
+    float *row;            /**< Set by the caller when the store's dimension is
+                                not 3: receives an EXPR_VECTOR result's
+                                store->dim components instead of v. */
+} ExprValue;
+
+/**
+ * @brief Shapes of broadcast expression that have a dedicated loop.
+ * Anything else runs the bytecode once per element.
+ */
+typedef enum {
+    BCAST_GENERIC,     /**< Run the bytecode for every element. */
+    BCAST_IDENTITY,    /**< e */
+    BCAST_NEGATE,      /**< -e */
+    BCAST_ADD,         /**< e + c or c + e */
+    BCAST_SUB,         /**< e - c */
+    BCAST_RSUB,        /**< c - e */
+    BCAST_MULT,        /**< e * s or s * e */
+    BCAST_CROSS,       /**< e x c */
+    BCAST_RCROSS,      /**< c x e */
+    BCAST_DOT          /**< e * c or c * e (scalar per element) */
+} bcast_kind_t;
+
+/**
+ * @brief A broadcast expression ready to run over many elements.
+ *
+ * The parts of the expression that do not involve the element are
+ * evaluated once up front, and every named operand is snapshotted, so the
+ * loop neither looks anything up nor sees its own writes.
+ */
+typedef struct {
+    bcast_kind_t kind;                      /**< Which loop to use. */
+    vector c;                               /**< Constant vector operand. */
+    float s;                                /**< Constant scalar operand. */
+    const Expr *expr;                       /**< Bytecode for BCAST_GENERIC. */
+    vector operands[EXPR_MAX_OPERANDS];     /**< Snapshot of named operands. */
+} BroadcastPlan;
+
+/**
+ * @brief A per-store cache of compiled expressions keyed by source text.
+ */
+typedef struct ExprCache ExprCache;
+
+/* ==================== Compilation ==================== */
+
+/**
+ * @brief Compiles expression text to bytecode.
+ *
+ * Grammar, lowest precedence first:
+ *   expr  := term (('+' | '-') term)*
+ *   term  := unary (('*' | 'x' | 'X') unary)*
+ *   unary := ('-' | '+') unary | primary
+ *   primary := number | name | '(' expr ')'
+ * A bare x or X after an operand is the cross product; anywhere else it
+ * is an ordinary vector name. When element is given, every occurrence of
+ * that exact text (e.g., "all" or "p*") compiles to OP_LOAD_ELEM.
+ *
+ * @param source The expression text (e.g., "(a + b) x c * 2 - e").
+ * @param element Broadcast pattern text, or NULL for an ordinary expression.
+ * @param out Receives the newly allocated expression on success.
+ * @param error Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK, or EXPR_SYNTAX / EXPR_TYPE / EXPR_NO_MEMORY.
+ */
+int expr_compile(const char *source, const char *element, Expr **out, char *error);
+
+/**
+ * @brief Frees a compiled expression.
+ * @param expr The expression to free (NULL is allowed).
+ */
+void expr_free(Expr *expr);
+
+/* ==================== Evaluation ==================== */
+
+/**
+ * @brief Runs a compiled expression against a store.
+ *
+ * Stores of dimension 3 use the vector bytecode interpreter. Other
+ * dimensions run the same bytecode over rows with the wide kernels; their
+ * dimension is fixed per store, so it is never checked per element, and
+ * the cross product is rejected before anything runs.
+ *
+ * @param expr The compiled expression (its operand slots may be refreshed).
+ * @param store The store supplying the named vectors.
+ * @param out Receives the result (see ExprValue.row).
+ * @param error Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK, or EXPR_NOT_FOUND if a named vector does not exist.
+ */
+int expr_eval(Expr *expr, VectorStore *store, ExprValue *out, char *error);
+
+/**
+ * @brief Compiles (or fetches from the store's cache) and evaluates text.
+ *
+ * Re-running the same text skips lexing and parsing entirely; only the
+ * bytecode is executed.
+ *
+ * @param store The store supplying the named vectors and the cache.
+ * @param source The expression text.
+ * @param out Receives the result.
+ * @param error Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK or one of the EXPR_* error codes.
+ */
+int expr_run(VectorStore *store, const char *source, ExprValue *out, char *error);
+
+/**
+ * @brief Prepares a broadcast expression for a bulk loop.
+ *
+ * Resolves and snapshots the named operands, recognizes the common
+ * "element op constant" shapes and evaluates their constant side once.
+ *
+ * @param expr An expression compiled with an element pattern.
+ * @param store The store supplying the named vectors.
+ * @param plan Receives the prepared plan.
+ * @param error Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK, or EXPR_NOT_FOUND if a named vector does not exist.
+ */
+int expr_plan_broadcast(Expr *expr, VectorStore *store, BroadcastPlan *plan, char *error);
+
+/**
+ * @brief Runs a BCAST_GENERIC plan's bytecode for one element.
+ * @param plan The prepared plan.
+ * @param element The current element.
+ * @param out Receives the result.
+ */
+void expr_eval_element(const BroadcastPlan *plan, const vector *element, ExprValue *out);
+
+/* ==================== Cache ==================== */
+
+/**
+ * @brief Looks up the compiled form of source, compiling and caching it
+ * on a miss.
+ * @param store The store owning the cache (created on first use).
+ * @param source The expression text.
+ * @param element Broadcast pattern text, or NULL for an ordinary expression.
+ * @param out Receives the cached expression (owned by the cache).
+ * @param error Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK or one of the EXPR_* compile error codes.
+ */
+int expr_cache_get(VectorStore *store, const char *source, const char *element,
+                   Expr **out, char *error);
+
+/**
+ * @brief Checks whether evaluating source would only read the store.
+ *
+ * True when source is already cached as an ordinary expression and all its
+ * operand handles are resolved for the current generation, so expr_run
+ * neither compiles, inserts nor re-resolves anything. The server uses this
+ * to run warm expressions under a shared lock.
+ *
+ * @param store The store owning the cache.
+ * @param source The expression text.
+ * @return 1 if evaluation is read-only, 0 otherwise.
+ */
+int expr_cache_ready(VectorStore *store, const char *source);
+
+/**
+ * @brief Frees a cache and every expression in it.
+ * @param cache The cache to free (NULL is allowed).
+ */
+void expr_cache_free(ExprCache *cache);
+
+#endif /* EXPR_H */
@@ -0,0 +1,603 @@
+/**
+ * @file      : formula.c
+ * @brief     : Defines formula bindings (c := a + b): derived vectors
+ *              that are recomputed lazily when their inputs change.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "formula.h"
+#include "expr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FORMULA_INITIAL 16
+
+/**
+ * @brief One name in the dependency graph.
+ */
+typedef struct {
+    name_id id;            /**< The vector name. */
+    Expr *expr;            /**< Its formula, or NULL for a plain input. */
+    int *inputs;           /**< Nodes of the formula's operands, in operand order. */
+    int dirty;             /**< Nonzero if the formula must be recomputed. */
+    int visit;             /**< Scratch mark for graph walks. */
+    int *dependents;       /**< Nodes whose formulas read this name. */
+    int dependent_count;
+    int dependent_capacity;
+} FormulaNode;
+
+struct FormulaSet {
+    FormulaNode *nodes;    /**< Every name seen, never removed. */
+    int count;
+    int capacity;
+    int *index;            /**< Open-addressing hash of names to nodes (-1 = empty). */
+    int index_capacity;    /**< Number of buckets (power of two). */
+    int dirty_count;       /**< Number of dirty formulas. */
+    int *stack;            /**< Scratch stack for graph walks. */
+    int stack_capacity;
+    int visit;             /**< Mark of the current graph walk. */
+};
+
+/* ==================== Graph Storage ==================== */
+
+/**
+ * @brief Spreads a name id over the hash buckets.
+ * @param id - The id to hash.
+ * @return The hash value.
+ */
+static unsigned int hash_id(name_id id) {
+    return id * 2654435761u;
+}
+
+/**
+ * @brief Finds the node for a name.
+ * @param set - The formula set.
+ * @param id - The name to look up.
+ * @return The node's index, or -1 if the name has no node.
+ */
+static int find_node(const FormulaSet *set, name_id id) {
+    unsigned int mask = (unsigned int)set->index_capacity - 1;
+    unsigned int i = hash_id(id) & mask;
+    while (set->index[i] != -1) {
+        if (set->nodes[set->index[i]].id == id) {
+            return set->index[i];
+        }
+        i = (i + 1) & mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Places a node in the name index.
+ * @param set - The formula set.
+ * @param node - Index of the node to place.
+ */
+static void index_node(FormulaSet *set, int node) {
+    unsigned int mask = (unsigned int)set->index_capacity - 1;
+    unsigned int i = hash_id(set->nodes[node].id) & mask;
+    while (set->index[i] != -1) {
+        i = (i + 1) & mask;
+    }
+    set->index[i] = node;
+}
+
+/**
+ * @brief Returns the node for a name, creating it if needed.
+ * @param set - The formula set.
+ * @param id - The name.
+ * @return The node's index, or -1 if allocation failed.
+ */
+static int get_node(FormulaSet *set, name_id id) {
+    int node = find_node(set, id);
+    if (node >= 0) {
+        return node;
+    }
+    if (set->count == set->capacity) {
+        int capacity = set->capacity * 2;
+        FormulaNode *temp = realloc(set->nodes, (size_t)capacity * sizeof(FormulaNode));
+        if (!temp) {
+            return -1;
+        }
+        set->nodes = temp;
+        set->capacity = capacity;
+    }
+    if ((set->count + 1) * 2 > set->index_capacity) {
+        int capacity = set->index_capacity * 2;
+        int *temp = malloc((size_t)capacity * sizeof(int));
+        if (!temp) {
+            return -1;
+        }
+        free(set->index);
+        set->index = temp;
+        set->index_capacity = capacity;
+        memset(set->index, -1, (size_t)capacity * sizeof(int));
+        for (int i = 0; i < set->count; i++) {
+            index_node(set, i);
+        }
+    }
+
+    node = set->count++;
+    FormulaNode *n = &set->nodes[node];
+    memset(n, 0, sizeof(*n));
+    n->id = id;
+    index_node(set, node);
+    return node;
+}
+
+/**
+ * @brief Creates an empty formula set.
+ * @return The set, or NULL if allocation failed.
+ */
+static FormulaSet *create_set(void) {
+    FormulaSet *set = calloc(1, sizeof(FormulaSet));
+    if (!set) {
+        return NULL;
+    }
+    set->nodes = malloc(FORMULA_INITIAL * sizeof(FormulaNode));
+    set->index = malloc(2 * FORMULA_INITIAL * sizeof(int));
+    if (!set->nodes || !set->index) {
+        formula_free(set);
+        return NULL;
+    }
+    set->capacity = FORMULA_INITIAL;
+    set->index_capacity = 2 * FORMULA_INITIAL;
+    memset(set->index, -1, 2 * FORMULA_INITIAL * sizeof(int));
+    return set;
+}
+
+/**
+ * @brief Pushes a node onto the scratch stack.
+ * @param set - The formula set.
+ * @param node - The node to push.
+ * @param depth - Current stack depth.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+static int push(FormulaSet *set, int node, int depth) {
+    if (depth == set->stack_capacity) {
+        int capacity = set->stack_capacity > 0 ? set->stack_capacity * 2 : FORMULA_INITIAL;
+        int *temp = realloc(set->stack, (size_t)capacity * sizeof(int));
+        if (!temp) {
+            return 0;
+        }
+        set->stack = temp;
+        set->stack_capacity = capacity;
+    }
+    set->stack[depth] = node;
+    return 1;
+}
+
+/**
+ * @brief Removes the edge from input to the formula node that read it.
+ * @param set - The formula set.
+ * @param input - The input's node.
+ * @param node - The formula's node.
+ */
+static void remove_dependent(FormulaSet *set, int input, int node) {
+    FormulaNode *in = &set->nodes[input];
+    for (int j = 0; j < in->dependent_count; j++) {
+        if (in->dependents[j] == node) {
+            in->dependents[j] = in->dependents[--in->dependent_count];
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Removes node's formula and the edges from its inputs.
+ * @param set - The formula set.
+ * @param node - The formula's node.
+ */
+static void drop_formula(FormulaSet *set, int node) {
+    FormulaNode *n = &set->nodes[node];
+    if (!n->expr) {
+        return;
+    }
+    for (int i = 0; i < n->expr->operand_count; i++) {
+        remove_dependent(set, n->inputs[i], node);
+    }
+    if (n->dirty) {
+        set->dirty_count--;
+    }
+    expr_free(n->expr);
+    free(n->inputs);
+    n->expr = NULL;
+    n->inputs = NULL;
+    n->dirty = 0;
+}
+
+/**
+ * @brief Adds an edge from input to the formula node that reads it.
+ * @param set - The formula set.
+ * @param input - The input's node.
+ * @param node - The formula's node.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+static int add_dependent(FormulaSet *set, int input, int node) {
+    FormulaNode *in = &set->nodes[input];
+    if (in->dependent_count == in->dependent_capacity) {
+        int capacity = in->dependent_capacity > 0 ? in->dependent_capacity * 2 : 4;
+        int *temp = realloc(in->dependents, (size_t)capacity * sizeof(int));
+        if (!temp) {
+            return 0;
+        }
+        in->dependents = temp;
+        in->dependent_capacity = capacity;
+    }
+    in->dependents[in->dependent_count++] = node;
+    return 1;
+}
+
+/**
+ * @brief Checks whether a formula over the given inputs would read target.
+ *
+ * A cycle exists exactly when an input is target itself or one of the
+ * formulas that (transitively) read target, so the walk covers only
+ * target's dependents - usually none for a newly defined vector.
+ *
+ * @param set - The formula set.
+ * @param inputs - Nodes of the candidate formula's operands.
+ * @param input_count - Number of inputs.
+ * @param target - Node the formula would be bound to.
+ * @return 1 if target is reachable through the inputs, 0 otherwise.
+ */
+static int reaches(FormulaSet *set, const int *inputs, int input_count, int target) {
+    for (int i = 0; i < input_count; i++) {
+        if (inputs[i] == target) {
+            return 1;
+        }
+    }
+    if (set->nodes[target].dependent_count == 0) {
+        return 0;
+    }
+
+    // Mark the inputs, then look for one among target's dependents
+    int operand_mark = ++set->visit;
+    for (int i = 0; i < input_count; i++) {
+        set->nodes[inputs[i]].visit = operand_mark;
+    }
+    int seen_mark = ++set->visit;
+    int depth = 0;
+    if (!push(set, target, depth++)) {
+        return 1;
+    }
+    while (depth > 0) {
+        const FormulaNode *n = &set->nodes[set->stack[--depth]];
+        for (int i = 0; i < n->dependent_count; i++) {
+            FormulaNode *dependent = &set->nodes[n->dependents[i]];
+            if (dependent->visit == operand_mark) {
+                return 1;
+            }
+            if (dependent->visit != seen_mark) {
+                dependent->visit = seen_mark;
+                if (!push(set, n->dependents[i], depth++)) {
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/* ==================== Dirty Tracking ==================== */
+
+/**
+ * @brief Removes the binding of name, if any, keeping its current value.
+ * @param set - The formula set (NULL is allowed).
+ * @param name - The vector name.
+ */
+void formula_unbind(FormulaSet *set, name_id name) {
+    if (!set) {
+        return;
+    }
+    int node = find_node(set, name);
+    if (node >= 0) {
+        drop_formula(set, node);
+    }
+}
+
+/**
+ * @brief Marks every formula that depends on name dirty.
+ * @param set - The formula set (NULL is allowed).
+ * @param name - The vector that was written.
+ */
+void formula_mark_dependents(FormulaSet *set, name_id name) {
+    if (!set) {
+        return;
+    }
+    int node = find_node(set, name);
+    if (node < 0 || set->nodes[node].dependent_count == 0) {
+        return;
+    }
+
+    int depth = 0;
+    if (!push(set, node, depth++)) {
+        formula_mark_all(set);
+        return;
+    }
+    while (depth > 0) {
+        const FormulaNode *n = &set->nodes[set->stack[--depth]];
+        for (int i = 0; i < n->dependent_count; i++) {
+            int dependent = n->dependents[i];
+            // Anything already dirty has had its own dependents marked
+            if (!set->nodes[dependent].dirty) {
+                set->nodes[dependent].dirty = 1;
+                set->dirty_count++;
+                if (!push(set, dependent, depth++)) {
+                    formula_mark_all(set);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Marks every formula dirty, e.g., after a bulk update.
+ * @param set - The formula set (NULL is allowed).
+ */
+void formula_mark_all(FormulaSet *set) {
+    if (!set) {
+        return;
+    }
+    for (int i = 0; i < set->count; i++) {
+        if (set->nodes[i].expr && !set->nodes[i].dirty) {
+            set->nodes[i].dirty = 1;
+            set->dirty_count++;
+        }
+    }
+}
+
+/**
+ * @brief Reports whether any formula is waiting to be recomputed.
+ * @param set - The formula set (NULL is allowed).
+ * @return 1 if at least one formula is dirty, 0 otherwise.
+ */
+int formula_any_dirty(const FormulaSet *set) {
+    return set != NULL && set->dirty_count > 0;
+}
+
+/**
+ * @brief Moves every node to its name's new id after the store's name
+ * table was compacted.
+ * @param set - The formula set (NULL is allowed).
+ * @param map - New id of each old id; NO_NAME for a deleted name, whose
+ * node no formula reads any more.
+ * @param count - Number of entries in map.
+ */
+void formula_renumber(FormulaSet *set, const name_id *map, uint32_t count) {
+    if (!set) {
+        return;
+    }
+    memset(set->index, -1, (size_t)set->index_capacity * sizeof(int));
+    for (int i = 0; i < set->count; i++) {
+        name_id id = set->nodes[i].id;
+        set->nodes[i].id = id < count ? map[id] : NO_NAME;
+        index_node(set, i);
+    }
+}
+
+/* ==================== Recomputation ==================== */
+
+/**
+ * @brief Evaluates a formula and writes its value into the store.
+ * @param store - The store holding the vectors.
+ * @param node - The formula's node; its inputs must already be current.
+ * @return 1 if successful, 0 if an input is missing.
+ */
+static int recompute(VectorStore *store, int node) {
+    FormulaSet *set = store->formulas;
+    FormulaNode *n = &set->nodes[node];
+    char error[EXPR_ERROR_LEN];
+    ExprValue value;
+
+    vector *target = handle_vector(store, n->id);
+    if (target == NULL || expr_eval(n->expr, store, &value, error) != EXPR_OK) {
+        return 0;
+    }
+    if (value.type == EXPR_SCALAR) {
+        value.v.x = value.s;
+    }
+    target->x = value.v.x;
+    target->y = value.v.y;
+    target->z = value.v.z;
+    n->dirty = 0;
+    set->dirty_count--;
+    note_vector_change(store, (int)(target - store->vectors));
+    return 1;
+}
+
+/**
+ * @brief Recomputes a dirty formula after its dirty inputs, depth first.
+ * @param store - The store holding the vectors.
+ * @param node - The formula's node.
+ * @return 1 if successful, 0 if any formula on the way failed.
+ */
+static int refresh_node(VectorStore *store, int node) {
+    FormulaSet *set = store->formulas;
+    if (!set->nodes[node].dirty) {
+        return 1;
+    }
+    int input_count = set->nodes[node].expr->operand_count;
+    for (int i = 0; i < input_count; i++) {
+        int input = set->nodes[node].inputs[i];
+        if (set->nodes[input].dirty && !refresh_node(store, input)) {
+            return 0;
+        }
+    }
+    return recompute(store, node);
+}
+
+/**
+ * @brief Recomputes name if it is a dirty formula, inputs first.
+ * @param store - The store holding the vectors.
+ * @param name - The vector about to be read (NO_NAME is allowed).
+ * @return 1 if name is now current, 0 if recomputing it failed.
+ */
+int formula_refresh(VectorStore *store, name_id name) {
+    if (!formula_any_dirty(store->formulas)) {
+        return 1;
+    }
+    int node = find_node(store->formulas, name);
+    return node < 0 || refresh_node(store, node);
+}
+
+/**
+ * @brief Recomputes every dirty formula.
+ * @param store - The store holding the vectors.
+ * @return 1 if all formulas are now current, 0 if any failed.
+ */
+int formula_refresh_all(VectorStore *store) {
+    int ok = 1;
+    FormulaSet *set = store->formulas;
+    for (int i = 0; set != NULL && set->dirty_count > 0 && i < set->count; i++) {
+        if (set->nodes[i].dirty && !refresh_node(store, i)) {
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Unbinds name and every formula that reads it, before name is
+ * deleted.
+ * @param store - The store holding the vectors.
+ * @param name - The vector about to be deleted.
+ */
+void formula_forget(VectorStore *store, name_id name) {
+    FormulaSet *set = store->formulas;
+    int node = set ? find_node(set, name) : -1;
+    if (node < 0) {
+        return;
+    }
+    // drop_formula takes each reader off the end of the dependents list
+    while (set->nodes[node].dependent_count > 0) {
+        int dependent = set->nodes[node].dependents[set->nodes[node].dependent_count - 1];
+        if (set->nodes[dependent].dirty) {
+            refresh_node(store, dependent);
+        }
+        drop_formula(set, dependent);
+    }
+    drop_formula(set, node);
+}
+
+/* ==================== Binding ==================== */
+
+/**
+ * @brief Binds name to an expression and computes its value now.
+ * @param store - The store holding the vectors.
+ * @param name - Name of the derived vector.
+ * @param source - The expression text (e.g., "a + b").
+ * @param out - Receives the computed vector.
+ * @param error - Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK or one of the EXPR_* error codes.
+ */
+int formula_define(VectorStore *store, const char *name, const char *source,
+                   vector *out, char *error) {
+    if (store->formulas == NULL && (store->formulas = create_set()) == NULL) {
+        snprintf(error, EXPR_ERROR_LEN, "Memory allocation failed.");
+        return EXPR_NO_MEMORY;
+    }
+    FormulaSet *set = store->formulas;
+
+    Expr *expr;
+    int status = expr_compile(source, NULL, &expr, error);
+    if (status != EXPR_OK) {
+        return status;
+    }
+    for (int i = 0; i < expr->operand_count; i++) {
+        if (strcmp(expr->operands[i], name) == 0) {
+            snprintf(error, EXPR_ERROR_LEN, "Formula for '%s' would depend on itself.", name);
+            expr_free(expr);
+            return EXPR_SYNTAX;
+        }
+    }
+
+    ExprValue value;
+    status = expr_eval(expr, store, &value, error);
+    if (status != EXPR_OK) {
+        expr_free(expr);
+        return status;
+    }
+    if (value.type == EXPR_SCALAR) {
+        value.v.x = value.s;
+    }
+
+    // Every operand was just found, so its name is already interned
+    value.v.id = store_name(store, name, strlen(name));
+    int node = value.v.id != NO_NAME ? get_node(set, value.v.id) : -1;
+    int *inputs = malloc((size_t)(expr->operand_count > 0 ? expr->operand_count : 1) * sizeof(int));
+    int resolved = 0;
+    while (node >= 0 && inputs && resolved < expr->operand_count) {
+        const char *operand = expr->operands[resolved];
+        inputs[resolved] = get_node(set, names_lookup(&store->names, operand, strlen(operand)));
+        if (inputs[resolved] < 0) {
+            break;
+        }
+        resolved++;
+    }
+    if (node < 0 || !inputs || resolved < expr->operand_count) {
+        free(inputs);
+        expr_free(expr);
+        snprintf(error, EXPR_ERROR_LEN, "Memory allocation failed.");
+        return EXPR_NO_MEMORY;
+    }
+    if (reaches(set, inputs, expr->operand_count, node)) {
+        snprintf(error, EXPR_ERROR_LEN, "Formula for '%s' would depend on itself.", name);
+        free(inputs);
+        expr_free(expr);
+        return EXPR_SYNTAX;
+    }
+
+    // add_vector unbinds any old formula and dirties the dependents
+    if (!add_vector(store, value.v)) {
+        free(inputs);
+        expr_free(expr);
+        snprintf(error, EXPR_ERROR_LEN, "Memory allocation failed.");
+        return EXPR_NO_MEMORY;
+    }
+
+    int added = 0;
+    while (added < expr->operand_count && add_dependent(set, inputs[added], node)) {
+        added++;
+    }
+    if (added < expr->operand_count) {
+        // Undo the edges added so far; the vector keeps its value unbound
+        for (int i = 0; i < added; i++) {
+            remove_dependent(set, inputs[i], node);
+        }
+        free(inputs);
+        expr_free(expr);
+        snprintf(error, EXPR_ERROR_LEN, "Memory allocation failed.");
+        return EXPR_NO_MEMORY;
+    }
+    set->nodes[node].expr = expr;
+    set->nodes[node].inputs = inputs;
+    set->nodes[node].dirty = 0;
+    *out = value.v;
+    return EXPR_OK;
+}
+
+/**
+ * @brief Frees a formula set and every binding in it.
+ * @param set - The set to free (NULL is allowed).
+ */
+void formula_free(FormulaSet *set) {
+    if (!set) {
+        return;
+    }
+    for (int i = 0; i < set->count; i++) {
+        expr_free(set->nodes[i].expr);
+        free(set->nodes[i].inputs);
+        free(set->nodes[i].dependents);
+    }
+    free(set->nodes);
+    free(set->index);
+    free(set->stack);
+    free(set);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file      : formula.h
+ * @brief     : Declares formula bindings (c := a + b): derived vectors
+ *              that are recomputed lazily when their inputs change.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef FORMULA_H
+#define FORMULA_H
+
+#include "vector.h"
+
+/**
+ * @brief The dependency graph of every formula bound in a store.
+ *
+ * Each name that is a formula target or input is a node; edges run from
+ * an input to the formulas that read it. Writing a vector marks the
+ * formulas reachable from it dirty, stopping at nodes that are already
+ * dirty, so an edit costs only the affected subgraph. Dirty formulas are
+ * recomputed, inputs first, when something reads them.
+ */
+typedef struct FormulaSet FormulaSet;
+
+/**
+ * @brief Binds name to an expression and computes its value now.
+ *
+ * Rebinding an existing formula replaces it. A binding that would make a
+ * formula depend on itself, directly or through others, is rejected.
+ *
+ * @param store The store holding the vectors (its formula set is created
+ *              on first use).
+ * @param name Name of the derived vector.
+ * @param source The expression text (e.g., "a + b").
+ * @param out Receives the computed vector.
+ * @param error Buffer of EXPR_ERROR_LEN bytes for a message on failure.
+ * @return EXPR_OK or one of the EXPR_* error codes.
+ */
+int formula_define(VectorStore *store, const char *name, const char *source,
+                   vector *out, char *error);
+
+/**
+ * @brief Removes the binding of name, if any, keeping its current value.
+ * Called when name is assigned directly.
+ * @param set The formula set (NULL is allowed).
+ * @param name The vector name.
+ */
+void formula_unbind(FormulaSet *set, name_id name);
+
+/**
+ * @brief Marks every formula that depends on name dirty.
+ * @param set The formula set (NULL is allowed).
+ * @param name The vector that was written.
+ */
+void formula_mark_dependents(FormulaSet *set, name_id name);
+
+/**
+ * @brief Marks every formula dirty, e.g., after a bulk update.
+ * @param set The formula set (NULL is allowed).
+ */
+void formula_mark_all(FormulaSet *set);
+
+/**
+ * @brief Recomputes name if it is a dirty formula, inputs first.
+ * @param store The store holding the vectors.
+ * @param name The vector about to be read (NO_NAME is allowed).
+ * @return 1 if name is now current, 0 if recomputing it failed.
+ */
+int formula_refresh(VectorStore *store, name_id name);
+
+/**
+ * @brief Recomputes every dirty formula.
+ * @param store The store holding the vectors.
+ * @return 1 if all formulas are now current, 0 if any failed.
+ */
+int formula_refresh_all(VectorStore *store);
+
+/**
+ * @brief Unbinds name and every formula that reads it, before name is
+ * deleted.
+ *
+ * The readers are brought up to date first and then keep their values as
+ * plain vectors, so none is left waiting on an input that is gone.
+ *
+ * @param store The store holding the vectors.
+ * @param name The vector about to be deleted.
+ */
+void formula_forget(VectorStore *store, name_id name);
+
+/**
+ * @brief Moves every node to its name's new id after the store's name
+ * table was compacted (see shrink_vectors).
+ * @param set The formula set (NULL is allowed).
+ * @param map New id of each old id; NO_NAME for a deleted name.
+ * @param count Number of entries in map.
+ */
+void formula_renumber(FormulaSet *set, const name_id *map, uint32_t count);
+
+/**
+ * @brief Reports whether any formula is waiting to be recomputed.
+ * @param set The formula set (NULL is allowed).
+ * @return 1 if at least one formula is dirty, 0 otherwise.
+ */
+int formula_any_dirty(const FormulaSet *set);
+
+/**
+ * @brief Frees a formula set and every binding in it.
+ * @param set The set to free (NULL is allowed).
+ */
+void formula_free(FormulaSet *set);
+
+#endif /* FORMULA_H */
@@ -0,0 +1,415 @@
+/**
+ * @file      : ftoa.c
+ * @brief     : Defines the float-to-text conversion used when saving CSV
+ *              files: shortest round-trip digits or a fixed number of decimals.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "ftoa.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_EXPONENT_MASK 0xFF
+#define FLOAT_BIAS          127
+#define POW5_INV_BITCOUNT   59   /**< Bits of precision in pow5_inv_split. */
+#define POW5_BITCOUNT       61   /**< Bits of precision in pow5_split. */
+#define SCIENTIFIC_BELOW    -3   /**< Decimal point positions below this use an exponent... */
+#define SCIENTIFIC_ABOVE    9    /**< ...as do positions above this. */
+
+/* 2^(bits(5^i) - 1 + POW5_INV_BITCOUNT) / 5^i, rounded up, for i = 0..30 */
+static const uint64_t pow5_inv_split[31] = {
+    576460752303423489u, 461168601842738791u, 368934881474191033u,
+    295147905179352826u, 472236648286964522u, 377789318629571618u,
+    302231454903657294u, 483570327845851670u, 386856262276681336u,
+    309485009821345069u, 495176015714152110u, 396140812571321688u,
+    316912650057057351u, 507060240091291761u, 405648192073033409u,
+    324518553658426727u, 519229685853482763u, 415383748682786211u,
+    332306998946228969u, 531691198313966350u, 425352958651173080u,
+    340282366920938464u, 544451787073501542u, 435561429658801234u,
+    348449143727040987u, 557518629963265579u, 446014903970612463u,
+    356811923176489971u, 570899077082383953u, 456719261665907162u,
+    365375409332725730u
+};
+
+/* 5^i scaled to its top POW5_BITCOUNT bits, for i = 0..46 */
+static const uint64_t pow5_split[47] = {
+    1152921504606846976u, 1441151880758558720u, 1801439850948198400u,
+    2251799813685248000u, 1407374883553280000u, 1759218604441600000u,
+    2199023255552000000u, 1374389534720000000u, 1717986918400000000u,
+    2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+    2097152000000000000u, 1310720000000000000u, 1638400000000000000u,
+    2048000000000000000u, 1280000000000000000u, 1600000000000000000u,
+    2000000000000000000u, 1250000000000000000u, 1562500000000000000u,
+    1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+    1907348632812500000u, 1192092895507812500u, 1490116119384765625u,
+    1862645149230957031u, 1164153218269348144u, 1455191522836685180u,
+    1818989403545856475u, 2273736754432320594u, 1421085471520200371u,
+    1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+    1734723475976807094u, 2168404344971008868u, 1355252715606880542u,
+    1694065894508600678u, 2117582368135750847u, 1323488980084844279u,
+    1654361225106055349u, 2067951531382569187u, 1292469707114105741u,
+    1615587133892632177u, 2019483917365790221u
+};
+
+static const uint64_t pow10[FTOA_MAX_DECIMALS + 1] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+/**
+ * @brief Counts how many times 5 divides a value.
+ * @param value - A nonzero value.
+ * @return The exponent of 5 in value.
+ */
+static uint32_t pow5_factor(uint32_t value) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Number of bits in 5^e.
+ * @param e - The exponent (0 to 3528).
+ * @return The bit length of 5^e.
+ */
+static int32_t pow5_bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+/**
+ * @brief floor(log10(2^e)).
+ * @param e - The exponent (0 to 1650).
+ * @return The decimal exponent.
+ */
+static uint32_t log10_pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+/**
+ * @brief floor(log10(5^e)).
+ * @param e - The exponent (0 to 2620).
+ * @return The decimal exponent.
+ */
+static uint32_t log10_pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+/**
+ * @brief Computes (m * factor) >> shift without losing the high bits.
+ * @param m - A 32-bit value.
+ * @param factor - A 64-bit table entry.
+ * @param shift - The shift, always more than 32.
+ * @return The shifted product.
+ */
+static uint32_t mul_shift(uint32_t m, uint64_t factor, int32_t shift) {
+    uint64_t low = (uint64_t)m * (uint32_t)factor;
+    uint64_t high = (uint64_t)m * (uint32_t)(factor >> 32);
+    return (uint32_t)(((low >> 32) + high) >> (shift - 32));
+}
+
+/**
+ * @brief Finds the shortest decimal that rounds to a finite, nonzero float.
+ *
+ * This is Ryu (Adams, PLDI 2018) for binary32. The float's rounding
+ * interval is scaled by a power of ten from the tables so that its bounds
+ * become integers vm < vr < vp, then digits are dropped while the bounds
+ * still differ, keeping track of whether everything dropped was zero so
+ * that exact halves round to even and closed bounds are honored.
+ *
+ * @param ieee_mantissa - The stored 23 mantissa bits.
+ * @param ieee_exponent - The stored 8 exponent bits.
+ * @param exponent - Receives the decimal exponent of the result.
+ * @return The digits, so that the value is digits * 10^exponent.
+ */
+static uint32_t shortest_digits(uint32_t ieee_mantissa, uint32_t ieee_exponent, int32_t *exponent) {
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t)ieee_exponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieee_mantissa;
+    }
+    int accept_bounds = (m2 & 1) == 0;
+
+    // The interval of values that round to this float, times 4 (times 2^e2)
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    // Scale it to decimal: vr, vp and vm times 10^e10
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    int vm_trailing_zeros = 0;
+    int vr_trailing_zeros = 0;
+    uint32_t last_removed = 0;
+    if (e2 >= 0) {
+        uint32_t q = log10_pow2(e2);
+        e10 = (int32_t)q;
+        int32_t k = POW5_INV_BITCOUNT + pow5_bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        vr = mul_shift(mv, pow5_inv_split[q], i);
+        vp = mul_shift(mp, pow5_inv_split[q], i);
+        vm = mul_shift(mm, pow5_inv_split[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            // The loop below may not run, but the digit after vr is still needed
+            int32_t l = POW5_INV_BITCOUNT + pow5_bits((int32_t)(q - 1)) - 1;
+            last_removed = mul_shift(mv, pow5_inv_split[q - 1], -e2 + (int32_t)q - 1 + l) % 10;
+        }
+        if (q <= 9) {
+            // At most one of mp, mv and mm is a multiple of 5
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = pow5_factor(mv) >= q;
+            } else if (accept_bounds) {
+                vm_trailing_zeros = pow5_factor(mm) >= q;
+            } else {
+                vp -= pow5_factor(mp) >= q;
+            }
+        }
+    } else {
+        uint32_t q = log10_pow5(-e2);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = pow5_bits(i) - POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = mul_shift(mv, pow5_split[i], j);
+        vp = mul_shift(mp, pow5_split[i], j);
+        vm = mul_shift(mm, pow5_split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (pow5_bits(i + 1) - POW5_BITCOUNT);
+            last_removed = mul_shift(mv, pow5_split[i + 1], j) % 10;
+        }
+        if (q <= 1) {
+            // mv = 4 * m2 always has two trailing zero bits; mm has one iff mm_shift
+            vr_trailing_zeros = 1;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                vp--;
+            }
+        } else if (q < 31) {
+            vr_trailing_zeros = (mv & ((1u << (q - 1)) - 1)) == 0;
+        }
+    }
+
+    // Drop digits while the interval still holds a shorter number
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        // Rare: an exact tie or a closed lower bound is possible
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) {
+            // Exactly ...5000: round half to even
+            last_removed = 4;
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        while (vp / 10 > vm / 10) {
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || last_removed >= 5);
+    }
+    *exponent = e10 + removed;
+    return output;
+}
+
+/**
+ * @brief Writes the decimal digits of a value, most significant first.
+ * @param out - Receives exactly count digits.
+ * @param value - The value.
+ * @param count - Number of digits to write (zero padded on the left).
+ */
+static void write_digits(char *out, uint64_t value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        out[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+}
+
+/**
+ * @brief Counts the decimal digits of a value.
+ * @param value - The value.
+ * @return Number of digits (1 for 0).
+ */
+static int digit_count(uint64_t value) {
+    int count = 1;
+    while (value >= 10) {
+        value /= 10;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Writes the shortest text that parses back to the same float.
+ * @param out - Receives the text.
+ * @param bits - The float's bit pattern.
+ * @return Number of characters written.
+ */
+static int write_shortest(char *out, uint32_t bits) {
+    uint32_t ieee_mantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    uint32_t ieee_exponent = (bits >> FLOAT_MANTISSA_BITS) & FLOAT_EXPONENT_MASK;
+    int length = 0;
+    if (bits >> 31) {
+        out[length++] = '-';
+    }
+    if (ieee_exponent == FLOAT_EXPONENT_MASK) {
+        const char *text = ieee_mantissa ? "nan" : "inf";
+        memcpy(out + length, text, 3);
+        return length + 3;
+    }
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        out[length++] = '0';
+        return length;
+    }
+
+    int32_t exponent;
+    uint32_t digits = shortest_digits(ieee_mantissa, ieee_exponent, &exponent);
+    int count = digit_count(digits);
+    int point = exponent + count;  // value = 0.digits * 10^point
+
+    if (point > SCIENTIFIC_ABOVE || point < SCIENTIFIC_BELOW) {
+        // d[.ddd]e<exponent>
+        write_digits(out + length + 1, digits, count);
+        out[length] = out[length + 1];
+        length += 1;
+        if (count > 1) {
+            out[length] = '.';
+            length += count;
+        }
+        int e = point - 1;
+        out[length++] = 'e';
+        if (e < 0) {
+            out[length++] = '-';
+            e = -e;
+        }
+        count = digit_count((uint64_t)e);
+        write_digits(out + length, (uint64_t)e, count);
+        return length + count;
+    }
+    if (point <= 0) {
+        // 0.000ddd
+        out[length++] = '0';
+        out[length++] = '.';
+        memset(out + length, '0', (size_t)-point);
+        length += -point;
+        write_digits(out + length, digits, count);
+        return length + count;
+    }
+    if (point >= count) {
+        // ddd000
+        write_digits(out + length, digits, count);
+        length += count;
+        memset(out + length, '0', (size_t)(point - count));
+        return length + point - count;
+    }
+    // dd.ddd
+    write_digits(out + length, digits / (uint32_t)pow10[count - point], point);
+    length += point;
+    out[length++] = '.';
+    write_digits(out + length, digits % (uint32_t)pow10[count - point], count - point);
+    return length + count - point;
+}
+
+/**
+ * @brief Writes a float with a fixed number of decimals, exactly as "%.Nf".
+ *
+ * value * 10^decimals is formed exactly as an integer times a power of two,
+ * then rounded half to even like printf. Only values too large for that
+ * to fit in 64 bits (beyond about 8e9) go through snprintf.
+ *
+ * @param out - Receives the text.
+ * @param value - The value.
+ * @param bits - The float's bit pattern.
+ * @param decimals - Number of decimals (0 to FTOA_MAX_DECIMALS).
+ * @return Number of characters written.
+ */
+static int write_fixed(char *out, float value, uint32_t bits, int decimals) {
+    uint32_t ieee_mantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    uint32_t ieee_exponent = (bits >> FLOAT_MANTISSA_BITS) & FLOAT_EXPONENT_MASK;
+    int32_t e2 = (ieee_exponent == 0 ? 1 : (int32_t)ieee_exponent) - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    uint64_t m2 = ieee_exponent == 0 ? ieee_mantissa : (1u << FLOAT_MANTISSA_BITS) | ieee_mantissa;
+
+    // Below 2^24 * 10^9 < 2^54, so this never overflows
+    uint64_t scaled = m2 * pow10[decimals];
+    if (ieee_exponent == FLOAT_EXPONENT_MASK ||
+        (e2 > 0 && (e2 >= 63 || (scaled >> (63 - e2)) != 0))) {
+        return snprintf(out, FTOA_MAX, "%.*f", decimals, value);
+    }
+    if (e2 >= 0) {
+        scaled <<= e2;
+    } else if (-e2 >= 64) {
+        scaled = 0;  // Less than 2^54 / 2^64: rounds to zero
+    } else {
+        uint64_t half = (uint64_t)1 << (-e2 - 1);
+        uint64_t remainder = scaled & ((half << 1) - 1);
+        scaled >>= -e2;
+        if (remainder > half || (remainder == half && (scaled & 1))) {
+            scaled++;
+        }
+    }
+
+    int length = 0;
+    if (bits >> 31) {
+        out[length++] = '-';
+    }
+    uint64_t whole = scaled / pow10[decimals];
+    int count = digit_count(whole);
+    write_digits(out + length, whole, count);
+    length += count;
+    if (decimals > 0) {
+        out[length++] = '.';
+        write_digits(out + length, scaled % pow10[decimals], decimals);
+        length += decimals;
+    }
+    return length;
+}
+
+/**
+ * @brief Writes a float as decimal text, without a terminator.
+ * @param out - Receives the text; must have room for FTOA_MAX characters.
+ * @param value - The value to write.
+ * @param precision - FTOA_SHORTEST, or the number of decimals.
+ * @return The number of characters written.
+ */
+int format_float(char *out, float value, int precision) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (precision == FTOA_SHORTEST) {
+        return write_shortest(out, bits);
+    }
+    return write_fixed(out, value, bits, precision);
+}
@@ -0,0 +1,37 @@
+/**
+ * @file      : ftoa.h
+ * @brief     : Declares the float-to-text conversion used when saving CSV
+ *              files: shortest round-trip digits or a fixed number of decimals.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef FTOA_H
+#define FTOA_H
+
+#define FTOA_SHORTEST   -1   /**< Precision that asks for the shortest exact digits. */
+#define FTOA_MAX_DECIMALS 9  /**< Most decimals a fixed precision may ask for. */
+#define FTOA_MAX        56   /**< Buffer size that holds any text format_float writes. */
+
+/**
+ * @brief Writes a float as decimal text, without a terminator.
+ *
+ * With FTOA_SHORTEST the text is the shortest decimal that parses back to
+ * exactly the same float (found with the Ryu algorithm, so no trial and
+ * error and no printf). It is plain ("0.125", "300") when the decimal
+ * point falls near the digits and scientific ("1.5e-7", "3.4028235e38")
+ * otherwise. With 0 to FTOA_MAX_DECIMALS decimals the text is exactly what
+ * printf's "%.Nf" gives, rounded from the float's exact value.
+ *
+ * @param out Receives the text; must have room for FTOA_MAX characters.
+ * @param value The value to write.
+ * @param precision FTOA_SHORTEST, or the number of decimals.
+ * @return The number of characters written.
+ */
+int format_float(char *out, float value, int precision);
+
+#endif /* FTOA_H */
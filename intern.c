@@ -0,0 +1,267 @@
+/**
+ * @file      : intern.c
+ * @brief     : Defines the name table that stores every vector name once
+ *              and refers to it by a 32-bit id.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "intern.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NAMES_INITIAL 16          /**< Names the table starts with room for. */
+#define NAMES_INITIAL_CHARS 256   /**< Bytes of text it starts with room for. */
+
+/**
+ * @brief Finds the bucket holding a name, or the empty bucket where it
+ * belongs.
+ * @param table - The table to search.
+ * @param name - First character of the name.
+ * @param length - Number of characters in the name.
+ * @param hash - hash_bytes of the name.
+ * @return Index of the bucket.
+ */
+static uint32_t probe(const NameTable *table, const char *name, size_t length,
+                      uint32_t hash) {
+    uint32_t mask = table->bucket_capacity - 1;
+    uint32_t i = hash & mask;
+    while (table->buckets[i] != NO_NAME) {
+        name_id id = table->buckets[i];
+        // Only equal hashes need the characters compared
+        if (table->hashes[id] == hash) {
+            const char *stored = table->chars + table->offsets[id];
+            if (strncmp(stored, name, length) == 0 && stored[length] == '\0') {
+                return i;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/**
+ * @brief Reallocates the buckets and reinserts every id using its stored
+ * hash, so no name text is read.
+ * @param table - The table to rehash.
+ * @param bucket_capacity - New number of buckets (a power of two).
+ * @return 1 if successful, 0 if allocation failed (old buckets kept).
+ */
+static int rehash(NameTable *table, uint32_t bucket_capacity) {
+    name_id *buckets = malloc((size_t)bucket_capacity * sizeof(name_id));
+    if (!buckets) {
+        return 0;
+    }
+    memset(buckets, 0xff, (size_t)bucket_capacity * sizeof(name_id));
+    uint32_t mask = bucket_capacity - 1;
+    for (name_id id = 0; id < table->count; id++) {
+        uint32_t i = table->hashes[id] & mask;
+        while (buckets[i] != NO_NAME) {
+            i = (i + 1) & mask;
+        }
+        buckets[i] = id;
+    }
+    free(table->buckets);
+    table->buckets = buckets;
+    table->bucket_capacity = bucket_capacity;
+    return 1;
+}
+
+/**
+ * @brief Initializes an empty name table.
+ * @param table - The table to initialize.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+int names_init(NameTable *table) {
+    memset(table, 0, sizeof(*table));
+    table->chars = malloc(NAMES_INITIAL_CHARS);
+    table->offsets = malloc(NAMES_INITIAL * sizeof(size_t));
+    table->hashes = malloc(NAMES_INITIAL * sizeof(uint32_t));
+    if (!table->chars || !table->offsets || !table->hashes ||
+        !rehash(table, 2 * NAMES_INITIAL)) {
+        names_free(table);
+        return 0;
+    }
+    table->chars_capacity = NAMES_INITIAL_CHARS;
+    table->capacity = NAMES_INITIAL;
+    return 1;
+}
+
+/**
+ * @brief Frees all memory owned by a name table.
+ * @param table - The table to free.
+ */
+void names_free(NameTable *table) {
+    free(table->chars);
+    free(table->offsets);
+    free(table->hashes);
+    free(table->buckets);
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * @brief Forgets every name, keeping the allocated memory for reuse.
+ * @param table - The table to clear.
+ */
+void names_clear(NameTable *table) {
+    table->count = 0;
+    table->chars_used = 0;
+    memset(table->buckets, 0xff, (size_t)table->bucket_capacity * sizeof(name_id));
+}
+
+/**
+ * @brief Makes room for at least count names without rehashing.
+ * @param table - The table to grow.
+ * @param count - Number of names expected.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+int names_reserve(NameTable *table, uint32_t count) {
+    if (count > table->capacity) {
+        size_t *offsets = realloc(table->offsets, (size_t)count * sizeof(size_t));
+        if (!offsets) {
+            return 0;
+        }
+        table->offsets = offsets;
+        uint32_t *hashes = realloc(table->hashes, (size_t)count * sizeof(uint32_t));
+        if (!hashes) {
+            return 0;
+        }
+        table->hashes = hashes;
+        table->capacity = count;
+    }
+    // Keep the buckets at most half full
+    uint32_t bucket_capacity = table->bucket_capacity;
+    while ((uint64_t)count * 2 > bucket_capacity) {
+        bucket_capacity *= 2;
+    }
+    return bucket_capacity == table->bucket_capacity || rehash(table, bucket_capacity);
+}
+
+/**
+ * @brief Gives back the memory the table holds beyond its current names.
+ * @param table - The table to shrink.
+ * @return 1 if successful, 0 if some allocation could not be shrunk.
+ */
+int names_shrink(NameTable *table) {
+    uint32_t bucket_capacity = 2 * NAMES_INITIAL;
+    while ((uint64_t)table->count * 2 > bucket_capacity) {
+        bucket_capacity *= 2;
+    }
+    if (bucket_capacity < table->bucket_capacity && !rehash(table, bucket_capacity)) {
+        return 0;
+    }
+
+    size_t chars_capacity = table->chars_used > NAMES_INITIAL_CHARS ? table->chars_used
+                                                                    : NAMES_INITIAL_CHARS;
+    if (chars_capacity < table->chars_capacity) {
+        char *chars = realloc(table->chars, chars_capacity);
+        if (!chars) {
+            return 0;
+        }
+        table->chars = chars;
+        table->chars_capacity = chars_capacity;
+    }
+
+    uint32_t capacity = table->count > NAMES_INITIAL ? table->count : NAMES_INITIAL;
+    if (capacity < table->capacity) {
+        size_t *offsets = realloc(table->offsets, (size_t)capacity * sizeof(size_t));
+        if (!offsets) {
+            return 0;
+        }
+        // capacity bounds both arrays, so it can drop before hashes shrinks
+        table->offsets = offsets;
+        table->capacity = capacity;
+        uint32_t *hashes = realloc(table->hashes, (size_t)capacity * sizeof(uint32_t));
+        if (!hashes) {
+            return 0;
+        }
+        table->hashes = hashes;
+    }
+    return 1;
+}
+
+/**
+ * @brief Measures the table's memory.
+ * @param table - The table to measure.
+ * @param used - Receives the bytes holding names.
+ * @return The bytes allocated.
+ */
+size_t names_memory(const NameTable *table, size_t *used) {
+    size_t per_name = sizeof(size_t) + sizeof(uint32_t);
+    *used = table->chars_used + (size_t)table->count * (per_name + sizeof(name_id));
+    return table->chars_capacity + (size_t)table->capacity * per_name +
+           (size_t)table->bucket_capacity * sizeof(name_id);
+}
+
+/**
+ * @brief Returns the id of a name, adding it to the table if needed.
+ * @param table - The table to search and extend.
+ * @param name - First character of the name (need not be null-terminated).
+ * @param length - Number of characters in the name.
+ * @return The name's id, or NO_NAME if allocation failed.
+ */
+name_id names_intern(NameTable *table, const char *name, size_t length) {
+    uint32_t hash = hash_bytes(name, length);
+    uint32_t bucket = probe(table, name, length, hash);
+    if (table->buckets[bucket] != NO_NAME) {
+        return table->buckets[bucket];
+    }
+    if (table->count == NO_NAME - 1) {
+        return NO_NAME;
+    }
+
+    // Grow geometrically; a rehash moves the name's bucket
+    if (table->count == table->capacity) {
+        if (!names_reserve(table, table->capacity * 2)) {
+            return NO_NAME;
+        }
+        bucket = probe(table, name, length, hash);
+    }
+    if (table->chars_used + length + 1 > table->chars_capacity) {
+        size_t chars_capacity = table->chars_capacity * 2;
+        while (table->chars_used + length + 1 > chars_capacity) {
+            chars_capacity *= 2;
+        }
+        char *chars = realloc(table->chars, chars_capacity);
+        if (!chars) {
+            return NO_NAME;
+        }
+        table->chars = chars;
+        table->chars_capacity = chars_capacity;
+    }
+
+    name_id id = table->count++;
+    table->offsets[id] = table->chars_used;
+    table->hashes[id] = hash;
+    memcpy(table->chars + table->chars_used, name, length);
+    table->chars[table->chars_used + length] = '\0';
+    table->chars_used += length + 1;
+    table->buckets[bucket] = id;
+    return id;
+}
+
+/**
+ * @brief Finds the id of a name without adding it.
+ * @param table - The table to search.
+ * @param name - First character of the name (need not be null-terminated).
+ * @param length - Number of characters in the name.
+ * @return The name's id, or NO_NAME if it was never interned.
+ */
+name_id names_lookup(const NameTable *table, const char *name, size_t length) {
+    return table->buckets[probe(table, name, length, hash_bytes(name, length))];
+}
+
+/**
+ * @brief Returns the text of an interned name.
+ * @param table - The table holding the name.
+ * @param id - An id returned by names_intern.
+ * @return The null-terminated name, or "" for NO_NAME.
+ */
+const char *names_get(const NameTable *table, name_id id) {
+    return id < table->count ? table->chars + table->offsets[id] : "";
+}
@@ -0,0 +1,118 @@
+/**
+ * @file      : intern.h
+ * @brief     : Declares the name table that stores every vector name once
+ *              and refers to it by a 32-bit id.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define NO_NAME UINT32_MAX   /**< An id that refers to no name. */
+
+/**
+ * @brief Identifies an interned name. Ids are dense, starting at 0.
+ */
+typedef uint32_t name_id;
+
+/**
+ * @brief Interned strings with an open-addressing hash of their ids.
+ *
+ * Names are stored back to back, null-terminated, in one character
+ * buffer. The hash of each name is kept next to its offset so lookups
+ * compare hashes before characters and growth never rehashes text.
+ */
+typedef struct {
+    char *chars;             /**< Every name, null-terminated, back to back. */
+    size_t chars_used;       /**< Bytes of chars in use. */
+    size_t chars_capacity;   /**< Bytes allocated for chars. */
+    size_t *offsets;         /**< Start of each name in chars, by id. */
+    uint32_t *hashes;        /**< Hash of each name, by id. */
+    uint32_t count;          /**< Number of names interned. */
+    uint32_t capacity;       /**< Entries allocated in offsets and hashes. */
+    name_id *buckets;        /**< Hash of names to ids (NO_NAME = empty). */
+    uint32_t bucket_capacity;/**< Number of buckets (always a power of two). */
+} NameTable;
+
+/**
+ * @brief Initializes an empty name table.
+ * @param table The table to initialize.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+int names_init(NameTable *table);
+
+/**
+ * @brief Frees all memory owned by a name table.
+ * @param table The table to free.
+ */
+void names_free(NameTable *table);
+
+/**
+ * @brief Forgets every name, keeping the allocated memory for reuse.
+ * @param table The table to clear.
+ */
+void names_clear(NameTable *table);
+
+/**
+ * @brief Makes room for at least count names without rehashing.
+ * @param table The table to grow.
+ * @param count Number of names expected.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+int names_reserve(NameTable *table, uint32_t count);
+
+/**
+ * @brief Gives back the memory the table holds beyond its current names,
+ * e.g., after names_clear.
+ * @param table The table to shrink.
+ * @return 1 if successful, 0 if some allocation could not be shrunk (the
+ *         table stays usable).
+ */
+int names_shrink(NameTable *table);
+
+/**
+ * @brief Measures the table's memory.
+ * @param table The table to measure.
+ * @param used Receives the bytes holding names: their text, offsets,
+ *             hashes and one bucket each.
+ * @return The bytes allocated.
+ */
+size_t names_memory(const NameTable *table, size_t *used);
+
+/**
+ * @brief Returns the id of a name, adding it to the table if needed.
+ * @param table The table to search and extend.
+ * @param name First character of the name (need not be null-terminated).
+ * @param length Number of characters in the name.
+ * @return The name's id, or NO_NAME if allocation failed.
+ */
+name_id names_intern(NameTable *table, const char *name, size_t length);
+
+/**
+ * @brief Finds the id of a name without adding it.
+ * @param table The table to search.
+ * @param name First character of the name (need not be null-terminated).
+ * @param length Number of characters in the name.
+ * @return The name's id, or NO_NAME if it was never interned.
+ */
+name_id names_lookup(const NameTable *table, const char *name, size_t length);
+
+/**
+ * @brief Returns the text of an interned name.
+ * The pointer is valid until the next names_intern, names_clear or
+ * names_shrink.
+ * @param table The table holding the name.
+ * @param id An id returned by names_intern.
+ * @return The null-terminated name, or "" for NO_NAME.
+ */
+const char *names_get(const NameTable *table, name_id id);
+
+#endif /* INTERN_H */
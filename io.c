@@ -10,21 +10,637 @@
  * Section    : 112
  */
 
+#define _POSIX_C_SOURCE 200809L // Needed for open, fstat and mmap under -std=c11
+
 #include "io.h"
 #include "vector.h"
+#include "util.h"
+#include "pool.h"
+#include "wide.h"
+#include "stats.h"
+#include "ftoa.h"
+#include "predicate.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h> // Needed to use the bool type, and true/false values
 #include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #define MAX_LENGTH 1024
+#define LOAD_BATCH 4096
+#define LOAD_PIECE_BYTES (1 << 20)   /**< Bytes of CSV text parsed per task. */
+#define SAVE_FIELD_MAX   (1 + FTOA_MAX) /**< Longest ",c" field format_float can produce. */
+#define STREAM_BUFFER_SIZE (1 << 16) /**< Bytes read per call while streaming. */
+
+#define VBIN_MAGIC      "VBIN"
+#define VBIN_VERSION    1
+#define VBIN_ENDIAN_TAG 0x01020304u
+#define VCOL_MAGIC      "VCOL"
+#define VCOL_VERSION    1
+#define VCOL_CHUNK_ROWS 4096   /**< Rows per .vcol chunk: the zone-map granularity. */
+#define VCOL_ALIGN      8      /**< Chunks start on multiples of this many bytes. */
+#define FNV64_OFFSET    14695981039346656037ULL
+#define FNV64_PRIME     1099511628211ULL
+
+/**
+ * @brief Fixed header at the start of every .vbin snapshot.
+ *
+ * The component array starts immediately after the header and holds
+ * count * components floats; the name table follows it and holds count
+ * null-terminated names in the same order.
+ */
+typedef struct {
+    char magic[4];          /**< Always "VBIN". */
+    uint32_t version;       /**< Format version, VBIN_VERSION. */
+    uint32_t endian_tag;    /**< VBIN_ENDIAN_TAG as written by the saver. */
+    uint32_t components;    /**< Floats per vector (the store dimension). */
+    uint64_t count;         /**< Number of vectors in the snapshot. */
+    uint64_t names_size;    /**< Size of the name table in bytes. */
+    uint64_t checksum;      /**< Hash of the component array then the name table. */
+} VbinHeader;
+
+/**
+ * @brief Fixed header at the start of every .vcol file.
+ *
+ * The chunk directory follows it: one VcolChunk per chunk, each followed
+ * by the chunk's zone map as components floats of minima then components
+ * floats of maxima. Each chunk holds up to chunk_rows rows as one column
+ * of floats per component, then the rows' null-terminated names, padded
+ * to VCOL_ALIGN bytes.
+ */
+typedef struct {
+    char magic[4];          /**< Always "VCOL". */
+    uint32_t version;       /**< Format version, VCOL_VERSION. */
+    uint32_t endian_tag;    /**< VBIN_ENDIAN_TAG as written by the saver. */
+    uint32_t components;    /**< Floats per vector (the store dimension). */
+    uint64_t count;         /**< Number of vectors in the file. */
+    uint32_t chunk_rows;    /**< Rows per chunk; only the last holds fewer. */
+    uint32_t chunk_count;   /**< Number of chunks. */
+    uint64_t checksum;      /**< Hash of the chunk directory. */
+} VcolHeader;
+
+/**
+ * @brief One chunk's entry in a .vcol directory (its zone map follows it).
+ */
+typedef struct {
+    uint64_t offset;        /**< File offset of the chunk's first column. */
+    uint64_t names_size;    /**< Bytes of names after the columns. */
+    uint64_t checksum;      /**< Hash of the columns then the names. */
+    uint32_t rows;          /**< Rows in the chunk. */
+    uint32_t reserved;      /**< Zero. */
+    double min_norm;        /**< Smallest |v| in the chunk. */
+    double max_norm;        /**< Largest |v| in the chunk. */
+} VcolChunk;
+
+/**
+ * @brief Size of one .vcol directory entry, zone map included.
+ * @param dim Components per vector.
+ * @return Bytes per entry (a multiple of VCOL_ALIGN).
+ */
+static size_t vcol_entry_size(int dim) {
+    return sizeof(VcolChunk) + 2 * (size_t)dim * sizeof(float);
+}
+
+/**
+ * @brief Rounds a size up to a multiple of VCOL_ALIGN.
+ * @param size The size.
+ * @return The rounded size.
+ */
+static size_t vcol_align(size_t size) {
+    return (size + VCOL_ALIGN - 1) / VCOL_ALIGN * VCOL_ALIGN;
+}
+
+static bool load_vcol(VectorStore *store, const char *filename, const Predicate *where,
+                      VcolScan *scan);
+
+/**
+ * @brief A read-only view of a whole file's contents.
+ *
+ * Regular files are mapped with mmap so parsing reads the page cache
+ * directly; anything that cannot be mapped (pipes, special files) is
+ * read into a heap buffer instead.
+ */
+typedef struct {
+    const char *data;   /**< First byte of the file contents. */
+    size_t size;        /**< Number of bytes in the file. */
+    bool mapped;        /**< true if data came from mmap, false if malloc. */
+} FileView;
+
+/**
+ * @brief Reads an entire file descriptor into a heap buffer.
+ * @param fd Open file descriptor to read until end of file.
+ * @param view Receives the buffer and its size.
+ * @return true if successful, false on a read or allocation error.
+ */
+static bool read_whole_fd(int fd, FileView *view) {
+    size_t capacity = MAX_LENGTH;
+    size_t size = 0;
+    char *buffer = malloc(capacity);
+    if (!buffer) {
+        return false;
+    }
+    for (;;) {
+        if (size == capacity) {
+            char *temp = realloc(buffer, capacity * 2);
+            if (!temp) {
+                free(buffer);
+                return false;
+            }
+            buffer = temp;
+            capacity *= 2;
+        }
+        ssize_t got = read(fd, buffer + size, capacity - size);
+        if (got < 0) {
+            free(buffer);
+            return false;
+        }
+        if (got == 0) {
+            break;
+        }
+        size += (size_t)got;
+    }
+    view->data = buffer;
+    view->size = size;
+    view->mapped = false;
+    return true;
+}
+
+/**
+ * @brief Opens a file and exposes its contents as a FileView.
+ * @param filename Path of the file to open.
+ * @param view Receives the file contents.
+ * @return true if successful, false if the file could not be opened or read.
+ */
+static bool open_file_view(const char *filename, FileView *view) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    bool ok = false;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        view->size = (size_t)info.st_size;
+        view->mapped = true;
+        if (view->size == 0) {
+            // mmap rejects zero-length mappings; an empty file is just empty
+            view->data = NULL;
+            ok = true;
+        } else {
+            void *data = mmap(NULL, view->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                posix_madvise(data, view->size, POSIX_MADV_SEQUENTIAL);
+                view->data = data;
+                ok = true;
+            }
+        }
+    }
+    if (!ok) {
+        ok = read_whole_fd(fd, view);
+    }
+    close(fd);
+    return ok;
+}
+
+/**
+ * @brief Releases the memory behind a FileView.
+ * @param view The view to release.
+ */
+static void close_file_view(FileView *view) {
+    if (view->mapped) {
+        if (view->data != NULL) {
+            munmap((void *)view->data, view->size);
+        }
+    } else {
+        free((void *)view->data);
+    }
+    view->data = NULL;
+    view->size = 0;
+}
+
+/**
+ * @brief Parses one "name,x,y,z" line in place.
+ *
+ * The name is the text before the first comma; it is not copied, only
+ * measured, so the caller can intern it straight out of the line. Each
+ * component is read with parse_float. A line with more or fewer than dim
+ * fields after the name is malformed.
+ *
+ * @param line First character of the line.
+ * @param end One past the last character of the line (newline excluded).
+ * @param components Receives dim parsed components.
+ * @param dim Number of components every line must have.
+ * @param name_length Receives the length of the name at the line start.
+ * @return true if the line is well formed, false otherwise.
+ */
+static bool parse_csv_line(const char *line, const char *end, float *components,
+                           int dim, size_t *name_length) {
+    const char *comma = memchr(line, ',', (size_t)(end - line));
+    if (comma == NULL || comma == line) {
+        return false;
+    }
+    *name_length = (size_t)(comma - line);
+
+    const char *p = comma + 1;
+    for (int i = 0; i < dim; i++) {
+        p = parse_float(p, end, &components[i]);
+        if (p == NULL) {
+            return false;
+        }
+        // Each component ends at a comma, and the last one at the line end
+        if (i == dim - 1) {
+            return p == end;
+        }
+        if (p == end || *p != ',') {
+            return false;
+        }
+        p++;
+    }
+    return true;
+}
+
+/**
+ * @brief Folds a block of bytes into a 64-bit FNV-1a style checksum.
+ *
+ * Consumes eight bytes per step instead of one so that checksumming a
+ * large snapshot costs far less than reading it.
+ *
+ * @param hash Running checksum (start with FNV64_OFFSET).
+ * @param data Bytes to fold in.
+ * @param size Number of bytes.
+ * @return The updated checksum.
+ */
+static uint64_t checksum_update(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    while (size >= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bytes, sizeof(word));
+        hash = (hash ^ word) * FNV64_PRIME;
+        bytes += sizeof(word);
+        size -= sizeof(word);
+    }
+    while (size > 0) {
+        hash = (hash ^ *bytes++) * FNV64_PRIME;
+        size--;
+    }
+    return hash;
+}
+
+/**
+ * @brief One newline-aligned piece of a CSV file and what it parsed to.
+ */
+typedef struct {
+    const char *start;  /**< First character of the piece (a line start). */
+    const char *end;    /**< One past its last character. */
+    int dim;            /**< Components per row. */
+    vector *vectors;    /**< Parsed rows in file order, not yet named. */
+    float *rows;        /**< Components of each row when dim is not 3. */
+    const char **names; /**< Where each row's name starts in the file. */
+    size_t *name_lengths; /**< Length of each row's name. */
+    int count;          /**< Number of parsed rows. */
+    int lines;          /**< Number of lines in the piece. */
+    int *bad_lines;     /**< Piece-relative numbers of malformed lines. */
+    int bad_count;      /**< Number of malformed lines. */
+    bool failed;        /**< true if an allocation failed. */
+} LoadPiece;
+
+/**
+ * @brief Parses one piece of a CSV file; runs as a worker pool task.
+ * @param context Array of LoadPiece.
+ * @param task Index of the piece to parse.
+ */
+static void parse_piece(void *context, int task) {
+    LoadPiece *piece = (LoadPiece *)context + task;
+    const char *end = piece->end;
+
+    // Count lines so the piece's row array is allocated exactly once
+    int lines = 0;
+    for (const char *p = piece->start; p < end; lines++) {
+        const char *newline = memchr(p, '\n', (size_t)(end - p));
+        p = newline ? newline + 1 : end;
+    }
+    piece->lines = lines;
+    size_t rows = (size_t)(lines > 0 ? lines : 1);
+    piece->vectors = malloc(rows * sizeof(vector));
+    piece->names = malloc(rows * sizeof(char *));
+    piece->name_lengths = malloc(rows * sizeof(size_t));
+    if (piece->dim != 3) {
+        piece->rows = malloc(rows * (size_t)piece->dim * sizeof(float));
+    }
+    if (!piece->vectors || !piece->names || !piece->name_lengths ||
+        (piece->dim != 3 && !piece->rows)) {
+        piece->failed = true;
+        return;
+    }
+
+    int bad_capacity = 0;
+    int line_number = 0;
+    const char *p = piece->start;
+    while (p < end) {
+        const char *newline = memchr(p, '\n', (size_t)(end - p));
+        const char *line_end = newline ? newline : end;
+        line_number++;
+
+        // Tolerate Windows line endings
+        const char *content_end = line_end;
+        if (content_end > p && content_end[-1] == '\r') {
+            content_end--;
+        }
+
+        if (content_end > p) {
+            float *components = piece->rows
+                                    ? piece->rows + (size_t)piece->count * piece->dim
+                                    : &piece->vectors[piece->count].x;
+            if (parse_csv_line(p, content_end, components, piece->dim,
+                               &piece->name_lengths[piece->count])) {
+                piece->names[piece->count++] = p;
+            } else {
+                // Warnings are printed later, in file order
+                if (piece->bad_count == bad_capacity) {
+                    bad_capacity = bad_capacity ? bad_capacity * 2 : 8;
+                    int *temp = realloc(piece->bad_lines, (size_t)bad_capacity * sizeof(int));
+                    if (!temp) {
+                        piece->failed = true;
+                        return;
+                    }
+                    piece->bad_lines = temp;
+                }
+                piece->bad_lines[piece->bad_count++] = line_number;
+            }
+        }
+        p = newline ? newline + 1 : end;
+    }
+}
+
+/**
+ * @brief Splits file contents into pieces that each end after a newline.
+ * @param data First byte of the file.
+ * @param size Number of bytes in the file.
+ * @param count Receives the number of pieces.
+ * @return Zero-initialized pieces (NULL for an empty file or on failure).
+ */
+static LoadPiece *split_pieces(const char *data, size_t size, int *count) {
+    size_t limit = size / LOAD_PIECE_BYTES + 1;
+    const char *end = data + size;
+
+    *count = 0;
+    LoadPiece *pieces = calloc(limit, sizeof(LoadPiece));
+    if (!pieces) {
+        return NULL;
+    }
+    for (const char *p = data; p < end; (*count)++) {
+        const char *cut = (size_t)(end - p) > LOAD_PIECE_BYTES ? p + LOAD_PIECE_BYTES : end;
+        if (cut < end) {
+            const char *newline = memchr(cut, '\n', (size_t)(end - cut));
+            cut = newline ? newline + 1 : end;
+        }
+        pieces[*count].start = p;
+        pieces[*count].end = cut;
+        p = cut;
+    }
+    return pieces;
+}
+
+/**
+ * @brief Finds the dimension of a CSV file from its first line that parses.
+ *
+ * Lines before it (a header or a stray word) are left for the parser to
+ * report as malformed.
+ *
+ * @param data First byte of the file.
+ * @param size Number of bytes in the file.
+ * @return Number of fields after the name. With no line that parses, the
+ * first line's count if it is too wide to load, else 3.
+ */
+static int detect_dimension(const char *data, size_t size) {
+    const char *end = data + size;
+    int first_dim = 0;
+    float components[WIDE_MAX_DIM];
+    for (const char *p = data; p < end; ) {
+        const char *newline = memchr(p, '\n', (size_t)(end - p));
+        const char *line_end = newline ? newline : end;
+        const char *content_end = line_end;
+        if (content_end > p && content_end[-1] == '\r') {
+            content_end--;
+        }
+        int commas = 0;
+        bool blank = true;
+        for (const char *c = p; c < content_end; c++) {
+            commas += *c == ',';
+            blank = blank && isspace((unsigned char)*c);
+        }
+        if (!blank) {
+            first_dim = first_dim ? first_dim : commas;
+            size_t name_length;
+            if (commas >= 1 && commas <= WIDE_MAX_DIM &&
+                parse_csv_line(p, content_end, components, commas, &name_length)) {
+                return commas;
+            }
+        }
+        p = line_end + 1;
+    }
+    return first_dim > WIDE_MAX_DIM ? first_dim : 3;
+}
+
+/**
+ * @brief Frees what parsing left in each piece.
+ * @param pieces The pieces.
+ * @param count Number of pieces.
+ */
+static void free_pieces(LoadPiece *pieces, int count) {
+    for (int i = 0; i < count; i++) {
+        free(pieces[i].vectors);
+        free(pieces[i].rows);
+        free(pieces[i].names);
+        free(pieces[i].name_lengths);
+        free(pieces[i].bad_lines);
+    }
+    free(pieces);
+}
+
+/**
+ * @brief Loads one or more CSV files (the body of load_vectors for
+ * non-vbin files, and of load_vectors_merge).
+ *
+ * Every file is mapped and split into pieces at newline boundaries, and
+ * the pieces of all files are parsed in one pool job. They are merged in
+ * the order the files were given and, within a file, in file order, so
+ * when a name occurs more than once the last occurrence wins and the
+ * result never depends on the thread count. Every file is opened and
+ * checked before the store is touched.
+ *
+ * @param store Pointer to the VectorStore to load vectors into.
+ * @param filenames The CSV files.
+ * @param file_count Number of files.
+ * @param merge true to keep the store's vectors (the files must then
+ * match its dimension, unless it is empty), false to clear it first.
+ * @return true if every file was read and merged.
+ */
+static bool load_csv_files(VectorStore *store, const char *const *filenames, int file_count,
+                           bool merge){
+    FileView *views = calloc((size_t)file_count, sizeof(FileView));
+    int *first_piece = malloc(((size_t)file_count + 1) * sizeof(int));
+    LoadPiece *pieces = NULL;
+    int piece_count = 0;
+    int opened = 0;
+    int dim = 0;
+    const char *dim_source = NULL;
+    bool ok = views != NULL && first_piece != NULL;
+    if (!ok) {
+        fprintf(stderr, "Memory allocation failed.\n");
+    }
+
+    for (int f = 0; ok && f < file_count; f++) {
+        if (!open_file_view(filenames[f], &views[f])) {
+            // fprintf needed for a file
+            fprintf(stderr, "Error: could not read the file '%s'\n", filenames[f]);
+            ok = false;
+            break;
+        }
+        opened++;
+
+        // An empty shard has no dimension to disagree with
+        if (views[f].size > 0) {
+            int file_dim = detect_dimension(views[f].data, views[f].size);
+            if (file_dim < 1 || file_dim > WIDE_MAX_DIM) {
+                fprintf(stderr, "Error: '%s' has %d components per line (1 to %d allowed).\n",
+                        filenames[f], file_dim, WIDE_MAX_DIM);
+                ok = false;
+                break;
+            }
+            if (dim_source != NULL && file_dim != dim) {
+                fprintf(stderr, "Error: '%s' has %d components per line but '%s' has %d.\n",
+                        filenames[f], file_dim, dim_source, dim);
+                ok = false;
+                break;
+            }
+            dim = file_dim;
+            dim_source = filenames[f];
+        }
+
+        int count;
+        LoadPiece *file_pieces = split_pieces(views[f].data, views[f].size, &count);
+        LoadPiece *temp = file_pieces ? realloc(pieces, (size_t)(piece_count + count + 1) * sizeof(LoadPiece))
+                                      : NULL;
+        if (!temp) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            free(file_pieces);
+            ok = false;
+            break;
+        }
+        pieces = temp;
+        memcpy(pieces + piece_count, file_pieces, (size_t)count * sizeof(LoadPiece));
+        free(file_pieces);
+        first_piece[f] = piece_count;
+        piece_count += count;
+    }
+
+    bool keep = merge && store->count > 0;
+    if (dim_source == NULL) {
+        // Only empty files: a load resets to 3D, a merge changes nothing
+        dim = keep ? store->dim : 3;
+    } else if (ok && keep && dim != store->dim) {
+        fprintf(stderr, "Error: '%s' has %d components per line but the store holds %d.\n",
+                dim_source, dim, store->dim);
+        ok = false;
+    }
+
+    if (ok) {
+        first_piece[file_count] = piece_count;
+        for (int i = 0; i < piece_count; i++) {
+            pieces[i].dim = dim;
+        }
+        // clear existing vectors before loading new ones
+        if (!keep) {
+            clear_vectors(store);
+        }
+        if (dim != store->dim) {
+            ok = set_dimension(store, dim);
+        }
+    }
+
+    if (ok) {
+        pool_run(store->pool, piece_count, parse_piece, pieces);
+
+        int total = 0;
+        for (int i = 0; i < piece_count; i++) {
+            ok = ok && !pieces[i].failed;
+            total += pieces[i].count;
+        }
+        if (!ok) {
+            fprintf(stderr, "Memory allocation failed.\n");
+        }
+        ok = ok && reserve_vectors(store, store->count + total);
+
+        for (int f = 0; f < file_count; f++) {
+            // Pieces count their own lines; the file can have more than INT_MAX
+            long long first_line = 0;
+            for (int i = first_piece[f]; i < first_piece[f + 1]; i++) {
+                LoadPiece *piece = &pieces[i];
+                for (int j = 0; ok && j < piece->bad_count; j++) {
+                    if (file_count == 1) {
+                        fprintf(stderr, "Warning: Skipping malformed line %lld.\n",
+                                first_line + piece->bad_lines[j]);
+                    } else {
+                        fprintf(stderr, "Warning: Skipping malformed line %lld of '%s'.\n",
+                                first_line + piece->bad_lines[j], filenames[f]);
+                    }
+                }
+                // Interning needs the shared name table, so it happens here in order
+                for (int j = 0; ok && j < piece->count; j++) {
+                    piece->vectors[j].id = store_name(store, piece->names[j], piece->name_lengths[j]);
+                    ok = piece->vectors[j].id != NO_NAME;
+                }
+                ok = ok && append_vectors(store, piece->vectors, piece->rows, piece->count);
+                first_line += piece->lines;
+            }
+        }
+    }
+
+    free_pieces(pieces, piece_count);
+    for (int f = 0; f < opened; f++) {
+        close_file_view(&views[f]);
+    }
+    free(views);
+    free(first_piece);
+    return ok;
+}
+
+/**
+ * @brief Loads a CSV file (the body of load_vectors for non-vbin files).
+ * @param store Pointer to the VectorStore to load vectors into.
+ * @param filename Filename of the csv file which is being read.
+ * @return true if the file was successfully opened and read.
+ */
+static bool load_csv(VectorStore *store, const char *filename){
+    return load_csv_files(store, &filename, 1, false);
+}
 
 /**
  * @brief Takes input from a csv file and loads them into vector arrays.
  *
  * This function will clear any existing vectors in the store before
  * loading the new ones from the file. It will skip any
- * malformed lines in the file and print a warning.
+ * malformed lines in the file and print a warning with the line number.
+ * Filenames ending in ".vbin" are loaded as a binary snapshot instead, and
+ * ".vcol" files as a columnar file.
+ *
+ * The file is mapped into memory and scanned in place: lines are found
+ * with memchr, fields are parsed without being copied, and numbers go
+ * through the locale-independent parse_float. The store is reserved once
+ * for the number of lines in the file and rows are appended in batches
+ * through append_vectors, so no per-row message is printed.
+ *
+ * The store takes the dimension of the file's first line that parses;
+ * other lines with a different number of fields are skipped as malformed.
  *
  * @param store Pointer to the VectorStore to load vectors into.
  * @param filename Filename of the csv file which is being read.
@@ -32,58 +648,177 @@
  * @return false if the file could not be opened (e.g., does not exist).
  */
 bool load_vectors(VectorStore *store, const char *filename){
-    // 'r' is used for reading a file
-    FILE *file = fopen(filename, "r");
-    // creating an array with the max length of a line
-    char line[MAX_LENGTH];
-
-    if(file == NULL){
-        // fprintf needed for a file
-        fprintf(stderr, "Error: could not read the file '%s'\n", filename);
-        return false;
-    }
+    STATS_START(start);
+    bool ok = has_extension(filename, ".vbin") ? load_vectors_vbin(store, filename)
+            : has_extension(filename, ".vcol") ? load_vcol(store, filename, NULL, NULL)
+                                               : load_csv(store, filename);
+    STATS_STOP(STAT_LOAD, start);
+    return ok;
+}
 
-    // clear existing vectors before loading new ones
-    clear_vectors(store);
+/**
+ * @brief Merges several CSV files into the store.
+ * @param store Pointer to the VectorStore to merge into.
+ * @param filenames The CSV files, in the order their vectors are applied.
+ * @param count Number of files.
+ * @return true if every file was read and merged.
+ */
+bool load_vectors_merge(VectorStore *store, const char *const *filenames, int count){
+    STATS_START(start);
+    bool ok = load_csv_files(store, filenames, count, true);
+    STATS_STOP(STAT_LOAD, start);
+    return ok;
+}
 
-    while (fgets(line, MAX_LENGTH, file) != NULL) {
-        // Remove newline at the end if present
-        line[strcspn(line, "\n")] = '\0';
+/**
+ * @brief State shared by the chunk tasks of a CSV save.
+ */
+typedef struct {
+    const VectorStore *store;  /**< The vectors being saved. */
+    int first_chunk;           /**< Chunk formatted by task 0 of this wave. */
+    char **buffers;            /**< One text buffer per task of a wave. */
+    size_t *capacities;        /**< Bytes allocated for each buffer. */
+    size_t *lengths;           /**< Bytes written to each buffer (SIZE_MAX on failure). */
+} SaveJob;
 
-        // begins reading at the beginning of the line 
-        char *name = strtok(line, ",");
-        // NULL tells the strtok command to begin where it left off
-        char *x_str = strtok(NULL, ",");
-        char *y_str = strtok(NULL, ",");
-        char *z_str = strtok(NULL, ",");
+/**
+ * @brief Formats one chunk of vectors as CSV text; runs as a pool task.
+ * @param context The SaveJob.
+ * @param task Index of the chunk within the current wave.
+ */
+static void format_chunk(void *context, int task) {
+    SaveJob *job = context;
+    int first = (job->first_chunk + task) * POOL_CHUNK_VECTORS;
+    int last = first + POOL_CHUNK_VECTORS;
+    if (last > job->store->count) {
+        last = job->store->count;
+    }
 
-        // Check formatting, skip any line with incorrect parameters
-        if (!name || !x_str || !y_str || !z_str) {
-            fprintf(stderr, "Warning: Skipping malformed line.\n");
-            continue; // skip this bad line, move on to next
+    // Names have no length limit, so size the buffer for this chunk
+    size_t needed = 0;
+    for (int i = first; i < last; i++) {
+        needed += strlen(vector_name(job->store, &job->store->vectors[i])) +
+                  (size_t)job->store->dim * SAVE_FIELD_MAX + 1;
+    }
+    if (needed > job->capacities[task]) {
+        char *temp = realloc(job->buffers[task], needed);
+        if (!temp) {
+            job->lengths[task] = SIZE_MAX;
+            return;
         }
+        job->buffers[task] = temp;
+        job->capacities[task] = needed;
+    }
+    char *out = job->buffers[task];
+    size_t length = 0;
 
-        // Create a vector and fill in data
-        vector v;
-        strncpy(v.name, name, sizeof(v.name) - 1);
-        v.name[sizeof(v.name) - 1] = '\0'; // ensure null-terminated
-        v.x = atof(x_str);
-        v.y = atof(y_str);
-        v.z = atof(z_str);
+    // Write each vector as: name,x,y,z
+    int precision = job->store->precision;
+    for (int i = first; i < last; i++) {
+        const vector *v = &job->store->vectors[i];
+        const char *name = vector_name(job->store, v);
+        size_t name_length = strlen(name);
+        memcpy(out + length, name, name_length);
+        length += name_length;
+        const float *row = vector_row(job->store, v);
+        for (int d = 0; d < job->store->dim; d++) {
+            out[length++] = ',';
+            length += (size_t)format_float(out + length, row[d], precision);
+        }
+        out[length++] = '\n';
+    }
+    job->lengths[task] = length;
+}
 
-        // Add it to the vector store
-        add_vector(store, v);
+/**
+ * @brief Writes a whole buffer to a file descriptor.
+ * @param fd The file.
+ * @param data The bytes to write.
+ * @param length Number of bytes.
+ * @return true if everything was written.
+ */
+static bool write_all(int fd, const char *data, size_t length){
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
     }
-    fclose(file);
     return true;
 }
 
+/**
+ * @brief Saves a CSV file (the body of save_vectors for non-vbin files).
+ *
+ * Each chunk of rows is formatted into its own buffer (a few hundred KB)
+ * and handed to write directly, so there is no stdio copy and a file takes
+ * a handful of system calls rather than one per buffer-full.
+ *
+ * @param store Pointer to the VectorStore containing the vectors to save.
+ * @param filename Filename of the csv file to which the data is being saved.
+ * @return true if the file was successfully opened for writing and saved.
+ */
+static bool save_csv(const VectorStore *store, const char *filename){
+    // open file for writing (overwrite mode)
+    int file = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+    if (file < 0) {
+        fprintf(stderr, "Error: could not open file '%s'\n", filename);
+        return false;
+    }
+
+    // Chunks are formatted in parallel a wave at a time, then written in order
+    int chunks = pool_chunks(store->count);
+    int wave = pool_threads(store->pool) * 2;
+    SaveJob job;
+    job.store = store;
+    job.buffers = calloc((size_t)wave, sizeof(char *));
+    job.capacities = calloc((size_t)wave, sizeof(size_t));
+    job.lengths = malloc((size_t)wave * sizeof(size_t));
+    bool ok = job.buffers && job.capacities && job.lengths;
+    if (!ok) {
+        fprintf(stderr, "Memory allocation failed.\n");
+    }
+
+    for (job.first_chunk = 0; ok && job.first_chunk < chunks; job.first_chunk += wave) {
+        int tasks = chunks - job.first_chunk < wave ? chunks - job.first_chunk : wave;
+        pool_run(store->pool, tasks, format_chunk, &job);
+        for (int i = 0; ok && i < tasks; i++) {
+            if (job.lengths[i] == SIZE_MAX) {
+                fprintf(stderr, "Memory allocation failed.\n");
+                ok = false;
+            } else {
+                ok = write_all(file, job.buffers[i], job.lengths[i]);
+            }
+        }
+    }
+
+    for (int i = 0; job.buffers && i < wave; i++) {
+        free(job.buffers[i]);
+    }
+    free(job.buffers);
+    free(job.capacities);
+    free(job.lengths);
+    if (close(file) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
 /**
  * @brief Takes array of vectors and stores them into a csv file.
  *
  * Writes all vectors currently in the store to the specified file,
  * overwriting the file if it already exists. Vectors are
- * saved in the format "name,x,y,z".
+ * saved in the format "name,x,y,z", each component written as
+ * store->precision asks (exactly, by default). Filenames ending in
+ * ".vbin" are written as a binary snapshot instead, and ".vcol" as a
+ * chunked columnar file.
  *
  * @param store Pointer to the VectorStore containing the vectors to save.
  * @param filename Filename of the csv file to which the data is being saved.
@@ -91,24 +826,677 @@ bool load_vectors(VectorStore *store, const char *filename){
  * @return false if the file could not be opened for writing.
  */
 bool save_vectors(const VectorStore *store, const char *filename){
-    FILE *file = fopen(filename, "w");  // open file for writing (overwrite mode)
+    STATS_START(start);
+    bool ok = has_extension(filename, ".vbin") ? save_vectors_vbin(store, filename)
+            : has_extension(filename, ".vcol") ? save_vectors_vcol(store, filename)
+                                               : save_csv(store, filename);
+    STATS_STOP(STAT_SAVE, start);
+    return ok;
+}
+
+/**
+ * @brief Loads a binary snapshot written by save_vectors_vbin.
+ *
+ * Everything is validated against the mapped file before the store is
+ * cleared. Loading then interns the names from the name table and copies
+ * the component array into the store in bulk (see fill_vectors), with no
+ * text parsing at all.
+ *
+ * @param store Pointer to the VectorStore to load vectors into.
+ * @param filename Filename of the .vbin snapshot.
+ * @return true if the snapshot was valid and loaded.
+ * @return false if the file could not be read or failed validation.
+ */
+bool load_vectors_vbin(VectorStore *store, const char *filename){
+    FileView view;
+    VbinHeader header;
+
+    if (!open_file_view(filename, &view)) {
+        fprintf(stderr, "Error: could not read the file '%s'\n", filename);
+        return false;
+    }
+
+    // Validate the header and that the sections exactly fill the file
+    bool valid = view.size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, view.data, sizeof(header));
+        valid = memcmp(header.magic, VBIN_MAGIC, sizeof(header.magic)) == 0 &&
+                header.version == VBIN_VERSION &&
+                header.endian_tag == VBIN_ENDIAN_TAG &&
+                header.components >= 1 && header.components <= WIDE_MAX_DIM &&
+                header.count <= INT_MAX &&
+                header.names_size <= view.size - sizeof(header) &&
+                view.size - sizeof(header) - header.names_size ==
+                    header.count * header.components * sizeof(float);
+    }
+    if (!valid) {
+        fprintf(stderr, "Error: '%s' is not a valid vbin snapshot\n", filename);
+        close_file_view(&view);
+        return false;
+    }
 
+    int dim = (int)header.components;
+    size_t row_size = (size_t)dim * sizeof(float);
+    const char *components = view.data + sizeof(header);
+    size_t components_size = header.count * row_size;
+    const char *names = components + components_size;
+    const char *names_end = names + header.names_size;
+
+    uint64_t checksum = checksum_update(FNV64_OFFSET, components, components_size);
+    checksum = checksum_update(checksum, names, header.names_size);
+    if (checksum != header.checksum) {
+        fprintf(stderr, "Error: checksum mismatch in '%s'\n", filename);
+        close_file_view(&view);
+        return false;
+    }
+
+    // Intern the names into a table of their own, so a truncated table or
+    // a repeated name is found while the store is still untouched
+    int count = (int)header.count;
+    NameTable table;
+    bool ok = names_init(&table);
+    if (ok && !names_reserve(&table, (uint32_t)count)) {
+        names_free(&table);
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "Memory allocation failed.\n");
+    }
+    for (int i = 0; ok && i < count; i++) {
+        const char *terminator = memchr(names, '\0', (size_t)(names_end - names));
+        if (terminator == NULL) {
+            fprintf(stderr, "Error: truncated name table in '%s'\n", filename);
+            ok = false;
+            break;
+        }
+        name_id id = names_intern(&table, names, (size_t)(terminator - names));
+        if (id == NO_NAME) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            ok = false;
+        } else if (id != (name_id)i) {
+            fprintf(stderr, "Error: '%s' names a vector twice\n", filename);
+            ok = false;
+        }
+        names = terminator + 1;
+    }
+    if (!ok) {
+        names_free(&table);
+        close_file_view(&view);
+        return false;
+    }
+
+    // Only now is the store replaced; the components are copied as one block
+    clear_vectors(store);
+    ok = dim == store->dim || set_dimension(store, dim);
+    if (!ok) {
+        names_free(&table);
+    } else if (!fill_vectors(store, &table, (const float *)components, count)) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        ok = false;
+    }
+
+    close_file_view(&view);
+    return ok;
+}
+
+/**
+ * @brief Writes every vector in the store to a binary snapshot.
+ *
+ * Both sections are assembled in memory first so the checksum can be
+ * computed before the header is written; the file is then produced with
+ * three large fwrite calls.
+ *
+ * @param store Pointer to the VectorStore containing the vectors to save.
+ * @param filename Filename of the .vbin snapshot to write.
+ * @return true if the snapshot was written completely.
+ * @return false if the file could not be opened or written.
+ */
+bool save_vectors_vbin(const VectorStore *store, const char *filename){
+    size_t components_size = (size_t)store->count * store->dim * sizeof(float);
+    size_t names_size = 0;
+    for (int i = 0; i < store->count; i++) {
+        names_size += strlen(vector_name(store, &store->vectors[i])) + 1;
+    }
+
+    float *components = malloc(components_size > 0 ? components_size : 1);
+    char *names = malloc(names_size > 0 ? names_size : 1);
+    if (!components || !names) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        free(components);
+        free(names);
+        return false;
+    }
+
+    char *name_cursor = names;
+    for (int i = 0; i < store->count; i++) {
+        const vector *v = &store->vectors[i];
+        memcpy(components + (size_t)i * store->dim, vector_row(store, v),
+               (size_t)store->dim * sizeof(float));
+        const char *name = vector_name(store, v);
+        size_t length = strlen(name) + 1;
+        memcpy(name_cursor, name, length);
+        name_cursor += length;
+    }
+
+    VbinHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, VBIN_MAGIC, sizeof(header.magic));
+    header.version = VBIN_VERSION;
+    header.endian_tag = VBIN_ENDIAN_TAG;
+    header.components = (uint32_t)store->dim;
+    header.count = (uint64_t)store->count;
+    header.names_size = names_size;
+    header.checksum = checksum_update(FNV64_OFFSET, components, components_size);
+    header.checksum = checksum_update(header.checksum, names, names_size);
+
+    bool ok = false;
+    FILE *file = fopen(filename, "wb");
     if (!file) {
         fprintf(stderr, "Error: could not open file '%s'\n", filename);
+    } else {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(components, 1, components_size, file) == components_size &&
+             fwrite(names, 1, names_size, file) == names_size;
+        if (fclose(file) != 0) {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Error: could not write file '%s'\n", filename);
+        }
+    }
+
+    free(components);
+    free(names);
+    return ok;
+}
+
+/**
+ * @brief Widens a chunk's zone map to cover one row.
+ * @param row The row's components.
+ * @param dim Number of components.
+ * @param min Smallest value of each component so far.
+ * @param max Largest value of each component so far.
+ * @param chunk Directory entry whose |v| range is widened.
+ */
+static void zone_add_row(const float *row, int dim, float *min, float *max, VcolChunk *chunk){
+    for (int d = 0; d < dim; d++) {
+        if (isnan(row[d])) {
+            // A NaN fails every comparison, so no range can vouch for it
+            min[d] = -INFINITY;
+            max[d] = INFINITY;
+        } else {
+            min[d] = row[d] < min[d] ? row[d] : min[d];
+            max[d] = row[d] > max[d] ? row[d] : max[d];
+        }
+    }
+    double norm = predicate_norm(row, dim);
+    if (isnan(norm)) {
+        chunk->min_norm = -INFINITY;
+        chunk->max_norm = INFINITY;
+    } else {
+        chunk->min_norm = norm < chunk->min_norm ? norm : chunk->min_norm;
+        chunk->max_norm = norm > chunk->max_norm ? norm : chunk->max_norm;
+    }
+}
+
+/**
+ * @brief Writes every vector in the store to a columnar file.
+ *
+ * The chunks are written first, one buffer each, after room left for
+ * the header and directory; the directory, filled in as the chunks were
+ * built, is then written at the front.
+ *
+ * @param store Pointer to the VectorStore containing the vectors to save.
+ * @param filename Filename of the .vcol file to write.
+ * @return true if the file was written completely.
+ * @return false if the file could not be opened or written.
+ */
+bool save_vectors_vcol(const VectorStore *store, const char *filename){
+    int dim = store->dim;
+    uint32_t chunk_count = (uint32_t)((store->count + VCOL_CHUNK_ROWS - 1) / VCOL_CHUNK_ROWS);
+    size_t entry_size = vcol_entry_size(dim);
+    size_t directory_size = (size_t)chunk_count * entry_size;
+    char *directory = calloc(directory_size > 0 ? directory_size : 1, 1);
+    char *buffer = NULL;
+    size_t capacity = 0;
+    if (!directory) {
+        fprintf(stderr, "Memory allocation failed.\n");
         return false;
     }
 
-    // Write each vector as: name,x,y,z
-    // loop over the vectors in store
-    for (int i = 0; i < store->count; i++) {
-        // print accordingly to a csv file
-        fprintf(file, "%s,%.4f,%.4f,%.4f\n",
-                store->vectors[i].name,
-                store->vectors[i].x,
-                store->vectors[i].y,
-                store->vectors[i].z);
+    int file = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (file < 0) {
+        fprintf(stderr, "Error: could not open file '%s'\n", filename);
+        free(directory);
+        return false;
+    }
+
+    // Chunks go after room for the header and directory, written last
+    uint64_t offset = vcol_align(sizeof(VcolHeader) + directory_size);
+    bool ok = lseek(file, (off_t)offset, SEEK_SET) == (off_t)offset;
+    for (uint32_t c = 0; ok && c < chunk_count; c++) {
+        int first = (int)c * VCOL_CHUNK_ROWS;
+        int rows = store->count - first < VCOL_CHUNK_ROWS ? store->count - first : VCOL_CHUNK_ROWS;
+        size_t columns_size = (size_t)rows * dim * sizeof(float);
+        size_t names_size = 0;
+        for (int i = first; i < first + rows; i++) {
+            names_size += strlen(vector_name(store, &store->vectors[i])) + 1;
+        }
+        size_t chunk_size = vcol_align(columns_size + names_size);
+        if (chunk_size > capacity) {
+            char *temp = realloc(buffer, chunk_size);
+            if (!temp) {
+                fprintf(stderr, "Memory allocation failed.\n");
+                ok = false;
+                break;
+            }
+            buffer = temp;
+            capacity = chunk_size;
+        }
+
+        // Column d holds component d of every row, then the names follow
+        VcolChunk *chunk = (VcolChunk *)(directory + c * entry_size);
+        float *min = (float *)(chunk + 1);
+        float *max = min + dim;
+        float *columns = (float *)buffer;
+        char *names = buffer + columns_size;
+        for (int d = 0; d < dim; d++) {
+            min[d] = INFINITY;
+            max[d] = -INFINITY;
+        }
+        chunk->min_norm = INFINITY;
+        chunk->max_norm = -INFINITY;
+        for (int r = 0; r < rows; r++) {
+            const vector *v = &store->vectors[first + r];
+            const float *row = vector_row(store, v);
+            for (int d = 0; d < dim; d++) {
+                columns[(size_t)d * rows + r] = row[d];
+            }
+            zone_add_row(row, dim, min, max, chunk);
+            const char *name = vector_name(store, v);
+            size_t length = strlen(name) + 1;
+            memcpy(names, name, length);
+            names += length;
+        }
+        memset(names, 0, chunk_size - columns_size - names_size);
+
+        chunk->offset = offset;
+        chunk->rows = (uint32_t)rows;
+        chunk->names_size = names_size;
+        chunk->checksum = checksum_update(FNV64_OFFSET, buffer, columns_size + names_size);
+        ok = write_all(file, buffer, chunk_size);
+        offset += chunk_size;
+    }
+
+    if (ok) {
+        VcolHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, VCOL_MAGIC, sizeof(header.magic));
+        header.version = VCOL_VERSION;
+        header.endian_tag = VBIN_ENDIAN_TAG;
+        header.components = (uint32_t)dim;
+        header.count = (uint64_t)store->count;
+        header.chunk_rows = VCOL_CHUNK_ROWS;
+        header.chunk_count = chunk_count;
+        header.checksum = checksum_update(FNV64_OFFSET, directory, directory_size);
+        ok = lseek(file, 0, SEEK_SET) == 0 &&
+             write_all(file, (const char *)&header, sizeof(header)) &&
+             write_all(file, directory, directory_size);
+    }
+    if (close(file) != 0) {
+        ok = false;
     }
+    if (!ok) {
+        fprintf(stderr, "Error: could not write file '%s'\n", filename);
+    }
+    free(buffer);
+    free(directory);
+    return ok;
+}
 
-    fclose(file);
+/**
+ * @brief Validates a .vcol file's header and directory against its size.
+ * @param view The mapped file.
+ * @param header Receives the header.
+ * @return true if every chunk the directory describes lies inside the file.
+ */
+static bool vcol_valid(const FileView *view, VcolHeader *header){
+    if (view->size < sizeof(*header)) {
+        return false;
+    }
+    memcpy(header, view->data, sizeof(*header));
+    if (memcmp(header->magic, VCOL_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != VCOL_VERSION || header->endian_tag != VBIN_ENDIAN_TAG ||
+        header->components < 1 || header->components > WIDE_MAX_DIM ||
+        header->count > INT_MAX || header->chunk_rows < 1 ||
+        header->chunk_count != (header->count + header->chunk_rows - 1) / header->chunk_rows) {
+        return false;
+    }
+    int dim = (int)header->components;
+    size_t entry_size = vcol_entry_size(dim);
+    size_t directory_size = (size_t)header->chunk_count * entry_size;
+    if (directory_size > view->size - sizeof(*header) ||
+        checksum_update(FNV64_OFFSET, view->data + sizeof(*header), directory_size) !=
+            header->checksum) {
+        return false;
+    }
+
+    uint64_t remaining = header->count;
+    for (uint32_t c = 0; c < header->chunk_count; c++) {
+        const VcolChunk *chunk = (const VcolChunk *)(view->data + sizeof(*header) + c * entry_size);
+        uint64_t rows = remaining < header->chunk_rows ? remaining : header->chunk_rows;
+        uint64_t columns_size = rows * (uint64_t)dim * sizeof(float);
+        if (chunk->rows != rows || chunk->offset % VCOL_ALIGN != 0 ||
+            chunk->offset < sizeof(*header) + directory_size || chunk->offset > view->size ||
+            columns_size > view->size - chunk->offset ||
+            chunk->names_size > view->size - chunk->offset - columns_size) {
+            return false;
+        }
+        remaining -= rows;
+    }
     return true;
 }
+
+/**
+ * @brief Loads a columnar file, optionally only the rows matching a predicate.
+ *
+ * The header and directory are validated first. Each chunk is then judged
+ * from its zone map: chunks that cannot match are never touched (the rest
+ * are announced to the kernel with POSIX_MADV_WILLNEED so only their pages
+ * are read), chunks that match entirely are copied without testing, and
+ * the others are tested row by row. The chunks to be read are checksummed
+ * before the store is cleared, so a corrupt file leaves it unchanged.
+ *
+ * @param store Pointer to the VectorStore to load vectors into.
+ * @param filename Filename of the .vcol file.
+ * @param where Rows to keep, or NULL for all of them.
+ * @param scan Receives the row and chunk counts, or NULL.
+ * @return true if the file was valid and loaded.
+ */
+static bool load_vcol(VectorStore *store, const char *filename, const Predicate *where,
+                      VcolScan *scan){
+    FileView view;
+    VcolHeader header;
+
+    if (!open_file_view(filename, &view)) {
+        fprintf(stderr, "Error: could not read the file '%s'\n", filename);
+        return false;
+    }
+    if (view.mapped && view.data != NULL) {
+        // Chunks are visited selectively, so read ahead only where asked to
+        posix_madvise((void *)view.data, view.size, POSIX_MADV_RANDOM);
+    }
+    if (!vcol_valid(&view, &header)) {
+        fprintf(stderr, "Error: '%s' is not a valid vcol file\n", filename);
+        close_file_view(&view);
+        return false;
+    }
+    int dim = (int)header.components;
+    if (where != NULL && where->max_column >= dim) {
+        fprintf(stderr, "Error: the predicate uses c%d, but '%s' has only %d components\n",
+                where->max_column, filename, dim);
+        close_file_view(&view);
+        return false;
+    }
+
+    // Judge every chunk and verify the ones that will be read
+    size_t entry_size = vcol_entry_size(dim);
+    const char *directory = view.data + sizeof(header);
+    zone_match_t *matches = malloc((header.chunk_count > 0 ? header.chunk_count : 1) *
+                                   sizeof(zone_match_t));
+    vector *batch = malloc(LOAD_BATCH * sizeof(vector));
+    float *rows = dim != 3 ? malloc(LOAD_BATCH * (size_t)dim * sizeof(float)) : NULL;
+    bool ok = matches && batch && (dim == 3 || rows);
+    if (!ok) {
+        fprintf(stderr, "Memory allocation failed.\n");
+    }
+    long page = sysconf(_SC_PAGESIZE);
+    int chunks_read = 0;
+    for (uint32_t c = 0; ok && c < header.chunk_count; c++) {
+        const VcolChunk *chunk = (const VcolChunk *)(directory + c * entry_size);
+        ZoneMap zone;
+        zone.min = (const float *)(chunk + 1);
+        zone.max = zone.min + dim;
+        zone.min_norm = chunk->min_norm;
+        zone.max_norm = chunk->max_norm;
+        matches[c] = where ? predicate_zone(where, &zone) : ZONE_ALL;
+        if (matches[c] == ZONE_NONE) {
+            continue;
+        }
+        size_t size = (size_t)chunk->rows * dim * sizeof(float) + chunk->names_size;
+        if (view.mapped && page > 0) {
+            size_t start = (size_t)chunk->offset / (size_t)page * (size_t)page;
+            posix_madvise((void *)(view.data + start), (size_t)chunk->offset - start + size,
+                          POSIX_MADV_WILLNEED);
+        }
+        if (checksum_update(FNV64_OFFSET, view.data + chunk->offset, size) != chunk->checksum) {
+            fprintf(stderr, "Error: checksum mismatch in chunk %u of '%s'\n", c, filename);
+            ok = false;
+        }
+        chunks_read++;
+    }
+
+    if (ok) {
+        clear_vectors(store);
+        if (dim != store->dim) {
+            ok = set_dimension(store, dim);
+        }
+    }
+    int pending = 0;
+    for (uint32_t c = 0; ok && c < header.chunk_count; c++) {
+        if (matches[c] == ZONE_NONE) {
+            continue;
+        }
+        const VcolChunk *chunk = (const VcolChunk *)(directory + c * entry_size);
+        const float *columns = (const float *)(view.data + chunk->offset);
+        const char *names = (const char *)(columns + (size_t)chunk->rows * dim);
+        const char *names_end = names + chunk->names_size;
+        if (matches[c] == ZONE_ALL) {
+            ok = reserve_vectors(store, store->count + (int)chunk->rows);
+        }
+        for (uint32_t r = 0; ok && r < chunk->rows; r++) {
+            const char *terminator = memchr(names, '\0', (size_t)(names_end - names));
+            if (terminator == NULL) {
+                fprintf(stderr, "Error: truncated name table in '%s'\n", filename);
+                ok = false;
+                break;
+            }
+            vector *v = &batch[pending];
+            float *row = rows ? rows + (size_t)pending * dim : &v->x;
+            for (int d = 0; d < dim; d++) {
+                row[d] = columns[(size_t)d * chunk->rows + r];
+            }
+            if (matches[c] == ZONE_SOME && !predicate_row(where, row, dim)) {
+                names = terminator + 1;
+                continue;
+            }
+            v->id = store_name(store, names, (size_t)(terminator - names));
+            if (v->id == NO_NAME) {
+                ok = false;
+                break;
+            }
+            names = terminator + 1;
+
+            if (++pending == LOAD_BATCH) {
+                ok = append_vectors(store, batch, rows, pending);
+                pending = 0;
+            }
+        }
+    }
+    if (ok && pending > 0) {
+        ok = append_vectors(store, batch, rows, pending);
+    }
+
+    if (scan != NULL) {
+        scan->rows = (long long)header.count;
+        scan->chunks = (int)header.chunk_count;
+        scan->chunks_read = chunks_read;
+    }
+    free(matches);
+    free(batch);
+    free(rows);
+    close_file_view(&view);
+    return ok;
+}
+
+/**
+ * @brief Loads the vectors of a .vcol file that match a predicate.
+ * @param store Pointer to the VectorStore to load vectors into.
+ * @param filename Filename of the .vcol file.
+ * @param where Rows to keep.
+ * @param scan Receives the row and chunk counts.
+ * @return true if the file was valid and loaded.
+ */
+bool load_vectors_where(VectorStore *store, const char *filename, const Predicate *where,
+                        VcolScan *scan){
+    if (!has_extension(filename, ".vcol")) {
+        fprintf(stderr, "Error: 'where' needs a columnar .vcol file (save one with "
+                "'save <name>.vcol')\n");
+        return false;
+    }
+    STATS_START(start);
+    bool ok = load_vcol(store, filename, where, scan);
+    STATS_STOP(STAT_LOAD, start);
+    return ok;
+}
+
+/**
+ * @brief Folds one parsed row into the running aggregates.
+ * @param stats The aggregates to update.
+ * @param v The row.
+ */
+static void stream_accumulate(StreamStats *stats, const vector *v) {
+    float c[3] = {v->x, v->y, v->z};
+    if (stats->count == 0) {
+        memcpy(stats->min, c, sizeof(c));
+        memcpy(stats->max, c, sizeof(c));
+    }
+    for (int i = 0; i < 3; i++) {
+        stats->sum[i] += c[i];
+        stats->min[i] = c[i] < stats->min[i] ? c[i] : stats->min[i];
+        stats->max[i] = c[i] > stats->max[i] ? c[i] : stats->max[i];
+    }
+    double length_sq = (double)c[0] * c[0] + (double)c[1] * c[1] + (double)c[2] * c[2];
+    stats->magnitude += sqrt(length_sq);
+    stats->dot += (double)c[0] * stats->ref.x + (double)c[1] * stats->ref.y +
+                  (double)c[2] * stats->ref.z;
+    stats->count++;
+}
+
+/**
+ * @brief Computes aggregates over a CSV file without loading it.
+ *
+ * Complete lines are parsed straight out of the read buffer; a partial
+ * line at the end of the buffer is moved to the front before the next
+ * read. A line longer than the whole buffer is skipped as malformed.
+ * The aggregates are 3-D, so a file whose first well-formed row has
+ * another number of components is refused rather than truncated.
+ *
+ * @param filename The CSV file to read, or "-" for stdin.
+ * @param stats Receives the aggregates (stats->ref is read, not reset).
+ * @return true if the whole file was read.
+ * @return false if the file could not be opened or read.
+ */
+bool stream_vectors(const char *filename, StreamStats *stats){
+    bool from_stdin = strcmp(filename, "-") == 0;
+    int fd = from_stdin ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: could not read the file '%s'\n", filename);
+        return false;
+    }
+    char *buffer = malloc(STREAM_BUFFER_SIZE);
+    if (!buffer) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        if (!from_stdin) {
+            close(fd);
+        }
+        return false;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    vector ref = stats->ref;
+    memset(stats, 0, sizeof(*stats));
+    stats->ref = ref;
+
+    bool ok = true;
+    bool skipping = false;     // Inside a line too long for the buffer
+    long long line_number = 0;
+    size_t filled = 0;
+    for (;;) {
+        ssize_t got = read(fd, buffer + filled, STREAM_BUFFER_SIZE - filled);
+        if (got < 0) {
+            fprintf(stderr, "Error: could not read the file '%s'\n", filename);
+            ok = false;
+            break;
+        }
+        bool at_eof = got == 0;
+        filled += (size_t)got;
+
+        const char *p = buffer;
+        const char *end = buffer + filled;
+        while (p < end) {
+            const char *newline = memchr(p, '\n', (size_t)(end - p));
+            if (!newline && !at_eof) {
+                break;
+            }
+            const char *line_end = newline ? newline : end;
+            line_number++;
+
+            // Tolerate Windows line endings
+            const char *content_end = line_end;
+            if (content_end > p && content_end[-1] == '\r') {
+                content_end--;
+            }
+
+            // The aggregates are 3-D; summing the first three fields of wider rows would mislead
+            int dim = 3;
+            if (!skipping && content_end > p && stats->count == 0) {
+                dim = detect_dimension(p, (size_t)(content_end - p));
+            }
+            if (dim != 3) {
+                fprintf(stderr, "Error: 'stream' needs 3-component rows; line %lld has %d.\n",
+                        line_number, dim);
+                ok = false;
+                break;
+            }
+
+            vector v;
+            size_t name_length;
+            if (skipping) {
+                skipping = false;
+            } else if (content_end > p) {
+                if (parse_csv_line(p, content_end, &v.x, 3, &name_length)) {
+                    stream_accumulate(stats, &v);
+                } else {
+                    fprintf(stderr, "Warning: Skipping malformed line %lld.\n", line_number);
+                    stats->malformed++;
+                }
+            }
+            p = newline ? newline + 1 : end;
+        }
+        if (at_eof || !ok) {
+            break;
+        }
+
+        // Keep the unfinished line; drop it if it fills the whole buffer
+        filled = (size_t)(end - p);
+        if (filled == STREAM_BUFFER_SIZE) {
+            if (!skipping) {
+                fprintf(stderr, "Warning: Skipping malformed line %lld.\n", line_number + 1);
+                stats->malformed++;
+            }
+            skipping = true;
+            filled = 0;
+        } else {
+            memmove(buffer, p, filled);
+        }
+    }
+
+    free(buffer);
+    if (!from_stdin) {
+        close(fd);
+    }
+    return ok;
+}
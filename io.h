@@ -14,10 +14,28 @@
 #define IO_H
 
 #include "vector.h"
+#include "predicate.h"
 #include <stdbool.h>
 
+/**
+ * @brief Aggregates computed by stream_vectors in a single pass.
+ * Sums are accumulated in double precision.
+ */
+typedef struct {
+    long long count;       /**< Number of well-formed rows. */
+    long long malformed;   /**< Number of rows skipped as malformed. */
+    double sum[3];         /**< Component-wise sum (x, y, z). */
+    float min[3];          /**< Lower corner of the bounding box. */
+    float max[3];          /**< Upper corner of the bounding box. */
+    double magnitude;      /**< Sum of the vectors' lengths. */
+    vector ref;            /**< Reference vector for the dot product. */
+    double dot;            /**< Sum of each row's dot product with ref. */
+} StreamStats;
+
 /**
  * @brief Takes input from a csv file and loads them into vector arrays.
+ * Filenames ending in ".vbin" are read with load_vectors_vbin instead, and
+ * ".vcol" files as a columnar file.
  * @param store Pointer to the VectorStore to initialize.
  * @param filename Filename of the csv file which is being read.
  * @return true if the file was successfully opened and read.
@@ -27,6 +45,10 @@ bool load_vectors(VectorStore *store, const char *filename);
 
 /**
  * @brief Takes array of vectors and stores them into a csv file.
+ * Components are written as store->precision asks (see format_float); by
+ * default that is the shortest text that loads back as the same float.
+ * Filenames ending in ".vbin" are written with save_vectors_vbin instead,
+ * and ".vcol" with save_vectors_vcol.
  * @param store Pointer to the VectorStore to initialize.
  *Type: uploaded file
  * @param filename Filename of the csv file to which the data is being saved.
@@ -35,4 +57,111 @@ bool load_vectors(VectorStore *store, const char *filename);
  */
 bool save_vectors(const VectorStore *store, const char *filename);
 
+/**
+ * @brief Merges several CSV files into the store without clearing it.
+ *
+ * The files are split at newline boundaries and parsed in parallel
+ * together, then merged in the order given (each file top to bottom), so
+ * for a name that occurs more than once, in the store or in the files,
+ * the last occurrence wins whatever the thread count. The files must
+ * share one dimension, which must match the store's unless it is empty.
+ * Nothing is changed if a file cannot be read or the dimensions differ.
+ *
+ * @param store Pointer to the VectorStore to merge into.
+ * @param filenames The CSV files.
+ * @param count Number of files.
+ * @return true if every file was read and merged.
+ * @return false if a file could not be read, the dimensions differ or
+ * memory ran out.
+ */
+bool load_vectors_merge(VectorStore *store, const char *const *filenames, int count);
+
+/**
+ * @brief Loads a binary snapshot written by save_vectors_vbin.
+ *
+ * The file is mapped and validated (magic, version, sizes and checksum)
+ * before the store is touched, so a corrupt snapshot leaves it unchanged.
+ *
+ * @param store Pointer to the VectorStore to load vectors into.
+ * @param filename Filename of the .vbin snapshot.
+ * @return true if the snapshot was valid and loaded.
+ * @return false if the file could not be read or failed validation.
+ */
+bool load_vectors_vbin(VectorStore *store, const char *filename);
+
+/**
+ * @brief Writes every vector in the store to a binary snapshot.
+ *
+ * Layout: a fixed header, the x/y/z components of all vectors as raw
+ * floats, then a table of null-terminated names in the same order. The
+ * header carries a checksum over both sections. Values are stored
+ * bit-exact, so a save/load cycle loses no precision.
+ *
+ * @param store Pointer to the VectorStore containing the vectors to save.
+ * @param filename Filename of the .vbin snapshot to write.
+ * @return true if the snapshot was written completely.
+ * @return false if the file could not be opened or written.
+ */
+bool save_vectors_vbin(const VectorStore *store, const char *filename);
+
+/**
+ * @brief How much of a .vcol file a load had to read.
+ */
+typedef struct {
+    long long rows;    /**< Vectors in the file. */
+    int chunks;        /**< Chunks in the file. */
+    int chunks_read;   /**< Chunks not ruled out by their zone maps. */
+} VcolScan;
+
+/**
+ * @brief Writes every vector in the store to a chunked columnar file.
+ *
+ * Rows are grouped into chunks of 4096. Each chunk stores one column of
+ * floats per component followed by the rows' names, and its directory
+ * entry at the front of the file carries a zone map: the minimum and
+ * maximum of every component and of |v|. Values are stored bit-exact.
+ *
+ * @param store Pointer to the VectorStore containing the vectors to save.
+ * @param filename Filename of the .vcol file to write.
+ * @return true if the file was written completely.
+ * @return false if the file could not be opened or written.
+ */
+bool save_vectors_vcol(const VectorStore *store, const char *filename);
+
+/**
+ * @brief Loads the vectors of a .vcol file that match a predicate.
+ *
+ * Chunks whose zone maps rule the predicate out are skipped without
+ * reading them, and chunks it covers entirely are loaded without testing
+ * each row. The store is replaced, as by load_vectors.
+ *
+ * @param store Pointer to the VectorStore to load vectors into.
+ * @param filename Filename of the .vcol file.
+ * @param where Rows to keep.
+ * @param scan Receives the row and chunk counts.
+ * @return true if the file was valid and loaded.
+ * @return false if it is not a .vcol file, could not be read, failed
+ * validation or has fewer components than the predicate uses.
+ */
+bool load_vectors_where(VectorStore *store, const char *filename, const Predicate *where,
+                        VcolScan *scan);
+
+/**
+ * @brief Computes aggregates over a CSV file without loading it.
+ *
+ * The file is passed once through a fixed-size buffer, so memory use does
+ * not depend on its size and the store is never touched. Lines use the
+ * same "name,x,y,z" format as load_vectors; a filename of "-" reads
+ * standard input. Only 3-component rows are supported: a file whose first
+ * well-formed row has another number of components is refused with an
+ * error.
+ *
+ * @param filename The CSV file to read, or "-" for stdin.
+ * @param stats Receives the aggregates; stats->ref must be set by the
+ *              caller before the call.
+ * @return true if the whole file was read.
+ * @return false if the file could not be opened or read, or is not 3-D.
+ */
+bool stream_vectors(const char *filename, StreamStats *stats);
+
 #endif // IO_H
\ No newline at end of file
@@ -0,0 +1,581 @@
+/**
+ * @file      : journal.c
+ * @brief     : Defines the append-only change journal that pairs a binary
+ *              snapshot with a log of every change made since it.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#define _POSIX_C_SOURCE 200809L // Needed for fileno, fsync and truncate under -std=c11
+
+#include "journal.h"
+#include "io.h"
+#include "util.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOG_MAGIC       "VLOG"
+#define LOG_VERSION     1u
+#define LOG_ENDIAN_TAG  0x01020304u
+#define LOG_HEADER_SIZE 12            /**< Magic, version and endian tag. */
+#define LOG_BUFFER_SIZE (1 << 20)     /**< stdio buffer of the open log. */
+#define LOG_NAME_MAX    UINT16_MAX    /**< Longest name a record can hold. */
+
+#define RECORD_PUT       'P'
+#define RECORD_CLEAR     'C'
+#define RECORD_DIMENSION 'D'
+#define RECORD_DELETE    'X'
+
+/**
+ * @brief An open journal.
+ */
+struct Journal {
+    char *base;              /**< Path without extension, as given. */
+    char *snapshot_path;     /**< base.vbin */
+    char *temp_path;         /**< base.vbin.tmp, renamed over the snapshot. */
+    char *log_path;          /**< base.log */
+    FILE *log;               /**< The log, open for appending. */
+    long long log_bytes;     /**< Size of the log including unflushed records. */
+    long long snapshot_bytes;/**< Size of the snapshot. */
+    long records;            /**< Records in the log. */
+    int pending;             /**< Records were added since the last commit. */
+    int failed;              /**< A write failed since the last commit. */
+    unsigned char *scratch;  /**< Record being built or read. */
+    size_t scratch_capacity; /**< Bytes allocated for scratch. */
+};
+
+/**
+ * @brief Makes the scratch buffer at least size bytes.
+ * @param j - The journal.
+ * @param size - Bytes needed.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+static int reserve_scratch(Journal *j, size_t size) {
+    if (size <= j->scratch_capacity) {
+        return 1;
+    }
+    unsigned char *temp = realloc(j->scratch, size);
+    if (!temp) {
+        return 0;
+    }
+    j->scratch = temp;
+    j->scratch_capacity = size;
+    return 1;
+}
+
+/**
+ * @brief Appends the record in scratch and its checksum to the log buffer.
+ * @param j - The journal.
+ * @param length - Bytes of the record in scratch.
+ */
+static void append_record(Journal *j, size_t length) {
+    uint32_t check = hash_bytes((const char *)j->scratch, length);
+    if (fwrite(j->scratch, 1, length, j->log) != length ||
+        fwrite(&check, sizeof(check), 1, j->log) != 1) {
+        j->failed = 1;
+    }
+    j->log_bytes += (long long)(length + sizeof(check));
+    j->records++;
+    j->pending = 1;
+}
+
+/**
+ * @brief Records the current value of the vector in one slot.
+ * @param store - The store.
+ * @param slot - Position of the vector.
+ */
+static void put_vector(VectorStore *store, int slot) {
+    Journal *j = store->journal;
+    const vector *v = &store->vectors[slot];
+    const char *name = vector_name(store, v);
+    size_t name_length = strlen(name);
+    size_t row_bytes = (size_t)store->dim * sizeof(float);
+    if (name_length > LOG_NAME_MAX || !reserve_scratch(j, 3 + name_length + row_bytes)) {
+        j->failed = 1;
+        return;
+    }
+    uint16_t length = (uint16_t)name_length;
+    j->scratch[0] = RECORD_PUT;
+    memcpy(j->scratch + 1, &length, sizeof(length));
+    memcpy(j->scratch + 3, name, name_length);
+    memcpy(j->scratch + 3 + name_length, vector_row(store, v), row_bytes);
+    append_record(j, 3 + name_length + row_bytes);
+}
+
+/**
+ * @brief Records that vectors changed.
+ * @param store - The store.
+ * @param slot - Position of the single vector that changed, or -1 to record
+ * every vector.
+ */
+void journal_note(VectorStore *store, int slot) {
+    if (store->journal == NULL) {
+        return;
+    }
+    if (slot >= 0) {
+        put_vector(store, slot);
+        return;
+    }
+    for (int i = 0; i < store->count; i++) {
+        put_vector(store, i);
+    }
+}
+
+/**
+ * @brief Records that the store was cleared.
+ * @param store - The store.
+ */
+void journal_clear(VectorStore *store) {
+    Journal *j = store->journal;
+    if (j == NULL) {
+        return;
+    }
+    j->scratch[0] = RECORD_CLEAR;
+    append_record(j, 1);
+}
+
+/**
+ * @brief Records that a vector was deleted.
+ * @param store - The store.
+ * @param handle - The deleted vector's name.
+ */
+void journal_delete(VectorStore *store, vector_handle handle) {
+    Journal *j = store->journal;
+    if (j == NULL) {
+        return;
+    }
+    const char *name = names_get(&store->names, handle);
+    size_t name_length = strlen(name);
+    if (name_length > LOG_NAME_MAX || !reserve_scratch(j, 3 + name_length)) {
+        j->failed = 1;
+        return;
+    }
+    uint16_t length = (uint16_t)name_length;
+    j->scratch[0] = RECORD_DELETE;
+    memcpy(j->scratch + 1, &length, sizeof(length));
+    memcpy(j->scratch + 3, name, name_length);
+    append_record(j, 3 + name_length);
+}
+
+/**
+ * @brief Records that the dimension was set to store->dim.
+ * @param store - The store.
+ */
+void journal_dimension(VectorStore *store) {
+    Journal *j = store->journal;
+    if (j == NULL) {
+        return;
+    }
+    uint32_t dim = (uint32_t)store->dim;
+    j->scratch[0] = RECORD_DIMENSION;
+    memcpy(j->scratch + 1, &dim, sizeof(dim));
+    append_record(j, 1 + sizeof(dim));
+}
+
+/* ==================== Files ==================== */
+
+/**
+ * @brief Forces a file's contents to disk.
+ * @param path - The file.
+ * @return 1 if successful, 0 otherwise.
+ */
+static int sync_path(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    int ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+/**
+ * @brief Forces the directory entry of a renamed file to disk.
+ * @param path - The file whose directory to sync.
+ */
+static void sync_parent(const char *path) {
+    char *dir = malloc(strlen(path) + 2);
+    if (!dir) {
+        return;
+    }
+    strcpy(dir, path);
+    char *slash = strrchr(dir, '/');
+    if (slash == NULL) {
+        strcpy(dir, ".");
+    } else if (slash == dir) {
+        slash[1] = '\0';
+    } else {
+        *slash = '\0';
+    }
+    sync_path(dir);
+    free(dir);
+}
+
+/**
+ * @brief Returns the size of a file.
+ * @param path - The file.
+ * @return Its size in bytes, or -1 if it does not exist.
+ */
+static long long file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_size : -1;
+}
+
+/**
+ * @brief Opens the log for appending.
+ * @param j - The journal.
+ * @param fresh - Nonzero to empty the log and write a new header.
+ * @return 1 if successful, 0 otherwise.
+ */
+static int open_log(Journal *j, int fresh) {
+    j->log = fopen(j->log_path, fresh ? "wb" : "ab");
+    if (!j->log) {
+        fprintf(stderr, "Error: could not open file '%s'\n", j->log_path);
+        return 0;
+    }
+    setvbuf(j->log, NULL, _IOFBF, LOG_BUFFER_SIZE);
+    if (fresh) {
+        uint32_t header[2] = {LOG_VERSION, LOG_ENDIAN_TAG};
+        if (fwrite(LOG_MAGIC, 1, 4, j->log) != 4 ||
+            fwrite(header, sizeof(header), 1, j->log) != 1 ||
+            fflush(j->log) != 0 || fsync(fileno(j->log)) != 0) {
+            fprintf(stderr, "Error: could not write file '%s'\n", j->log_path);
+            return 0;
+        }
+        j->log_bytes = LOG_HEADER_SIZE;
+        j->records = 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Joins a path and an extension into a new string.
+ * @param base - The path.
+ * @param extension - The extension with its dot.
+ * @return The joined path, or NULL if allocation failed.
+ */
+static char *join_path(const char *base, const char *extension) {
+    char *path = malloc(strlen(base) + strlen(extension) + 1);
+    if (path) {
+        strcpy(path, base);
+        strcat(path, extension);
+    }
+    return path;
+}
+
+/**
+ * @brief Frees a journal that is not attached to a store.
+ * @param j - The journal (NULL is allowed).
+ */
+static void free_journal(Journal *j) {
+    if (!j) {
+        return;
+    }
+    if (j->log) {
+        fclose(j->log);
+    }
+    free(j->base);
+    free(j->snapshot_path);
+    free(j->temp_path);
+    free(j->log_path);
+    free(j->scratch);
+    free(j);
+}
+
+/* ==================== Replay ==================== */
+
+/**
+ * @brief Reads exactly length bytes of a record.
+ * @param file - The log.
+ * @param j - The journal whose scratch receives the bytes.
+ * @param offset - Where in scratch to put them.
+ * @param length - Number of bytes.
+ * @return 1 if all were read, 0 at the end of the file.
+ */
+static int read_part(FILE *file, Journal *j, size_t offset, size_t length) {
+    return reserve_scratch(j, offset + length) &&
+           fread(j->scratch + offset, 1, length, file) == length;
+}
+
+/**
+ * @brief Applies every intact record of the log to the store.
+ *
+ * Stops at the first record that is cut short or fails its checksum, and
+ * truncates the log there so appending continues from a clean end.
+ *
+ * @param store - The store (not journaling while this runs).
+ * @param j - The journal being opened.
+ * @return The number of records applied, or -1 if the log is not a
+ * journal or a record could not be applied.
+ */
+static long replay(VectorStore *store, Journal *j) {
+    FILE *file = fopen(j->log_path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: could not open file '%s'\n", j->log_path);
+        return -1;
+    }
+    char magic[4];
+    uint32_t header[2];
+    if (fread(magic, 1, 4, file) != 4 || fread(header, sizeof(header), 1, file) != 1) {
+        // A crash while creating the log leaves a short header
+        fclose(file);
+        j->log_bytes = 0;
+        return 0;
+    }
+    if (memcmp(magic, LOG_MAGIC, 4) != 0 || header[0] != LOG_VERSION ||
+        header[1] != LOG_ENDIAN_TAG) {
+        fprintf(stderr, "Error: '%s' is not a journal log.\n", j->log_path);
+        fclose(file);
+        return -1;
+    }
+
+    long applied = 0;
+    long long good_end = LOG_HEADER_SIZE;
+    float *row = NULL;
+    int ok = 1;
+    for (;;) {
+        size_t length = 1;
+        if (!read_part(file, j, 0, 1)) {
+            break;
+        }
+        int type = j->scratch[0];
+        if (type == RECORD_PUT || type == RECORD_DELETE) {
+            uint16_t name_length;
+            if (!read_part(file, j, 1, sizeof(name_length))) {
+                break;
+            }
+            memcpy(&name_length, j->scratch + 1, sizeof(name_length));
+            length = 3 + name_length;
+            if (type == RECORD_PUT) {
+                length += (size_t)store->dim * sizeof(float);
+            }
+        } else if (type == RECORD_DIMENSION) {
+            length = 1 + sizeof(uint32_t);
+        } else if (type != RECORD_CLEAR) {
+            break;
+        }
+        uint32_t check;
+        size_t have = type == RECORD_PUT || type == RECORD_DELETE ? 3 : 1;
+        if (!read_part(file, j, have, length - have) ||
+            fread(&check, sizeof(check), 1, file) != 1 ||
+            check != hash_bytes((const char *)j->scratch, length)) {
+            break;
+        }
+
+        if (type == RECORD_PUT) {
+            uint16_t name_length;
+            memcpy(&name_length, j->scratch + 1, sizeof(name_length));
+            float *temp = realloc(row, (size_t)store->dim * sizeof(float));
+            if (!temp) {
+                ok = 0;
+                break;
+            }
+            row = temp;
+            name_id id = store_name(store, (const char *)j->scratch + 3, name_length);
+            if (id == NO_NAME) {
+                ok = 0;
+                break;
+            }
+            memcpy(row, j->scratch + 3 + name_length, (size_t)store->dim * sizeof(float));
+            ok = add_row(store, id, row);
+        } else if (type == RECORD_DELETE) {
+            uint16_t name_length;
+            memcpy(&name_length, j->scratch + 1, sizeof(name_length));
+            vector_handle handle = names_lookup(&store->names, (const char *)j->scratch + 3,
+                                                name_length);
+            // After a crash inside journal_compact the target may already be gone
+            if (handle_vector(store, handle) != NULL) {
+                ok = delete_vector(store, handle);
+            }
+        } else if (type == RECORD_CLEAR) {
+            clear_vectors(store);
+        } else {
+            uint32_t dim;
+            memcpy(&dim, j->scratch + 1, sizeof(dim));
+            ok = set_dimension(store, (int)dim);
+        }
+        if (!ok) {
+            break;
+        }
+        applied++;
+        good_end += (long long)(length + sizeof(check));
+    }
+    free(row);
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "Error: could not replay record %ld of '%s'\n", applied + 1, j->log_path);
+        return -1;
+    }
+
+    long long size = file_size(j->log_path);
+    if (size > good_end) {
+        fprintf(stderr, "Warning: dropped %lld bytes of torn records from '%s'\n",
+                size - good_end, j->log_path);
+        if (truncate(j->log_path, (off_t)good_end) != 0) {
+            fprintf(stderr, "Error: could not truncate '%s'\n", j->log_path);
+            return -1;
+        }
+    }
+    j->log_bytes = good_end;
+    j->records = applied;
+    return applied;
+}
+
+/* ==================== Lifecycle ==================== */
+
+/**
+ * @brief Starts journaling the store to base.vbin and base.log.
+ * @param store - The store to journal.
+ * @param base - The journal's path without extension.
+ * @param replayed - Receives the number of log records replayed.
+ * @return 1 if successful, 0 if a file could not be read or written.
+ */
+int journal_open(VectorStore *store, const char *base, long *replayed) {
+    journal_close(store);
+    *replayed = 0;
+
+    Journal *j = calloc(1, sizeof(Journal));
+    if (!j || !(j->base = join_path(base, "")) || !(j->snapshot_path = join_path(base, ".vbin")) ||
+        !(j->temp_path = join_path(base, ".vbin.tmp")) || !(j->log_path = join_path(base, ".log")) ||
+        !reserve_scratch(j, 1 + sizeof(uint32_t))) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        free_journal(j);
+        return 0;
+    }
+
+    int have_snapshot = file_size(j->snapshot_path) >= 0;
+    int have_log = file_size(j->log_path) >= 0;
+    if (!have_snapshot && !have_log) {
+        // Start from what is in memory now
+        store->journal = j;
+        if (!journal_compact(store)) {
+            journal_close(store);
+            return 0;
+        }
+        return 1;
+    }
+
+    int quiet = store->quiet;
+    store->quiet = 1;
+    int ok = have_snapshot ? load_vectors_vbin(store, j->snapshot_path) : set_dimension(store, 3);
+    long applied = 0;
+    if (ok && have_log) {
+        applied = replay(store, j);
+        ok = applied >= 0;
+    }
+    store->quiet = quiet;
+
+    // A log without even a header is started over
+    if (!ok || !open_log(j, j->log_bytes < LOG_HEADER_SIZE)) {
+        free_journal(j);
+        return 0;
+    }
+    j->snapshot_bytes = have_snapshot ? file_size(j->snapshot_path) : 0;
+    store->journal = j;
+    *replayed = applied;
+    return 1;
+}
+
+/**
+ * @brief Flushes and syncs the log and stops journaling.
+ * @param store - The store.
+ */
+void journal_close(VectorStore *store) {
+    Journal *j = store->journal;
+    if (j == NULL) {
+        return;
+    }
+    if (j->log && (fflush(j->log) != 0 || fsync(fileno(j->log)) != 0)) {
+        fprintf(stderr, "Error: could not write file '%s'\n", j->log_path);
+    }
+    store->journal = NULL;
+    free_journal(j);
+}
+
+/**
+ * @brief Writes the records of the last command to the log.
+ * @param store - The store.
+ * @return 1 if successful (or there is no journal), 0 on a write error.
+ */
+int journal_commit(VectorStore *store) {
+    Journal *j = store->journal;
+    if (j == NULL || !j->pending) {
+        return 1;
+    }
+    j->pending = 0;
+    int ok = fflush(j->log) == 0 && !j->failed;
+    j->failed = 0;
+    if (!ok) {
+        fprintf(stderr, "Error: could not write file '%s'\n", j->log_path);
+        return 0;
+    }
+    if (j->log_bytes > JOURNAL_COMPACT_MIN && j->log_bytes > j->snapshot_bytes) {
+        return journal_compact(store);
+    }
+    return 1;
+}
+
+/**
+ * @brief Writes a new snapshot and empties the log.
+ *
+ * The snapshot goes to a temporary file that is synced and then renamed
+ * over the old one, so a crash at any point leaves either the old
+ * snapshot with the full log or the new one. Replaying the full log over
+ * the new snapshot ends in the same state: puts, clears and dimension
+ * changes set absolute values, and replay skips a delete whose vector
+ * the snapshot no longer has.
+ *
+ * @param store - The store.
+ * @return 1 if successful, 0 if there is no journal or a write failed.
+ */
+int journal_compact(VectorStore *store) {
+    Journal *j = store->journal;
+    if (j == NULL) {
+        return 0;
+    }
+    refresh_vectors(store);
+    if (j->log) {
+        fflush(j->log);
+    }
+    if (!save_vectors_vbin(store, j->temp_path)) {
+        return 0;
+    }
+    if (!sync_path(j->temp_path) || rename(j->temp_path, j->snapshot_path) != 0) {
+        fprintf(stderr, "Error: could not replace '%s'\n", j->snapshot_path);
+        remove(j->temp_path);
+        return 0;
+    }
+    sync_parent(j->snapshot_path);
+    j->snapshot_bytes = file_size(j->snapshot_path);
+
+    if (j->log) {
+        fclose(j->log);
+        j->log = NULL;
+    }
+    j->pending = 0;
+    j->failed = 0;
+    return open_log(j, 1);
+}
+
+/**
+ * @brief Prints the journal's files and sizes, or that there is none.
+ * @param store - The store.
+ */
+void journal_print(const VectorStore *store) {
+    const Journal *j = store->journal;
+    if (j == NULL) {
+        out_printf("No journal is open.\n");
+        return;
+    }
+    out_printf("Journal %s: snapshot %lld bytes, log %ld records (%lld bytes)\n",
+               j->base, j->snapshot_bytes, j->records, j->log_bytes);
+}
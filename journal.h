@@ -0,0 +1,119 @@
+/**
+ * @file      : journal.h
+ * @brief     : Declares the append-only change journal that pairs a binary
+ *              snapshot with a log of every change made since it.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "vector.h"
+
+/*
+ * A journal named base is two files: base.vbin, a snapshot in the usual
+ * binary format, and base.log, every change made since that snapshot.
+ * The log starts with a header ("VLOG", version, endian tag) followed by
+ * records:
+ *
+ *   'P' u16 name length, name, dim floats   a vector was added or replaced
+ *   'X' u16 name length, name               a vector was deleted
+ *   'C'                                     the store was cleared
+ *   'D' u32 dim                             the dimension was set (clears)
+ *
+ * each followed by a u32 FNV-1a checksum of the record. A crash can only
+ * leave a torn record at the end of the log; replay stops at the first
+ * record whose checksum fails and cuts it off.
+ *
+ * Changes are recorded as they happen (through note_vector_change) and
+ * reach the log file once per command, so a checkpoint costs as much as
+ * what changed. Compaction writes a fresh snapshot (to a temporary file,
+ * synced and then renamed over the old one) and empties the log; it runs
+ * on 'compact' and automatically once the log outgrows the snapshot.
+ */
+
+#define JOURNAL_COMPACT_MIN (16 << 20) /**< Log bytes before automatic compaction. */
+
+/**
+ * @brief An open journal; owned by the store it records.
+ */
+typedef struct Journal Journal;
+
+/**
+ * @brief Starts journaling the store to base.vbin and base.log.
+ *
+ * If either file exists the store is replaced by the snapshot (or emptied
+ * if there is none) with the log replayed on top. Otherwise the current
+ * contents are written as the first snapshot.
+ *
+ * @param store The store to journal (an open journal is closed first).
+ * @param base The journal's path without extension.
+ * @param replayed Receives the number of log records replayed.
+ * @return 1 if successful, 0 if a file could not be read or written.
+ */
+int journal_open(VectorStore *store, const char *base, long *replayed);
+
+/**
+ * @brief Flushes and syncs the log and stops journaling.
+ * @param store The store (nothing happens if it has no journal).
+ */
+void journal_close(VectorStore *store);
+
+/**
+ * @brief Records that vectors changed.
+ * @param store The store.
+ * @param slot Position of the single vector that changed, or -1 to record
+ * every vector (after a bulk update).
+ */
+void journal_note(VectorStore *store, int slot);
+
+/**
+ * @brief Records that the store was cleared.
+ * @param store The store.
+ */
+void journal_clear(VectorStore *store);
+
+/**
+ * @brief Records that a vector was deleted.
+ * @param store The store.
+ * @param handle The deleted vector's name (still interned).
+ */
+void journal_delete(VectorStore *store, vector_handle handle);
+
+/**
+ * @brief Records that the dimension was set to store->dim.
+ * @param store The store.
+ */
+void journal_dimension(VectorStore *store);
+
+/**
+ * @brief Writes the records of the command that just ran to the log,
+ * compacting if the log has outgrown the snapshot.
+ *
+ * Only reads the journal when the command recorded nothing, so read-only
+ * commands may call it concurrently.
+ *
+ * @param store The store.
+ * @return 1 if successful (or there is no journal), 0 on a write error.
+ */
+int journal_commit(VectorStore *store);
+
+/**
+ * @brief Writes a new snapshot and empties the log.
+ * @param store The store.
+ * @return 1 if successful, 0 if there is no journal or a write failed.
+ */
+int journal_compact(VectorStore *store);
+
+/**
+ * @brief Prints the journal's files and sizes, or that there is none.
+ * @param store The store.
+ */
+void journal_print(const VectorStore *store);
+
+#endif /* JOURNAL_H */
@@ -0,0 +1,429 @@
+/**
+ * @file      : kdtree.c
+ * @brief     : Defines the k-d tree used for nearest-neighbour queries
+ *              over the vector store.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "kdtree.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define KD_PENDING_MIN 64   /**< Pending slots always tolerated before a rebuild. */
+
+/**
+ * @brief An implicit, balanced k-d tree.
+ *
+ * order[lo..hi) is one subtree; its root is order[mid] with mid the
+ * middle position, the left subtree is [lo, mid) and the right subtree
+ * (mid, hi). Split planes are copied out at build time, so replacing a
+ * vector never breaks the tree's structure - the stale point is merely
+ * hidden and answered from the pending list instead.
+ */
+struct KdTree {
+    int *order;            /**< Slots in tree order. */
+    float *split;          /**< Split value at each tree position. */
+    unsigned char *axis;   /**< Split axis (0 = x, 1 = y, 2 = z) per position. */
+    int built;             /**< Slots [0, built) are in the tree. */
+    int valid;             /**< Nonzero once the tree has been built. */
+    unsigned char *queued; /**< Per slot: nonzero if in pending (and hidden). */
+    int queued_capacity;   /**< Number of entries in queued. */
+    int *pending;          /**< Slots changed since the build. */
+    int pending_count;
+    int pending_capacity;
+};
+
+/**
+ * @brief A max-heap of the best candidates found so far.
+ */
+typedef struct {
+    int *slots;
+    float *dist;
+    int count;
+    int k;
+} Heap;
+
+/**
+ * @brief Reads one coordinate of a vector.
+ * @param v - The vector.
+ * @param axis - 0, 1 or 2 for x, y or z.
+ * @return The coordinate.
+ */
+static float coord(const vector *v, int axis) {
+    return axis == 0 ? v->x : axis == 1 ? v->y : v->z;
+}
+
+/**
+ * @brief Orders candidates by distance, then by slot.
+ * @param da - Distance of the first candidate.
+ * @param sa - Slot of the first candidate.
+ * @param db - Distance of the second candidate.
+ * @param sb - Slot of the second candidate.
+ * @return Nonzero if (da, sa) ranks after (db, sb).
+ */
+static int worse(float da, int sa, float db, int sb) {
+    return da > db || (da == db && sa > sb);
+}
+
+/**
+ * @brief Places a candidate at position i and sifts it down.
+ * @param heap - The heap.
+ * @param i - The vacated position to fill.
+ * @param slot - The candidate slot.
+ * @param dist - Its squared distance.
+ */
+static void sift_down(Heap *heap, int i, int slot, float dist) {
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count &&
+            worse(heap->dist[child + 1], heap->slots[child + 1],
+                  heap->dist[child], heap->slots[child])) {
+            child++;
+        }
+        if (!worse(heap->dist[child], heap->slots[child], dist, slot)) {
+            break;
+        }
+        heap->dist[i] = heap->dist[child];
+        heap->slots[i] = heap->slots[child];
+        i = child;
+    }
+    heap->dist[i] = dist;
+    heap->slots[i] = slot;
+}
+
+/**
+ * @brief Offers a candidate to the heap, keeping the k best.
+ * @param heap - The heap.
+ * @param slot - The candidate slot.
+ * @param dist - Its squared distance.
+ */
+static void heap_offer(Heap *heap, int slot, float dist) {
+    if (heap->count < heap->k) {
+        // Sift up from the new leaf
+        int i = heap->count++;
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!worse(dist, slot, heap->dist[parent], heap->slots[parent])) {
+                break;
+            }
+            heap->dist[i] = heap->dist[parent];
+            heap->slots[i] = heap->slots[parent];
+            i = parent;
+        }
+        heap->dist[i] = dist;
+        heap->slots[i] = slot;
+    } else if (worse(heap->dist[0], heap->slots[0], dist, slot)) {
+        // Replace the current worst candidate
+        sift_down(heap, 0, slot, dist);
+    }
+}
+
+/**
+ * @brief Computes the squared distance between two points.
+ * @param p - A stored point.
+ * @param q - The query point.
+ * @return The squared Euclidean distance.
+ */
+static float distance_sq(const vector *p, const vector *q) {
+    float dx = p->x - q->x;
+    float dy = p->y - q->y;
+    float dz = p->z - q->z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+/**
+ * @brief Partially sorts order[lo..hi) so order[nth] holds the median
+ * along axis, with smaller coordinates before it and larger after.
+ * @param order - Slots to partition.
+ * @param points - The store's vectors.
+ * @param lo - First position of the range.
+ * @param hi - One past the last position of the range.
+ * @param nth - Position that must end up holding its sorted element.
+ * @param axis - Coordinate to order by.
+ */
+static void select_nth(int *order, const vector *points, int lo, int hi, int nth, int axis) {
+    while (hi - lo > 1) {
+        float pivot = coord(&points[order[(lo + hi) / 2]], axis);
+        int i = lo;
+        int j = hi - 1;
+        while (i <= j) {
+            while (coord(&points[order[i]], axis) < pivot) {
+                i++;
+            }
+            while (coord(&points[order[j]], axis) > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                int temp = order[i];
+                order[i] = order[j];
+                order[j] = temp;
+                i++;
+                j--;
+            }
+        }
+        if (nth <= j) {
+            hi = j + 1;
+        } else if (nth >= i) {
+            lo = i;
+        } else {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Builds the subtree for order[lo..hi), splitting on the axis with
+ * the widest spread.
+ * @param tree - The tree being built.
+ * @param points - The store's vectors.
+ * @param lo - First position of the subtree.
+ * @param hi - One past its last position.
+ */
+static void build_range(KdTree *tree, const vector *points, int lo, int hi) {
+    while (hi > lo) {
+        float low[3];
+        float high[3];
+        for (int axis = 0; axis < 3; axis++) {
+            low[axis] = high[axis] = coord(&points[tree->order[lo]], axis);
+        }
+        for (int i = lo + 1; i < hi; i++) {
+            const vector *p = &points[tree->order[i]];
+            for (int axis = 0; axis < 3; axis++) {
+                float c = coord(p, axis);
+                low[axis] = c < low[axis] ? c : low[axis];
+                high[axis] = c > high[axis] ? c : high[axis];
+            }
+        }
+        int axis = 0;
+        for (int a = 1; a < 3; a++) {
+            if (high[a] - low[a] > high[axis] - low[axis]) {
+                axis = a;
+            }
+        }
+
+        int mid = lo + (hi - lo) / 2;
+        select_nth(tree->order, points, lo, hi, mid, axis);
+        tree->axis[mid] = (unsigned char)axis;
+        tree->split[mid] = coord(&points[tree->order[mid]], axis);
+
+        // Recurse into the smaller half and loop on the larger one
+        build_range(tree, points, lo, mid);
+        lo = mid + 1;
+    }
+}
+
+/**
+ * @brief Makes sure the queued flags cover slots [0, count).
+ * @param tree - The tree.
+ * @param count - Number of slots to cover.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+static int reserve_queued(KdTree *tree, int count) {
+    if (count <= tree->queued_capacity) {
+        return 1;
+    }
+    int capacity = tree->queued_capacity > 0 ? tree->queued_capacity : 64;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    unsigned char *temp = realloc(tree->queued, (size_t)capacity);
+    if (!temp) {
+        return 0;
+    }
+    memset(temp + tree->queued_capacity, 0, (size_t)(capacity - tree->queued_capacity));
+    tree->queued = temp;
+    tree->queued_capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Rebuilds the tree over slots [0, count) and empties pending.
+ * @param tree - The tree.
+ * @param points - The store's vectors.
+ * @param count - Number of vectors.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+static int rebuild(KdTree *tree, const vector *points, int count) {
+    size_t n = count > 0 ? (size_t)count : 1;
+    int *order = realloc(tree->order, n * sizeof(int));
+    if (order) {
+        tree->order = order;
+    }
+    float *split = realloc(tree->split, n * sizeof(float));
+    if (split) {
+        tree->split = split;
+    }
+    unsigned char *axis = realloc(tree->axis, n);
+    if (axis) {
+        tree->axis = axis;
+    }
+    if (!order || !split || !axis || !reserve_queued(tree, count)) {
+        kd_invalidate(tree);
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        tree->order[i] = i;
+    }
+    build_range(tree, points, 0, count);
+    memset(tree->queued, 0, (size_t)tree->queued_capacity);
+    tree->pending_count = 0;
+    tree->built = count;
+    tree->valid = 1;
+    return 1;
+}
+
+/**
+ * @brief Searches the subtree order[lo..hi) for candidates closer than
+ * the heap's current worst.
+ * @param tree - The tree.
+ * @param points - The store's vectors.
+ * @param q - The query point.
+ * @param heap - The best candidates so far.
+ * @param lo - First position of the subtree.
+ * @param hi - One past its last position.
+ */
+static void search_range(const KdTree *tree, const vector *points, const vector *q,
+                         Heap *heap, int lo, int hi) {
+    while (hi > lo) {
+        int mid = lo + (hi - lo) / 2;
+        int slot = tree->order[mid];
+        if (!tree->queued[slot]) {
+            heap_offer(heap, slot, distance_sq(&points[slot], q));
+        }
+
+        float diff = coord(q, tree->axis[mid]) - tree->split[mid];
+        int near_lo = diff < 0 ? lo : mid + 1;
+        int near_hi = diff < 0 ? mid : hi;
+        int far_lo = diff < 0 ? mid + 1 : lo;
+        int far_hi = diff < 0 ? hi : mid;
+
+        search_range(tree, points, q, heap, near_lo, near_hi);
+        // The far side can only help if the split plane is within reach
+        if (heap->count == heap->k && diff * diff > heap->dist[0]) {
+            return;
+        }
+        lo = far_lo;
+        hi = far_hi;
+    }
+}
+
+/**
+ * @brief Creates an empty tree that will be built by the first query.
+ * @return The tree, or NULL if allocation failed.
+ */
+KdTree *kd_create(void) {
+    return calloc(1, sizeof(KdTree));
+}
+
+/**
+ * @brief Frees a tree.
+ * @param tree - The tree to free (NULL is allowed).
+ */
+void kd_free(KdTree *tree) {
+    if (!tree) {
+        return;
+    }
+    free(tree->order);
+    free(tree->split);
+    free(tree->axis);
+    free(tree->queued);
+    free(tree->pending);
+    free(tree);
+}
+
+/**
+ * @brief Discards the tree so the next query rebuilds it from scratch.
+ * @param tree - The tree (NULL is allowed).
+ */
+void kd_invalidate(KdTree *tree) {
+    if (tree) {
+        tree->valid = 0;
+    }
+}
+
+/**
+ * @brief Records that one slot was appended, replaced or vacated.
+ * @param tree - The tree (NULL is allowed).
+ * @param slot - The slot that changed.
+ */
+void kd_touch(KdTree *tree, int slot) {
+    if (!tree || !tree->valid) {
+        return;
+    }
+    if (!reserve_queued(tree, slot + 1)) {
+        tree->valid = 0;
+        return;
+    }
+    if (tree->queued[slot]) {
+        return;
+    }
+    if (tree->pending_count == tree->pending_capacity) {
+        int capacity = tree->pending_capacity > 0 ? tree->pending_capacity * 2 : KD_PENDING_MIN;
+        int *temp = realloc(tree->pending, (size_t)capacity * sizeof(int));
+        if (!temp) {
+            tree->valid = 0;
+            return;
+        }
+        tree->pending = temp;
+        tree->pending_capacity = capacity;
+    }
+    tree->queued[slot] = 1;
+    tree->pending[tree->pending_count++] = slot;
+}
+
+/**
+ * @brief Finds the k points closest to q, building the tree if needed.
+ * @param tree - The tree.
+ * @param points - The store's vectors.
+ * @param count - Number of vectors in points.
+ * @param q - The query point.
+ * @param k - Number of neighbours wanted.
+ * @param slots - Receives up to k slots.
+ * @param dist_sq - Receives the squared distance of each result.
+ * @return The number of results, or -1 if the tree could not be allocated.
+ */
+int kd_nearest(KdTree *tree, const vector *points, int count, vector q, int k,
+               int *slots, float *dist_sq) {
+    if (k > count) {
+        k = count;
+    }
+    if (k <= 0) {
+        return 0;
+    }
+    // Scanning the pending list is linear, so fold it in once it is large
+    if (!tree->valid || tree->pending_count > KD_PENDING_MIN + tree->built / 16) {
+        if (!rebuild(tree, points, count)) {
+            return -1;
+        }
+    }
+
+    Heap heap = {slots, dist_sq, 0, k};
+    search_range(tree, points, &q, &heap, 0, tree->built);
+    for (int i = 0; i < tree->pending_count; i++) {
+        int slot = tree->pending[i];
+        // Slots past the end were vacated by deletes
+        if (slot < count) {
+            heap_offer(&heap, slot, distance_sq(&points[slot], &q));
+        }
+    }
+
+    // Move the worst remaining candidate to the back until sorted
+    for (int n = heap.count; n > 1; n--) {
+        int slot = heap.slots[0];
+        float dist = heap.dist[0];
+        heap.count = n - 1;
+        sift_down(&heap, 0, heap.slots[n - 1], heap.dist[n - 1]);
+        heap.slots[n - 1] = slot;
+        heap.dist[n - 1] = dist;
+    }
+    return k;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file      : kdtree.h
+ * @brief     : Declares the k-d tree used for nearest-neighbour queries
+ *              over the vector store.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include "vector.h"
+
+/**
+ * @brief A k-d tree over store slots, kept up to date incrementally.
+ *
+ * The tree is built lazily by the first query. Slots appended or replaced
+ * afterwards are hidden in the tree and kept in a small pending list that
+ * queries scan directly; once that list grows past a fraction of the tree
+ * the next query rebuilds it.
+ */
+typedef struct KdTree KdTree;
+
+/**
+ * @brief Creates an empty tree that will be built by the first query.
+ * @return The tree, or NULL if allocation failed.
+ */
+KdTree *kd_create(void);
+
+/**
+ * @brief Frees a tree.
+ * @param tree The tree to free (NULL is allowed).
+ */
+void kd_free(KdTree *tree);
+
+/**
+ * @brief Discards the tree so the next query rebuilds it from scratch.
+ * Used when slots move or many vectors change at once.
+ * @param tree The tree (NULL is allowed).
+ */
+void kd_invalidate(KdTree *tree);
+
+/**
+ * @brief Records that one slot was appended, replaced or vacated.
+ *
+ * The slot's old point is hidden from the tree and the slot is answered
+ * from the pending list instead, which skips slots at or past the count
+ * passed to kd_nearest. A delete that moves the last vector into the gap
+ * therefore costs two touches, not a rebuild.
+ *
+ * @param tree The tree (NULL is allowed).
+ * @param slot The slot that changed.
+ */
+void kd_touch(KdTree *tree, int slot);
+
+/**
+ * @brief Finds the k points closest to q, building the tree if needed.
+ *
+ * Results are ordered by increasing distance, ties by slot, so the answer
+ * does not depend on how the tree happened to be built.
+ *
+ * @param tree The tree.
+ * @param points The store's vectors.
+ * @param count Number of vectors in points.
+ * @param q The query point.
+ * @param k Number of neighbours wanted.
+ * @param slots Receives up to k slots.
+ * @param dist_sq Receives the squared distance of each result.
+ * @return The number of results (min(k, count)), or -1 if the tree could
+ *         not be allocated.
+ */
+int kd_nearest(KdTree *tree, const vector *points, int count, vector q, int k,
+               int *slots, float *dist_sq);
+
+#endif /* KDTREE_H */
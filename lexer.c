@@ -0,0 +1,293 @@
+/**
+ * @file      : lexer.c
+ * @brief     : Defines the single-pass tokenizer that splits each command
+ *              line in place into a token array.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "lexer.h"
+#include "util.h"
+#include <ctype.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Checks whether a character can continue a word.
+ * @param c - The character.
+ * @return Nonzero for letters, digits and '_'.
+ */
+static int is_word_char(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+/**
+ * @brief Checks whether a number starts at p.
+ * @param p - The candidate's first character (the line is terminated).
+ * @return Nonzero for a digit, or '.' followed by a digit.
+ */
+static int starts_number(const char *p) {
+    return isdigit((unsigned char)p[0]) || (p[0] == '.' && isdigit((unsigned char)p[1]));
+}
+
+/**
+ * @brief Decides whether a '+' or '-' at p is the sign of a number.
+ * @param list - The tokens so far.
+ * @param p - The sign.
+ * @param joined - Nonzero if no whitespace precedes the sign.
+ * @return Nonzero if the sign belongs to the number that follows it.
+ */
+static int is_sign(const TokenList *list, const char *p, int joined) {
+    if ((p[0] != '-' && p[0] != '+') || !starts_number(p + 1)) {
+        return 0;
+    }
+    if (list->count == 0) {
+        return 1;
+    }
+    int before = list->tokens[list->count - 1].kind;
+    return !(before == TOKEN_WORD || before == TOKEN_NUMBER || before == ')') || !joined;
+}
+
+/**
+ * @brief Returns the kind of a two-character symbol at p.
+ * @param p - The symbol's first character.
+ * @return TOKEN_BIND, TOKEN_EQ, TOKEN_NE, TOKEN_LE or TOKEN_GE, or 0.
+ */
+static int pair_kind(const char *p) {
+    if (p[1] != '=') {
+        return 0;
+    }
+    switch (p[0]) {
+    case ':':
+        return TOKEN_BIND;
+    case '=':
+        return TOKEN_EQ;
+    case '!':
+        return TOKEN_NE;
+    case '<':
+        return TOKEN_LE;
+    case '>':
+        return TOKEN_GE;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Prepares an empty list.
+ * @param list - The list.
+ */
+void lex_init(TokenList *list) {
+    list->tokens = list->local;
+    list->count = 0;
+    list->capacity = LEX_LOCAL;
+    list->end = NULL;
+}
+
+/**
+ * @brief Tokenizes a line in place.
+ *
+ * Every character is looked at once: whitespace is skipped, and the
+ * first character of a token decides how far it reaches.
+ *
+ * @param list - Receives the tokens (initialized with lex_init).
+ * @param line - The line, without its newline.
+ * @return 1 if successful, 0 if the token array could not grow.
+ */
+int lex_line(TokenList *list, char *line) {
+    char *end = line + strlen(line);
+    char *p = line;
+    list->count = 0;
+    list->end = line;
+
+    for (;;) {
+        int joined = 1;
+        while (isspace((unsigned char)*p)) {
+            p++;
+            joined = 0;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        if (list->count == list->capacity) {
+            int capacity = list->capacity * 2;
+            Token *temp;
+            if (list->tokens == list->local) {
+                temp = malloc((size_t)capacity * sizeof(Token));
+                if (temp) {
+                    memcpy(temp, list->local, sizeof(list->local));
+                }
+            } else {
+                temp = realloc(list->tokens, (size_t)capacity * sizeof(Token));
+            }
+            if (!temp) {
+                return 0;
+            }
+            list->tokens = temp;
+            list->capacity = capacity;
+        }
+
+        Token *t = &list->tokens[list->count];
+        const char *stop;
+        t->text = p;
+        t->joined = joined && list->count > 0;
+        t->value = 0;
+        if (isalpha((unsigned char)*p) || *p == '_') {
+            t->kind = TOKEN_WORD;
+            do {
+                p++;
+            } while (is_word_char(*p));
+        } else if ((starts_number(p) || is_sign(list, p, t->joined)) &&
+                   (stop = parse_float(p, end, &t->value)) != NULL) {
+            t->kind = TOKEN_NUMBER;
+            p = (char *)stop;
+            // parse_float also skips the blanks after the number
+            while (p > t->text && (p[-1] == ' ' || p[-1] == '\t')) {
+                p--;
+            }
+        } else if ((t->kind = pair_kind(p)) != 0) {
+            p += 2;
+        } else {
+            t->kind = (unsigned char)*p;
+            p++;
+        }
+        t->length = (int)(p - t->text);
+        list->end = p;
+        list->count++;
+    }
+    *list->end = '\0';
+    return 1;
+}
+
+/**
+ * @brief Returns tokens first to last as a string, terminated in place.
+ * @param list - The tokenized line.
+ * @param first - Index of the first token.
+ * @param last - Index of the last token (at least first).
+ * @return The span, inside the line.
+ */
+char *lex_span(TokenList *list, int first, int last) {
+    const Token *t = &list->tokens[last];
+    t->text[t->length] = '\0';
+    return list->tokens[first].text;
+}
+
+/**
+ * @brief Returns the text from token first to the end of the line.
+ * @param list - The tokenized line.
+ * @param first - Index of the first token; count gives "".
+ * @return The rest of the line, inside it.
+ */
+char *lex_rest(const TokenList *list, int first) {
+    return first < list->count ? list->tokens[first].text : list->end;
+}
+
+/**
+ * @brief Finds the end of a run of tokens with no whitespace between them.
+ * @param list - The tokenized line.
+ * @param first - Index of the run's first token.
+ * @return Index of the run's last token.
+ */
+int lex_run_end(const TokenList *list, int first) {
+    int last = first;
+    while (last + 1 < list->count && list->tokens[last + 1].joined) {
+        last++;
+    }
+    return last;
+}
+
+/**
+ * @brief Checks whether a run of tokens spells exactly the given text.
+ * @param list - The tokenized line.
+ * @param first - Index of the run's first token.
+ * @param last - Index of the run's last token.
+ * @param text - The text to compare.
+ * @return 1 if the run's characters are text, 0 otherwise.
+ */
+int lex_run_is(const TokenList *list, int first, int last, const char *text) {
+    const Token *a = &list->tokens[first];
+    const Token *b = &list->tokens[last];
+    size_t length = (size_t)(b->text + b->length - a->text);
+    return strlen(text) == length && memcmp(a->text, text, length) == 0;
+}
+
+/**
+ * @brief Checks whether a token is the given word.
+ * @param list - The tokenized line.
+ * @param i - Index of the token (count or more gives 0).
+ * @param word - The word.
+ * @return 1 if token i is a TOKEN_WORD spelling word, 0 otherwise.
+ */
+int lex_is_word(const TokenList *list, int i, const char *word) {
+    if (i >= list->count || list->tokens[i].kind != TOKEN_WORD) {
+        return 0;
+    }
+    const Token *t = &list->tokens[i];
+    return strncmp(t->text, word, (size_t)t->length) == 0 && word[t->length] == '\0';
+}
+
+/**
+ * @brief Finds the first token of a kind.
+ * @param list - The tokenized line.
+ * @param first - Index to start from.
+ * @param kind - TOKEN_* or a symbol character.
+ * @return Its index, or -1 if there is none.
+ */
+int lex_find(const TokenList *list, int first, int kind) {
+    for (int i = first; i < list->count; i++) {
+        if (list->tokens[i].kind == kind) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Reads a token as a whole number.
+ * @param list - The tokenized line.
+ * @param i - Index of the token.
+ * @param out - Receives the value.
+ * @return 1 if token i is a number of digits (with an optional sign) that
+ *         fits in an int, 0 otherwise.
+ */
+int lex_int(const TokenList *list, int i, int *out) {
+    if (i >= list->count || list->tokens[i].kind != TOKEN_NUMBER) {
+        return 0;
+    }
+    const Token *t = &list->tokens[i];
+    const char *p = t->text;
+    const char *end = p + t->length;
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+    long long value = 0;
+    for (; p < end; p++) {
+        if (!isdigit((unsigned char)*p) || value > INT_MAX) {
+            return 0;
+        }
+        value = value * 10 + (*p - '0');
+    }
+    value = negative ? -value : value;
+    if (value > INT_MAX || value < INT_MIN) {
+        return 0;
+    }
+    *out = (int)value;
+    return 1;
+}
+
+/**
+ * @brief Frees any heap storage and empties the list.
+ * @param list - The list to free.
+ */
+void lex_free(TokenList *list) {
+    if (list->tokens != list->local) {
+        free(list->tokens);
+    }
+    lex_init(list);
+}
@@ -0,0 +1,171 @@
+/**
+ * @file      : lexer.h
+ * @brief     : Declares the single-pass tokenizer that splits each command
+ *              line in place into a token array.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef LEXER_H
+#define LEXER_H
+
+#define LEX_LOCAL 64   /**< Tokens a list holds before it allocates. */
+
+/*
+ * Tokens (whitespace separates them but is never part of one):
+ *
+ *   word    letter or '_', then letters, digits and '_'    (TOKEN_WORD)
+ *   number  digits with an optional '.' and exponent, as   (TOKEN_NUMBER)
+ *           parse_float reads them
+ *   := == != <= >=                                         (TOKEN_BIND ...)
+ *   any other character, alone                             (the character)
+ *
+ * A '+' or '-' directly before a number is part of it when the token
+ * before is not an operand (a word, number or ')'), or when whitespace
+ * precedes the sign but does not follow it. So "a = 1 -2 3" holds three
+ * numbers while "a - 2" and "a-2" subtract.
+ *
+ * Tokens point into the line, so nothing is copied.
+ */
+
+/**
+ * @brief Token kinds; a single-character symbol is its own character.
+ */
+enum {
+    TOKEN_WORD = 256,  /**< A name or keyword. */
+    TOKEN_NUMBER,      /**< A decimal number; value holds it. */
+    TOKEN_BIND,        /**< := */
+    TOKEN_EQ,          /**< == */
+    TOKEN_NE,          /**< != */
+    TOKEN_LE,          /**< <= */
+    TOKEN_GE           /**< >= */
+};
+
+/**
+ * @brief One token: where it is in the line and what it is.
+ */
+typedef struct {
+    char *text;     /**< First character, inside the line. */
+    int length;     /**< Number of characters. */
+    int kind;       /**< TOKEN_* or the symbol's character. */
+    int joined;     /**< Nonzero if no whitespace precedes it. */
+    float value;    /**< The number of a TOKEN_NUMBER. */
+} Token;
+
+/**
+ * @brief A tokenized line.
+ *
+ * The first LEX_LOCAL tokens live in the list itself, so an ordinary line
+ * needs no allocation; longer lines move to the heap. Because tokens may
+ * point at local, a list must not be copied once initialized.
+ */
+typedef struct {
+    Token *tokens;  /**< The tokens, in order (local or heap). */
+    int count;      /**< Tokens in the current line. */
+    int capacity;   /**< Entries available in tokens. */
+    char *end;      /**< The terminator after the last token. */
+    Token local[LEX_LOCAL];  /**< Storage for short lines. */
+} TokenList;
+
+/**
+ * @brief Prepares an empty list.
+ * @param list The list.
+ */
+void lex_init(TokenList *list);
+
+/**
+ * @brief Tokenizes a line in place.
+ *
+ * The only write to the line is a terminator after its last token, which
+ * trims trailing whitespace; leading whitespace is simply skipped. So the
+ * text from any token to the end of the line is a ready string.
+ *
+ * @param list Receives the tokens (initialized with lex_init; it can be
+ *             reused for line after line).
+ * @param line The line, without its newline.
+ * @return 1 if successful, 0 if the token array could not grow.
+ */
+int lex_line(TokenList *list, char *line);
+
+/**
+ * @brief Returns tokens first to last, with whatever lies between them,
+ * as a string.
+ *
+ * A terminator is written just after token last. That character is
+ * either whitespace or a symbol (whose kind stays in its token), so take
+ * spans from left to right and do not need the text of a symbol that
+ * follows one.
+ *
+ * @param list The tokenized line.
+ * @param first Index of the first token.
+ * @param last Index of the last token (at least first).
+ * @return The span, inside the line.
+ */
+char *lex_span(TokenList *list, int first, int last);
+
+/**
+ * @brief Returns the text from token first to the end of the line.
+ * @param list The tokenized line.
+ * @param first Index of the first token; count gives "".
+ * @return The rest of the line, inside it.
+ */
+char *lex_rest(const TokenList *list, int first);
+
+/**
+ * @brief Finds the end of a run of tokens with no whitespace between them,
+ * such as a filename or "--merge".
+ * @param list The tokenized line.
+ * @param first Index of the run's first token.
+ * @return Index of the run's last token.
+ */
+int lex_run_end(const TokenList *list, int first);
+
+/**
+ * @brief Checks whether a run of tokens spells exactly the given text.
+ * @param list The tokenized line.
+ * @param first Index of the run's first token.
+ * @param last Index of the run's last token.
+ * @param text The text to compare.
+ * @return 1 if the run's characters are text, 0 otherwise.
+ */
+int lex_run_is(const TokenList *list, int first, int last, const char *text);
+
+/**
+ * @brief Checks whether a token is the given word.
+ * @param list The tokenized line.
+ * @param i Index of the token (count or more gives 0).
+ * @param word The word.
+ * @return 1 if token i is a TOKEN_WORD spelling word, 0 otherwise.
+ */
+int lex_is_word(const TokenList *list, int i, const char *word);
+
+/**
+ * @brief Finds the first token of a kind.
+ * @param list The tokenized line.
+ * @param first Index to start from.
+ * @param kind TOKEN_* or a symbol character.
+ * @return Its index, or -1 if there is none.
+ */
+int lex_find(const TokenList *list, int first, int kind);
+
+/**
+ * @brief Reads a token as a whole number.
+ * @param list The tokenized line.
+ * @param i Index of the token.
+ * @param out Receives the value.
+ * @return 1 if token i is a number of digits (with an optional sign)
+ *         that fits in an int, 0 otherwise.
+ */
+int lex_int(const TokenList *list, int i, int *out);
+
+/**
+ * @brief Frees any heap storage and empties the list.
+ * @param list The list to free.
+ */
+void lex_free(TokenList *list);
+
+#endif /* LEXER_H */
@@ -9,334 +9,1863 @@
  * Section    : 112
  * 
  * Algorithm:
- * 1. Check for command-line arguments (-h for help).
+ * 1. Check for command-line arguments (-h for help, -f/-b/-q for batch use,
+ *    -j N for the number of worker threads, --stats-json for a dump of
+ *    the statistics on exit, --journal to replay and keep a change log,
+ *    --serve to share the store over a socket, --precision for the
+ *    decimals CSV saves write).
  * 2. Initialize the vector store.
- * 3. Enter a continuous loop prompting the user for input.
- * 4. Use fgets() to read a full input line and trim whitespace.
- * 5. Execute recognized commands:
+ * 3. Enter a continuous loop reading commands (prompting only when
+ *    interactive; batch modes use fully buffered output).
+ * 4. Use fgets() to read a full input line and split it into tokens in
+ *    one pass (lexer.c); the handlers below work on the tokens.
+ * 5. Look up the first word in a perfect-hash table of commands (one
+ *    probe and one compare) and execute it:
  *      - 'quit'  → Exit the program.
  *      - 'clear' → Remove all stored vectors.
+ *      - 'delete <name>' → Remove one vector (the last one fills its slot).
+ *      - 'reserve N', 'shrink', 'mem' → Preallocate room for N vectors,
+ *        give back memory after clears and deletes, or report usage.
  *      - 'list'  → Display all stored vectors.
  *      - 'save <file>'  → Save all stored vectors to a csv file.
  *      - 'load <file>'  → Load all vectors within csv file to be stored.
- * 6. If input contains '=' → process as a vector assignment.
- * 7. If input contains '+', '-', '*', or 'x' → process as an operation.
- * 8. Otherwise, treat input as a vector name and display its contents.
- * 9. Continue until the user types 'quit'.
+ *        (files ending in .vbin use the binary snapshot format instead)
+ *      - 'load --merge <files>' → Merge CSV files without clearing.
+ *      - 'load <file>.vcol where <predicate>' → Load only matching rows,
+ *        skipping chunks by their zone maps (save <file>.vcol writes one).
+ *      - 'normalize <pattern>' → Scale matching vectors to unit length.
+ *      - 'transform <pattern> by <M>' → Apply a matrix or quaternion.
+ *      - 'dim [N]' → Show or set the number of components per vector.
+ *      - 'precision [N]' → Show or set the decimals CSV saves write.
+ *      - 'nearest <name> [k]' → List the k vectors closest to a vector.
+ *      - 'stream <file> <agg>' → Aggregate a CSV file without loading it.
+ *      - 'sum', 'mean', 'minmax', 'maxnorm', 'sumsq' → Reduce the store.
+ *      - 'journal [<name> | off]' → Log every change next to a snapshot.
+ *      - 'compact' → Fold the journal's log into a new snapshot.
+ *      - 'stats [reset]' → Show or clear the timing histograms.
+ * 6. If input has a ':=' token → bind a formula that is recomputed lazily.
+ *    If input has an '=' token → process as a vector assignment; a left side
+ *    of 'all' or a '*'/'?' pattern updates every matching vector, and a
+ *    mat3/mat4/quat right side defines a named transform.
+ * 7. If input is a bare vector name → display its contents.
+ * 8. Otherwise, compile (or reuse the cached bytecode of) the input as an
+ *    expression and print its result.
+ * 9. Continue until the user types 'quit' or input ends; in batch modes
+ *    the exit status is that of the first command that failed. With
+ *    --serve, commands come from socket clients instead, read-only ones
+ *    in parallel.
  */
 
 #include "vector.h"
 #include "util.h"
 #include "io.h"
+#include "expr.h"
+#include "bulk.h"
+#include "pool.h"
+#include "reduce.h"
+#include "formula.h"
+#include "transform.h"
+#include "stats.h"
+#include "server.h"
+#include "journal.h"
+#include "ftoa.h"
+#include "predicate.h"
+#include "wide.h"
+#include "lexer.h"
 #include <stdbool.h> // Needed to use the bool type, and true/false values
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
 
 /* ===========================================================
  *                Local Constant Definitions
  * =========================================================== */
-#define MAX_INPUT_LEN        100
-#define MAX_TOKEN_LEN_LONG   64
-#define MAX_TOKEN_LEN_MED    32
-#define MAX_TOKEN_LEN_SHORT  10
+#define MAX_INPUT_LEN        16384
+#define OUTPUT_BUFFER_SIZE   65536
+#define MAX_THREADS          256
+
+/* Exit statuses; a batch run exits with the status of its first error */
+#define STATUS_OK            0
+#define STATUS_BAD_OPTION    1
+#define STATUS_SYNTAX        2
+#define STATUS_NOT_FOUND     3
+#define STATUS_IO            4
+#define STATUS_QUIT          (-1)
 
 /* ===========================================================
  *               Forward Function Declarations
  * =========================================================== */
-void handle_assignment(VectorStore *store, char *input);
-vector handle_operation(VectorStore *store, char *input);
-void handle_display(VectorStore *store, char *input);
+int handle_assignment(VectorStore *store, TokenList *line, int equals);
+int handle_formula(VectorStore *store, TokenList *line, int bind);
+int handle_broadcast(VectorStore *store, const char *pattern, const char *source);
+int handle_normalize(VectorStore *store, TokenList *line);
+int handle_nearest(VectorStore *store, TokenList *line);
+int handle_stream(VectorStore *store, TokenList *line);
+int handle_reduction(VectorStore *store, const char *name, vector *out);
+int handle_operation(VectorStore *store, TokenList *line, int first, vector *out);
+int handle_display(VectorStore *store, TokenList *line);
+int handle_dimension(VectorStore *store, TokenList *line);
+int handle_precision(VectorStore *store, TokenList *line);
+int handle_transform(VectorStore *store, TokenList *line);
+int handle_transform_define(VectorStore *store, TokenList *line, const char *left, int first);
+int execute_command(VectorStore *store, TokenList *line);
+int run_commands(VectorStore *store, FILE *in, bool interactive);
+int run_command(VectorStore *store, char *input);
+int handle_save(VectorStore *store, TokenList *line);
+int handle_load(VectorStore *store, TokenList *line);
+int handle_journal(VectorStore *store, TokenList *line);
+int handle_compact(VectorStore *store, TokenList *line);
+int handle_stats(VectorStore *store, TokenList *line);
+int handle_merge(VectorStore *store, TokenList *line, int first);
+int handle_load_where(VectorStore *store, char *filename, char *text);
+int handle_delete(VectorStore *store, TokenList *line);
+int handle_reserve(VectorStore *store, TokenList *line);
+int handle_shrink(VectorStore *store, TokenList *line);
+void print_help(void);
 
 /* ===========================================================
  *                   Function Definitions
  * =========================================================== */
 
+/**
+ * @brief Checks that the store holds 3-dimensional vectors.
+ *
+ * Formulas, broadcasts, normalize, nearest and the reductions work on the
+ * x, y, z fields of the vector records, so they are only available when
+ * the store's dimension is 3.
+ *
+ * @param store Pointer to the VectorStore in use.
+ * @param what Name of the feature, printed if it is unavailable.
+ * @return true if the store's dimension is 3.
+ */
+static bool require_3d(const VectorStore *store, const char *what)
+{
+    if (store->dim == 3) {
+        return true;
+    }
+    out_printf("%s needs 3-dimensional vectors (the store has dimension %d).\n",
+           what, store->dim);
+    return false;
+}
+
+/**
+ * @brief Maps an EXPR_* error code to the matching exit status.
+ * @param status The code returned by the expression engine.
+ * @return STATUS_NOT_FOUND, STATUS_IO or STATUS_SYNTAX.
+ */
+static int expr_status(int status)
+{
+    if (status == EXPR_NOT_FOUND) {
+        return STATUS_NOT_FOUND;
+    }
+    return status == EXPR_NO_MEMORY ? STATUS_IO : STATUS_SYNTAX;
+}
+
+/**
+ * @brief Reads three number tokens as a 3D vector literal.
+ * @param line The tokenized line.
+ * @param first Index of the first number.
+ * @param v Receives x, y and z.
+ * @return true if the line holds exactly three numbers from first on.
+ */
+static bool read_literal(const TokenList *line, int first, vector *v)
+{
+    if (line->count - first != 3) {
+        return false;
+    }
+    const Token *t = &line->tokens[first];
+    if (t[0].kind != TOKEN_NUMBER || t[1].kind != TOKEN_NUMBER || t[2].kind != TOKEN_NUMBER) {
+        return false;
+    }
+    v->x = t[0].value;
+    v->y = t[1].value;
+    v->z = t[2].value;
+    return true;
+}
+
+/**
+ * @brief Looks up the transform a word token names.
+ *
+ * The token is terminated only for the lookup, so the line's text (which
+ * may still be compiled as an expression) is left as it was.
+ *
+ * @param store Pointer to the VectorStore holding the transforms.
+ * @param line The tokenized line.
+ * @param i Index of the token.
+ * @return The transform, or NULL if token i is not a transform's name.
+ */
+static const Transform *find_transform_token(const VectorStore *store, const TokenList *line, int i)
+{
+    if (store->transforms == NULL || i >= line->count || line->tokens[i].kind != TOKEN_WORD) {
+        return NULL;
+    }
+    char *end = line->tokens[i].text + line->tokens[i].length;
+    char saved = *end;
+    *end = '\0';
+    const Transform *t = transform_find(store, line->tokens[i].text);
+    *end = saved;
+    return t;
+}
+
+/**
+ * @brief Recognizes "M * rest" when M names a stored transform.
+ * @param store Pointer to the VectorStore holding the transforms.
+ * @param line The tokenized line.
+ * @param first Index of the token that may name M.
+ * @return The transform, or NULL if the tokens do not start with one.
+ */
+static const Transform *split_transform(const VectorStore *store, const TokenList *line, int first)
+{
+    if (first + 1 >= line->count || line->tokens[first + 1].kind != '*') {
+        return NULL;
+    }
+    return find_transform_token(store, line, first);
+}
+
+/**
+ * @brief Applies a transform to a vector name or parenthesized expression.
+ * @param store Pointer to the VectorStore holding the vectors.
+ * @param t The transform.
+ * @param line The tokenized line.
+ * @param first Index of the operand's first token (e.g., "a" or "(").
+ * @param out Receives the transformed vector.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+static int apply_transform(VectorStore *store, const Transform *t, TokenList *line, int first,
+                           vector *out)
+{
+    char *operand = lex_rest(line, first);
+    if (first == line->count - 1 && line->tokens[first].kind == TOKEN_WORD) {
+        vector *v = read_vector(store, operand);
+        if (v == NULL) {
+            out_printf("Vector '%s' not found.\n", operand);
+            return STATUS_NOT_FOUND;
+        }
+        *out = transform_vector(t, *v);
+        return STATUS_OK;
+    }
+    if (first >= line->count || line->tokens[first].kind != '(') {
+        out_printf("Use: d = M * a or d = M * (a + b)\n");
+        return STATUS_SYNTAX;
+    }
+
+    char error[EXPR_ERROR_LEN];
+    ExprValue value;
+    value.row = NULL;
+    int status = expr_run(store, operand, &value, error);
+    if (status != EXPR_OK) {
+        out_printf("%s\n", error);
+        return expr_status(status);
+    }
+    if (value.type != EXPR_VECTOR) {
+        out_printf("A transform applies to a vector, not a scalar.\n");
+        return STATUS_SYNTAX;
+    }
+    *out = transform_vector(t, value.v);
+    return STATUS_OK;
+}
+
  /**
- * @brief Parses an input string to perform a vector operation.
+ * @brief Evaluates an expression and prints or returns its result.
  *
  * Handles vector addition (+), subtraction (-), dot product (*),
- * cross product (x), and scalar multiplication. The result can
- * be printed as 'ans' or assigned to a new vector variable
- * (e.g., "c = a + b").
+ * cross product (x), scalar multiplication and unary minus, in any
+ * combination with parentheses (e.g., "(a + b) x c * 2 - e"). The
+ * expression is compiled once and cached, so repeating it only runs
+ * the bytecode. With no output pointer the result is printed as 'ans';
+ * a dot product prints as a single number. Stores of any other dimension
+ * than 3 print every component of a vector result. "M * a" or
+ * "M * (a + b)" applies the stored transform M.
  *
  * @param store Pointer to the VectorStore containing source vectors.
- * @param input The user-provided string (e.g., "a + b").
- * @return The resulting vector from the operation (add, sub, cross, scalar).
- * @return A null_vector if the operation was a dot product (which
- * prints to console) or if an error occurred.
- */
-vector handle_operation(VectorStore *store, char *input)
-{
-    vector null_vector = {"", 0, 0, 0};
-    vector result;
-    vector *v1; 
-    vector *v2;
-    char left[MAX_TOKEN_LEN_SHORT];
-    char right[MAX_TOKEN_LEN_SHORT];
-    char result_name[MAX_TOKEN_LEN_SHORT];
-    char op;
-    float scalar;
-    int assign = 0;
-
-    if (sscanf(input, "%s = %s %c %s", result_name, left, &op, right) == 4) {
-        assign = 1;
-    } else if (sscanf(input, "%s %c %s", left, &op, right) != 3) {
-        printf("Invalid operation format.\n");
-        return null_vector;
-    }
-
-    if (isdigit(left[0]) || left[0] == '-' || left[0] == '+') {
-        scalar = atof(left);
-        v2 = find_vector(store, right);
-        if (!v2) {
-            printf("Vector '%s' not found.\n", right);
-            return null_vector;
+ * @param line The tokenized line (e.g., "a + b").
+ * @param first Index of the expression's first token.
+ * @param out Receives the result instead of printing it, or NULL to print.
+ * A scalar result is returned in x with y and z set to 0.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_operation(VectorStore *store, TokenList *line, int first, vector *out)
+{
+    char error[EXPR_ERROR_LEN];
+    ExprValue value;
+
+    const Transform *t = split_transform(store, line, first);
+    if (t != NULL) {
+        if (!require_3d(store, "A transform")) {
+            return STATUS_SYNTAX;
         }
-        result.x = v2->x * scalar;
-        result.y = v2->y * scalar;
-        result.z = v2->z * scalar;
-    }
-    else if (isdigit(right[0]) || right[0] == '-' || right[0] == '+') {
-        v1 = find_vector(store, left);
-        if (!v1) {
-            printf("Vector '%s' not found.\n", left);
-            return null_vector;
+        int status = apply_transform(store, t, line, first + 2, &value.v);
+        if (status == STATUS_OK && out) {
+            *out = value.v;
+        } else if (status == STATUS_OK) {
+            out_printf("ans = %.2f  %.2f  %.2f\n", value.v.x, value.v.y, value.v.z);
         }
-        scalar = atof(right);
-        result.x = v1->x * scalar;
-        result.y = v1->y * scalar;
-        result.z = v1->z * scalar;
-    }
-    else if (op == '*') {
-        v1 = find_vector(store, left);
-        v2 = find_vector(store, right);
-        if (!v1 || !v2) {
-            printf("One or both vectors not found.\n");
-            return null_vector;
+        return status;
+    }
+
+    value.row = NULL;
+    if (store->rows != NULL) {
+        value.row = malloc((size_t)store->dim * sizeof(float));
+        if (value.row == NULL) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            return STATUS_IO;
         }
-        float dot = dot_prod(*v1, *v2);
-        printf("ans = %.2f\n", dot);
-        return null_vector;
-    }
-    else if (op == 'x' || op == 'X') {
-        v1 = find_vector(store, left);
-        v2 = find_vector(store, right);
-        if (!v1 || !v2) {
-            printf("One or both vectors not found.\n");
-            return null_vector;
+    }
+
+    int status = expr_run(store, lex_rest(line, first), &value, error);
+    if (status != EXPR_OK) {
+        out_printf("%s\n", error);
+        free(value.row);
+        return expr_status(status);
+    }
+
+    if (value.type == EXPR_SCALAR) {
+        value.v.x = value.s;
+    }
+
+    if (out) {
+        *out = value.v;
+    } else if (value.type == EXPR_SCALAR) {
+        out_printf("ans = %.2f\n", value.s);
+    } else if (value.row != NULL) {
+        print_components("ans", value.row, store->dim);
+    } else {
+        out_printf("ans = %.2f  %.2f  %.2f\n", value.v.x, value.v.y, value.v.z);
+    }
+    free(value.row);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Assigns a vector in a store whose dimension is not 3.
+ *
+ * The right side is either exactly store->dim numbers or an expression.
+ * A scalar result is stored in the first component with the rest zero,
+ * as for 3D vectors.
+ *
+ * @param store Pointer to the VectorStore to add the vector to.
+ * @param left The vector name.
+ * @param line The tokenized line.
+ * @param first Index of the right side's first token.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+static int handle_row_assignment(VectorStore *store, const char *left, TokenList *line, int first)
+{
+    int dim = store->dim;
+    float *row = calloc((size_t)dim, sizeof(float));
+    if (row == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return STATUS_IO;
+    }
+
+    // A right side of nothing but numbers is a literal
+    int given = line->count - first;
+    bool literal = true;
+    for (int i = first; i < line->count && literal; i++) {
+        literal = line->tokens[i].kind == TOKEN_NUMBER;
+    }
+
+    int status = STATUS_OK;
+    if (literal) {
+        if (given != dim) {
+            out_printf("Expected %d components, got %d.\n", dim, given);
+            status = STATUS_SYNTAX;
         }
-        result = cross_prod(*v1, *v2);
-    }
-    else {
-        v1 = find_vector(store, left);
-        v2 = find_vector(store, right);
-        if (!v1 || !v2) {
-            printf("One or both vectors not found.\n");
-            return null_vector;
+        for (int i = 0; i < given && i < dim; i++) {
+            row[i] = line->tokens[first + i].value;
         }
-        if (op == '+'){
-            result = add(*v1, *v2);
-        } else if (op == '-'){
-            result = sub(*v1, *v2);
-        } else {
-            printf("Unsupported operator '%c'\n", op);
-            return null_vector;
+    } else {
+        char error[EXPR_ERROR_LEN];
+        ExprValue value;
+        value.row = row;
+        int result = expr_run(store, lex_rest(line, first), &value, error);
+        if (result != EXPR_OK) {
+            out_printf("%s\n", error);
+            status = expr_status(result);
+        } else if (value.type == EXPR_SCALAR) {
+            memset(row, 0, (size_t)dim * sizeof(float));
+            row[0] = value.s;
         }
     }
 
-    if (assign) {
-        strcpy(result.name, result_name);
-        add_vector(store, result);
-    } else {
-        strcpy(result.name, "ans");
+    if (status == STATUS_OK) {
+        name_id id = store_name(store, left, strlen(left));
+        if (id == NO_NAME || !add_row(store, id, row)) {
+            status = STATUS_IO;
+        } else {
+            print_components(left, row, dim);
+        }
     }
+    free(row);
+    return status;
+}
 
-    printf("%s = %.2f  %.2f  %.2f\n", result.name, result.x, result.y, result.z);
-    return result;
+/**
+ * @brief Checks whether the right side of an assignment defines a transform.
+ * @param store Pointer to the VectorStore holding the transforms.
+ * @param line The tokenized line.
+ * @param first Index of the right side's first token.
+ * @return true for a mat3/mat4/quat literal, a transform's name, or the
+ * product of two transforms.
+ */
+static bool is_transform_definition(const VectorStore *store, const TokenList *line, int first)
+{
+    if (is_transform_literal(lex_rest(line, first))) {
+        return true;
+    }
+    if (first == line->count - 1) {
+        return find_transform_token(store, line, first) != NULL;
+    }
+    return first + 3 == line->count && split_transform(store, line, first) != NULL &&
+           find_transform_token(store, line, first + 2) != NULL;
 }
 
 /**
- * @brief Parses an assignment string to create or update a vector.
+ * @brief Creates or updates a vector from an assignment.
  *
  * This function handles two types of assignment:
  * 1. Direct assignment from values (e.g., "a = 1 2 3").
- * 2. Assignment from an operation (e.g., "c = a + b").
+ * 2. Assignment from an expression (e.g., "c = (a + b) x d").
  *
  * @param store Pointer to the VectorStore to add the vector to.
- * @param input The user-provided assignment string (e.g., "a = 1 2 3").
+ * @param line The tokenized assignment (e.g., "a = 1 2 3").
+ * @param equals Index of the '=' token.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_assignment(VectorStore *store, TokenList *line, int equals)
+{
+    int right = equals + 1;
+    if (right >= line->count) {
+        out_printf("Invalid assignment format. Use: a = 1 2 3\n");
+        return STATUS_SYNTAX;
+    }
+    if (equals != 1 || line->tokens[0].kind != TOKEN_WORD || lex_is_word(line, 0, BULK_ALL)) {
+        const char *left = equals > 0 ? lex_span(line, 0, equals - 1) : "";
+        if (is_broadcast_pattern(left)) {
+            return handle_broadcast(store, left, lex_rest(line, right));
+        }
+        out_printf("Invalid vector name '%s'. Names are letters, digits or '_'.\n", left);
+        return STATUS_SYNTAX;
+    }
+
+    char *left = lex_span(line, 0, 0);
+    if (is_transform_definition(store, line, right)) {
+        return handle_transform_define(store, line, left, right);
+    }
+    if (transform_find(store, left) != NULL) {
+        out_printf("'%s' is a transform; use another name for a vector.\n", left);
+        return STATUS_SYNTAX;
+    }
+    // A stored vector named like a reduction is copied, not reduced
+    bool reduction = right == line->count - 1 && line->tokens[right].kind == TOKEN_WORD &&
+                     is_reduction_name(lex_rest(line, right)) &&
+                     find_vector(store, lex_rest(line, right)) == NULL;
+    // Reductions and transforms go on to report that they need 3-D vectors
+    if (store->rows != NULL && !reduction && split_transform(store, line, right) == NULL) {
+        return handle_row_assignment(store, left, line, right);
+    }
+
+    vector v;
+    if (reduction) {
+        int status = handle_reduction(store, lex_rest(line, right), &v);
+        if (status != STATUS_OK) {
+            return status;
+        }
+    } else if (!read_literal(line, right, &v)) {
+        int status = handle_operation(store, line, right, &v);
+        if (status != STATUS_OK) {
+            return status;
+        }
+    }
+
+    v.id = store_name(store, left, (size_t)line->tokens[0].length);
+    if (v.id == NO_NAME || !add_vector(store, v)) {
+        return STATUS_IO;
+    }
+    out_printf("%s = %.2f  %.2f  %.2f\n", left, v.x, v.y, v.z);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Binds a vector to a formula (e.g., "c := a + b").
+ *
+ * Unlike '=', which stores a one-time result, the binding is kept: when
+ * an input is reassigned, c is marked dirty and recomputed the next time
+ * it is read. Assigning c directly with '=' removes the binding.
+ *
+ * @param store Pointer to the VectorStore holding the vectors.
+ * @param line The tokenized binding.
+ * @param bind Index of the ':=' token.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_formula(VectorStore *store, TokenList *line, int bind)
+{
+    char error[EXPR_ERROR_LEN];
+    vector v;
+
+    if (bind != 1 || line->tokens[0].kind != TOKEN_WORD || bind + 1 >= line->count) {
+        out_printf("Invalid formula. Use: c := a + b\n");
+        return STATUS_SYNTAX;
+    }
+    if (!require_3d(store, "A formula")) {
+        return STATUS_SYNTAX;
+    }
+
+    char *left = lex_span(line, 0, 0);
+    int status = formula_define(store, left, lex_rest(line, bind + 1), &v, error);
+    if (status != EXPR_OK) {
+        out_printf("%s\n", error);
+        return expr_status(status);
+    }
+    out_printf("%s = %.2f  %.2f  %.2f\n", left, v.x, v.y, v.z);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Applies an expression to every vector matching a pattern.
+ *
+ * Inside the expression the pattern text stands for each vector in turn,
+ * e.g., "all = all * 2" or "p* = p* x axis". Other names are read once
+ * before any vector is updated.
+ *
+ * @param store Pointer to the VectorStore to update.
+ * @param pattern "all" or a '*' / '?' pattern selecting the targets.
+ * @param source The right-hand side expression.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_broadcast(VectorStore *store, const char *pattern, const char *source)
+{
+    char error[EXPR_ERROR_LEN];
+    int updated;
+
+    if (!require_3d(store, "A broadcast update")) {
+        return STATUS_SYNTAX;
+    }
+    int status = broadcast_vectors(store, pattern, source, &updated, error);
+    if (status != EXPR_OK) {
+        out_printf("%s\n", error);
+        return expr_status(status);
+    }
+    out_printf("Updated %d vector%s.\n", updated, updated == 1 ? "" : "s");
+    return STATUS_OK;
+}
+
+/**
+ * @brief Scales every vector matching a pattern to unit length.
+ * @param store Pointer to the VectorStore to update.
+ * @param line The tokenized line: "normalize" and "all", a '*' / '?'
+ * pattern or a single vector name.
+ * @return STATUS_OK on success, STATUS_SYNTAX if no pattern was given.
+ */
+int handle_normalize(VectorStore *store, TokenList *line)
+{
+    if (line->count < 2) {
+        out_printf("Usage: normalize <all | pattern | name>\n");
+        return STATUS_SYNTAX;
+    }
+    if (!require_3d(store, "normalize")) {
+        return STATUS_SYNTAX;
+    }
+    int updated = normalize_vectors(store, lex_rest(line, 1));
+    out_printf("Normalized %d vector%s.\n", updated, updated == 1 ? "" : "s");
+    return STATUS_OK;
+}
+
+/**
+ * @brief Lists the k stored vectors closest to a named vector.
+ *
+ * The query vector itself is stored too, so it is listed first at
+ * distance 0.
+ *
+ * @param store Pointer to the VectorStore to search.
+ * @param line The tokenized line (e.g., "nearest q 5"); k defaults to 1.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
  */
-void handle_assignment(VectorStore *store, char *input)
+int handle_nearest(VectorStore *store, TokenList *line)
 {
-    char left[MAX_TOKEN_LEN_MED];
-    char right[MAX_TOKEN_LEN_LONG];
-    float x;
-    float y;
-    float z;
+    int k = 1;
+    int last = line->count > 1 ? lex_run_end(line, 1) : 0;
 
-    if (sscanf(input, "%31s = %63[^\n]", left, right) != 2) {
-        printf("Invalid assignment format. Use: a = 1 2 3\n");
-        return;
+    if (last == 0 || (last + 1 < line->count &&
+                      (last + 2 != line->count || !lex_int(line, last + 1, &k))) || k < 1) {
+        out_printf("Usage: nearest <name> [k]\n");
+        return STATUS_SYNTAX;
+    }
+    if (!require_3d(store, "nearest")) {
+        return STATUS_SYNTAX;
+    }
+    char *name = lex_span(line, 1, last);
+    vector *q = read_vector(store, name);
+    if (q == NULL) {
+        out_printf("Vector '%s' not found.\n", name);
+        return STATUS_NOT_FOUND;
+    }
+    if (k > store->count) {
+        k = store->count;
     }
 
-    trim(left);
-    trim(right);
+    vector **found = malloc((size_t)k * sizeof(vector *));
+    float *dist = malloc((size_t)k * sizeof(float));
+    int n = found && dist ? nearest_vectors(store, *q, k, found, dist) : -1;
+    if (n < 0) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        free(found);
+        free(dist);
+        return STATUS_IO;
+    }
+    for (int i = 0; i < n; i++) {
+        out_printf("%s = %.2f  %.2f  %.2f  (distance %.4f)\n",
+               vector_name(store, found[i]), found[i]->x, found[i]->y, found[i]->z, dist[i]);
+    }
+    free(found);
+    free(dist);
+    return STATUS_OK;
+}
 
-    if (sscanf(right, "%f %f %f", &x, &y, &z) == 3) {
-        vector v = {.x = x, .y = y, .z = z};
-        strcpy(v.name, left);
-        add_vector(store, v);
-        printf("%s = %.2f  %.2f  %.2f\n", v.name, v.x, v.y, v.z);
-        return;
+/**
+ * @brief Reduces the whole store and prints or returns one result.
+ *
+ * Commands: sum, mean, sumsq, min, max, minmax (prints both corners) and
+ * maxnorm (the longest vector's length, stored in x when assigned).
+ *
+ * @param store Pointer to the VectorStore to reduce.
+ * @param name The reduction's name.
+ * @param out Receives the result instead of printing it, or NULL to print.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_reduction(VectorStore *store, const char *name, vector *out)
+{
+    Reduction red;
+    if (!require_3d(store, name)) {
+        return STATUS_SYNTAX;
+    }
+    if (!reduce_store(store, &red)) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return STATUS_IO;
+    }
+    if (red.count == 0) {
+        out_printf("No vectors stored.\n");
+        return STATUS_NOT_FOUND;
     }
 
-    vector result = handle_operation(store, right);
-    strcpy(result.name, left);
-    add_vector(store, result);
-    printf("%s = %.2f  %.2f  %.2f\n", result.name, result.x, result.y, result.z);
+    vector v;
+    if (out != NULL) {
+        if (!reduction_value(&red, name, out)) {
+            out_printf("'%s' has two results; use min or max.\n", name);
+            return STATUS_SYNTAX;
+        }
+    } else if (strcmp(name, "minmax") == 0) {
+        out_printf("min = %.2f  %.2f  %.2f\n", red.min.x, red.min.y, red.min.z);
+        out_printf("max = %.2f  %.2f  %.2f\n", red.max.x, red.max.y, red.max.z);
+    } else if (strcmp(name, "maxnorm") == 0) {
+        out_printf("maxnorm = %.2f  (%s)\n", red.maxnorm, vector_name(store, &store->vectors[red.maxnorm_slot]));
+    } else {
+        reduction_value(&red, name, &v);
+        out_printf("%s = %.2f  %.2f  %.2f\n", name, v.x, v.y, v.z);
+    }
+    return STATUS_OK;
+}
+
+/**
+ * @brief Runs a reduction typed as a command (e.g., "mean").
+ *
+ * A stored vector of the same name comes first, as it does in
+ * expressions and on the right of '=', so it is shown instead.
+ *
+ * @param store Pointer to the VectorStore to reduce.
+ * @param line The tokenized line: the reduction's name alone.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+static int handle_reduction_command(VectorStore *store, TokenList *line)
+{
+    char *name = lex_rest(line, 0);
+    if (find_vector(store, name) != NULL) {
+        return handle_display(store, line);
+    }
+    return handle_reduction(store, name, NULL);
+}
+
+/**
+ * @brief Streams a CSV file and prints the aggregate named by a token.
+ *
+ * Aggregates: sum, mean (or centroid), bounds (or minmax), magnitude,
+ * dot <ref> and all. The reference of a dot product is a stored vector
+ * name or three numbers.
+ *
+ * @param store Pointer to the VectorStore (only read for a dot reference).
+ * @param filename The CSV file, or "-" for stdin.
+ * @param line Tokens holding the aggregate and any dot reference.
+ * @param agg Index of the aggregate's token in line.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+static int stream_file(VectorStore *store, const char *filename, TokenList *line, int agg)
+{
+    StreamStats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    int rest = agg + 1;
+    bool all = lex_is_word(line, agg, "all");
+    bool dot = lex_is_word(line, agg, "dot");
+    bool sum = lex_is_word(line, agg, "sum");
+    bool mean = lex_is_word(line, agg, "mean") || lex_is_word(line, agg, "centroid");
+    bool bounds = lex_is_word(line, agg, "bounds") || lex_is_word(line, agg, "minmax");
+    bool magnitude = lex_is_word(line, agg, "magnitude");
+    if (!(all || dot || sum || mean || bounds || magnitude) || (!dot && rest < line->count)) {
+        out_printf("Usage: stream <file> <sum|mean|bounds|magnitude|dot <ref>|all>\n");
+        return STATUS_SYNTAX;
+    }
+    if (dot && !read_literal(line, rest, &stats.ref)) {
+        char *name = lex_rest(line, rest);
+        bool given = rest < line->count;
+        if (given && !require_3d(store, "A stored dot reference")) {
+            return STATUS_SYNTAX;
+        }
+        vector *ref = rest == line->count - 1 && line->tokens[rest].kind == TOKEN_WORD ?
+                      read_vector(store, name) : NULL;
+        if (ref == NULL) {
+            out_printf("Reference vector '%s' not found.\n", name);
+            return given ? STATUS_NOT_FOUND : STATUS_SYNTAX;
+        }
+        stats.ref = *ref;
+    }
+
+    if (!stream_vectors(filename, &stats)) {
+        out_printf("Failed to stream vectors from %s.\n", filename);
+        return STATUS_IO;
+    }
+
+    double n = stats.count > 0 ? (double)stats.count : 1.0;
+    out_printf("count = %lld\n", stats.count);
+    if (all || sum) {
+        out_printf("sum = %.4f  %.4f  %.4f\n", stats.sum[0], stats.sum[1], stats.sum[2]);
+    }
+    if (all || mean) {
+        out_printf("mean = %.4f  %.4f  %.4f\n",
+               stats.sum[0] / n, stats.sum[1] / n, stats.sum[2] / n);
+    }
+    if (all || bounds) {
+        out_printf("min = %.4f  %.4f  %.4f\n", stats.min[0], stats.min[1], stats.min[2]);
+        out_printf("max = %.4f  %.4f  %.4f\n", stats.max[0], stats.max[1], stats.max[2]);
+    }
+    if (all || magnitude) {
+        out_printf("magnitude = %.4f\n", stats.magnitude);
+    }
+    if (dot) {
+        out_printf("dot = %.4f\n", stats.dot);
+    }
+    return STATUS_OK;
+}
+
+/**
+ * @brief Computes an aggregate over a CSV file without loading it.
+ * @param store Pointer to the VectorStore (only read for a dot reference).
+ * @param line The tokenized line (e.g., "stream big.csv mean").
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_stream(VectorStore *store, TokenList *line)
+{
+    // The filename is one run of tokens; the aggregate and reference follow
+    int last = line->count > 1 ? lex_run_end(line, 1) : 0;
+    if (last == 0 || last + 1 >= line->count) {
+        out_printf("Usage: stream <file> <sum|mean|bounds|magnitude|dot <ref>|all>\n");
+        return STATUS_SYNTAX;
+    }
+    char *filename = lex_span(line, 1, last);
+    return stream_file(store, filename, line, last + 1);
 }
 
 /**
  * @brief Finds and displays a single vector from the store.
  *
- * Treats the input string as a vector name, searches for it in
- * the store, and prints its contents (e.g., "a = 1.00 2.00 3.00").
+ * Treats the line's one word as a vector name, searches for it in
+ * the store, and prints its components (e.g., "a = 1.00 2.00 3.00").
  * If the vector is not found, it prints an error message.
  *
  * @param store Pointer to the VectorStore to search.
- * @param input The name of the vector to find and display.
+ * @param line The tokenized line: the name alone.
+ * @return STATUS_OK if found, STATUS_NOT_FOUND otherwise.
  */
-void handle_display(VectorStore *store, char *input)
+int handle_display(VectorStore *store, TokenList *line)
 {
-    trim(input);
-    vector *v = find_vector(store, input);
+    char *name = lex_rest(line, 0);
+    vector *v = read_vector(store, name);
+    if (v == NULL && transform_find(store, name) != NULL) {
+        transform_print(name, transform_find(store, name));
+        return STATUS_OK;
+    }
     if (v == NULL) {
-        printf("Vector '%s' not found.\n", input);
+        out_printf("Vector '%s' not found.\n", name);
+        return STATUS_NOT_FOUND;
+    }
+    print_components(name, vector_row(store, v), store->dim);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Saves every vector to a file ("save <file>").
+ * @param store Pointer to the VectorStore to save.
+ * @param line The tokenized line.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_save(VectorStore *store, TokenList *line)
+{
+    if (line->count == 1) {
+        out_printf("Error: Please provide a filename.\n");
+        out_printf("Usage: save <filename.csv>\n");
+        return STATUS_SYNTAX;
+    }
+    char *filename = lex_rest(line, 1);
+
+    // save_vectors returns bool, which decides the status
+    refresh_vectors(store);
+    if (!save_vectors(store, filename)) {
+        // Error message was already printed inside save_vectors
+        out_printf("Failed to save vectors to %s.\n", filename);
+        return STATUS_IO;
+    }
+    out_printf("Vectors have been saved to %s.\n", filename);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Loads a file into the store ("load <file>"), or dispatches
+ * "load --merge ..." and "load <file> where ...".
+ * @param store Pointer to the VectorStore to load into.
+ * @param line The tokenized line.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_load(VectorStore *store, TokenList *line)
+{
+    if (line->count == 1) {
+        out_printf("Error: Please provide a filename.\n");
+        out_printf("Usage: load <filename.csv>\n");
+        return STATUS_SYNTAX;
+    }
+    int last = lex_run_end(line, 1);
+    if (lex_run_is(line, 1, last, "--merge")) {
+        return handle_merge(store, line, last + 1);
+    }
+    for (int i = 2; i + 1 < line->count; i++) {
+        if (lex_is_word(line, i, "where") && !line->tokens[i].joined && !line->tokens[i + 1].joined) {
+            return handle_load_where(store, lex_span(line, 1, i - 1), lex_rest(line, i + 1));
+        }
+    }
+
+    char *filename = lex_rest(line, 1);
+    // Check the boolean return value from load_vectors
+    if (!load_vectors(store, filename)) {
+        // Error message was already printed inside load_vectors
+        out_printf("Failed to load vectors from %s.\n", filename);
+        return STATUS_IO;
+    }
+    out_printf("Vectors have been loaded from %s.\n", filename);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Merges several CSV files into the store ("load --merge a b ...").
+ *
+ * Unlike a plain load, the store is not cleared first. All files are
+ * parsed in parallel; for duplicate names the file given last, and the
+ * line nearest its end, wins.
+ *
+ * @param store Pointer to the VectorStore to merge into.
+ * @param line The tokenized line.
+ * @param first Index of the first filename's first token.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_merge(VectorStore *store, TokenList *line, int first)
+{
+    // Each filename is a run of tokens without whitespace
+    const char **files = malloc((size_t)(line->count - first + 1) * sizeof(char *));
+    if (files == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return STATUS_IO;
+    }
+    int count = 0;
+    for (int i = first; i < line->count; i++) {
+        int last = lex_run_end(line, i);
+        files[count++] = lex_span(line, i, last);
+        i = last;
+    }
+    if (count == 0) {
+        out_printf("Usage: load --merge <file.csv> [file.csv ...]\n");
+        free(files);
+        return STATUS_SYNTAX;
+    }
+
+    int before = store->count;
+    bool ok = load_vectors_merge(store, files, count);
+    free(files);
+    if (!ok) {
+        // Error message was already printed inside load_vectors_merge
+        out_printf("Failed to merge the files.\n");
+        return STATUS_IO;
+    }
+    out_printf("Merged %d file%s: %d vectors added, %d stored.\n", count, count == 1 ? "" : "s",
+               store->count - before, store->count);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Loads the vectors of a .vcol file that match a predicate
+ * ("load <file> where <predicate>").
+ * @param store Pointer to the VectorStore to load into.
+ * @param filename The .vcol file.
+ * @param text The predicate, e.g. "x > 0 and |v| < 10".
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_load_where(VectorStore *store, char *filename, char *text)
+{
+    Predicate where;
+    VcolScan scan;
+
+    if (filename[0] == '\0' || !predicate_parse(&where, text)) {
+        out_printf("Usage: load <file.vcol> where <predicate>, e.g. where x > 0 and |v| < 10\n");
+        return STATUS_SYNTAX;
+    }
+    if (!load_vectors_where(store, filename, &where, &scan)) {
+        // Error message was already printed inside load_vectors_where
+        out_printf("Failed to load vectors from %s.\n", filename);
+        return STATUS_IO;
+    }
+    out_printf("Loaded %d of %lld vectors from %s (read %d of %d chunks).\n",
+               store->count, scan.rows, filename, scan.chunks_read, scan.chunks);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Opens a journal, replaying it into the store if it exists.
+ * @param store Pointer to the VectorStore to journal.
+ * @param base The journal's path without extension.
+ * @return STATUS_OK on success, or STATUS_IO.
+ */
+static int open_journal(VectorStore *store, const char *base)
+{
+    long replayed;
+    if (!journal_open(store, base, &replayed)) {
+        out_printf("Failed to open journal %s.\n", base);
+        return STATUS_IO;
+    }
+    out_printf("Journal %s opened: %d vectors, %ld log records replayed.\n",
+               base, store->count, replayed);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Shows, opens or closes the journal.
+ *
+ * "journal" prints its state, "journal off" flushes and closes it, and
+ * "journal <name>" opens <name>.vbin / <name>.log. Opening replaces the
+ * store with their contents if either exists, or snapshots the store as
+ * it is if neither does.
+ *
+ * @param store Pointer to the VectorStore to journal.
+ * @param line The tokenized line.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_journal(VectorStore *store, TokenList *line)
+{
+    if (line->count == 1) {
+        journal_print(store);
+        return STATUS_OK;
+    }
+    if (line->count == 2 && lex_is_word(line, 1, "off")) {
+        journal_close(store);
+        out_printf("Journal closed.\n");
+        return STATUS_OK;
+    }
+    return open_journal(store, lex_rest(line, 1));
+}
+
+/**
+ * @brief Folds the journal's log into a new snapshot ("compact").
+ * @param store Pointer to the VectorStore being journaled.
+ * @param line The tokenized line (the word alone).
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_compact(VectorStore *store, TokenList *line)
+{
+    (void)line;
+    if (store->journal == NULL) {
+        out_printf("No journal is open; use 'journal <name>' first.\n");
+        return STATUS_SYNTAX;
+    }
+    if (!journal_compact(store)) {
+        out_printf("Failed to compact the journal.\n");
+        return STATUS_IO;
+    }
+    journal_print(store);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Shows or clears the timing histograms ("stats [reset]").
+ * @param store Pointer to the VectorStore (unused; the statistics are global).
+ * @param line The tokenized line.
+ * @return STATUS_OK on success, STATUS_SYNTAX for anything else.
+ */
+int handle_stats(VectorStore *store, TokenList *line)
+{
+    (void)store;
+    if (line->count == 1) {
+        stats_print();
+        return STATUS_OK;
+    }
+    if (line->count == 2 && lex_is_word(line, 1, "reset")) {
+        stats_reset();
+        out_printf("Statistics reset.\n");
+        return STATUS_OK;
+    }
+    out_printf("Usage: stats [reset]\n");
+    return STATUS_SYNTAX;
+}
+
+/**
+ * @brief Prints or sets the number of components per vector.
+ *
+ * Changing the dimension clears the store; loading a file also sets it
+ * from the file's contents.
+ *
+ * @param store Pointer to the VectorStore to reshape.
+ * @param line The tokenized line: "dim" alone to print, or with the new
+ * dimension.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_dimension(VectorStore *store, TokenList *line)
+{
+    int dim;
+
+    if (line->count == 1) {
+        out_printf("dim = %d\n", store->dim);
+        return STATUS_OK;
+    }
+    if (line->count != 2 || !lex_int(line, 1, &dim)) {
+        out_printf("Usage: dim [N]\n");
+        return STATUS_SYNTAX;
+    }
+    if (!set_dimension(store, dim)) {
+        return dim < 1 || dim > WIDE_MAX_DIM ? STATUS_SYNTAX : STATUS_IO;
+    }
+    out_printf("Dimension set to %d; all vectors cleared.\n", dim);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Deletes one vector.
+ * @param store Pointer to the VectorStore to remove from.
+ * @param line The tokenized line: "delete" and the vector's name.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_delete(VectorStore *store, TokenList *line)
+{
+    if (line->count == 1) {
+        out_printf("Usage: delete <name>\n");
+        return STATUS_SYNTAX;
+    }
+    char *name = lex_rest(line, 1);
+    if (!delete_vector(store, find_handle(store, name))) {
+        out_printf("Vector '%s' not found.\n", name);
+        return STATUS_NOT_FOUND;
+    }
+    return STATUS_OK;
+}
+
+/**
+ * @brief Preallocates room for a number of vectors, e.g., before a bulk
+ * load, so the store does not grow block by block.
+ * @param store Pointer to the VectorStore to grow.
+ * @param line The tokenized line: "reserve" and the number of vectors.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_reserve(VectorStore *store, TokenList *line)
+{
+    int capacity;
+
+    if (line->count != 2 || !lex_int(line, 1, &capacity) ||
+        capacity < 0 || capacity > MAX_VECTORS) {
+        out_printf("Usage: reserve <N> (0 to %d)\n", MAX_VECTORS);
+        return STATUS_SYNTAX;
+    }
+    if (!reserve_vectors(store, capacity)) {
+        return STATUS_IO;
+    }
+    out_printf("Room reserved for %d vectors.\n", store->capacity);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Gives back memory the store no longer needs and reports how much.
+ * @param store Pointer to the VectorStore to shrink.
+ * @param line The tokenized line (the word alone).
+ * @return STATUS_OK on success, STATUS_IO if some memory could not be
+ * released.
+ */
+int handle_shrink(VectorStore *store, TokenList *line)
+{
+    size_t used;
+    (void)line;
+    size_t before = store_memory(store, &used);
+    int ok = shrink_vectors(store);
+    size_t after = store_memory(store, &used);
+    out_printf("Released %zu bytes; %zu bytes still allocated.\n", before - after, after);
+    return ok ? STATUS_OK : STATUS_IO;
+}
+
+/**
+ * @brief Parses a CSV precision: "shortest" or a number of decimals.
+ * @param text The text to parse (a command-line argument).
+ * @param precision Receives FTOA_SHORTEST or the decimals.
+ * @return 1 if text is a valid precision, 0 otherwise.
+ */
+static int parse_precision(const char *text, int *precision)
+{
+    int decimals;
+    char extra;
+
+    if (strcmp(text, "shortest") == 0) {
+        *precision = FTOA_SHORTEST;
+        return 1;
+    }
+    if (sscanf(text, "%d %c", &decimals, &extra) != 1 ||
+        decimals < 0 || decimals > FTOA_MAX_DECIMALS) {
+        return 0;
+    }
+    *precision = decimals;
+    return 1;
+}
+
+/**
+ * @brief Prints or sets how many decimals CSV saves write.
+ *
+ * The default, "shortest", writes each component with the fewest digits
+ * that read back as exactly the same float; a number of decimals rounds
+ * like printf's "%.Nf" instead, and 4 gives the older fixed format.
+ *
+ * @param store Pointer to the VectorStore.
+ * @param line The tokenized line: "precision" alone to print, or with the
+ * new precision.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_precision(VectorStore *store, TokenList *line)
+{
+    int decimals;
+
+    if (line->count == 1) {
+        if (store->precision == FTOA_SHORTEST) {
+            out_printf("precision = shortest\n");
+        } else {
+            out_printf("precision = %d\n", store->precision);
+        }
+        return STATUS_OK;
+    }
+    if (line->count == 2 && lex_is_word(line, 1, "shortest")) {
+        store->precision = FTOA_SHORTEST;
+        out_printf("CSV saves will write the shortest exact digits.\n");
+        return STATUS_OK;
+    }
+    if (line->count != 2 || !lex_int(line, 1, &decimals) ||
+        decimals < 0 || decimals > FTOA_MAX_DECIMALS) {
+        out_printf("Usage: precision [shortest | 0-%d]\n", FTOA_MAX_DECIMALS);
+        return STATUS_SYNTAX;
+    }
+    store->precision = decimals;
+    out_printf("CSV saves will write %d decimals.\n", store->precision);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Defines a named transform from a literal, a copy or a product.
+ *
+ * Accepted right sides: "mat3 <9 numbers>", "mat4 <16 numbers>" (both
+ * row by row), "quat w x y z", another transform's name, or "A * B",
+ * which applies B first and then A.
+ *
+ * @param store Pointer to the VectorStore holding the transforms.
+ * @param line The tokenized assignment.
+ * @param left The transform's name.
+ * @param first Index of the definition's first token.
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_transform_define(VectorStore *store, TokenList *line, const char *left, int first)
+{
+    Transform t;
+
+    if (find_vector(store, left) != NULL) {
+        out_printf("'%s' is a vector; use another name for a transform.\n", left);
+        return STATUS_SYNTAX;
+    }
+    if (is_transform_literal(lex_rest(line, first))) {
+        char error[TRANSFORM_ERROR_LEN];
+        if (!transform_parse(lex_rest(line, first), &t, error)) {
+            out_printf("%s\n", error);
+            return STATUS_SYNTAX;
+        }
+    } else if (first == line->count - 1) {
+        t = *find_transform_token(store, line, first);
+    } else {
+        transform_compose(find_transform_token(store, line, first),
+                          find_transform_token(store, line, first + 2), &t);
+    }
+
+    if (!transform_define(store, left, &t)) {
+        return STATUS_IO;
+    }
+    transform_print(left, &t);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Applies a stored transform in place to matching vectors.
+ * @param store Pointer to the VectorStore to update.
+ * @param line The tokenized line (e.g., "transform all by M").
+ * @return STATUS_OK on success, or the STATUS_* code of the error.
+ */
+int handle_transform(VectorStore *store, TokenList *line)
+{
+    int by = 0;
+    for (int i = 2; i + 1 < line->count && by == 0; i++) {
+        if (lex_is_word(line, i, "by") && !line->tokens[i].joined && !line->tokens[i + 1].joined) {
+            by = i;
+        }
+    }
+    if (by == 0) {
+        out_printf("Usage: transform <all | pattern | name> by <M>\n");
+        return STATUS_SYNTAX;
+    }
+    char *pattern = lex_span(line, 1, by - 1);
+    char *name = lex_rest(line, by + 1);
+
+    const Transform *t = transform_find(store, name);
+    if (t == NULL) {
+        out_printf("Transform '%s' not found.\n", name);
+        return STATUS_NOT_FOUND;
+    }
+    if (!require_3d(store, "A transform")) {
+        return STATUS_SYNTAX;
+    }
+    int updated = transform_vectors(store, pattern, t);
+    if (updated < 0) {
+        return STATUS_IO;
+    }
+    out_printf("Transformed %d vector%s.\n", updated, updated == 1 ? "" : "s");
+    return STATUS_OK;
+}
+
+/**
+ * @brief Ends the session ("quit").
+ * @param store Pointer to the VectorStore (unused).
+ * @param line The tokenized line (unused).
+ * @return STATUS_QUIT.
+ */
+static int handle_quit(VectorStore *store, TokenList *line)
+{
+    (void)store;
+    (void)line;
+    return STATUS_QUIT;
+}
+
+/**
+ * @brief Removes every vector ("clear").
+ * @param store Pointer to the VectorStore to clear.
+ * @param line The tokenized line (unused).
+ * @return STATUS_OK.
+ */
+static int handle_clear(VectorStore *store, TokenList *line)
+{
+    (void)line;
+    clear_vectors(store);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Lists every vector and transform ("list").
+ * @param store Pointer to the VectorStore to list.
+ * @param line The tokenized line (unused).
+ * @return STATUS_OK.
+ */
+static int handle_list(VectorStore *store, TokenList *line)
+{
+    (void)line;
+    refresh_vectors(store);
+    list_vectors(store);
+    transform_list(store);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Reports the store's memory use ("mem").
+ * @param store Pointer to the VectorStore to measure.
+ * @param line The tokenized line (unused).
+ * @return STATUS_OK.
+ */
+static int handle_mem(VectorStore *store, TokenList *line)
+{
+    (void)line;
+    print_memory(store);
+    return STATUS_OK;
+}
+
+/* ===========================================================
+ *                       Command Table
+ * =========================================================== */
+
+/** A command's handler; it gets the whole line, command word included. */
+typedef int (*command_fn)(VectorStore *store, TokenList *line);
+
+/* How a command counts for --serve (see is_read_command) */
+#define READS_NEVER          0
+#define READS_BARE           1   /* only when typed without arguments */
+#define READS_ALWAYS         2
+
+#define COMMAND_BITS         6
+#define COMMAND_SLOTS        (1 << COMMAND_BITS)
+#define COMMAND_SEED_TRIES   65536
+
+/**
+ * @brief One command word and how to run it.
+ */
+typedef struct {
+    const char *word;   /**< The command's first word. */
+    command_fn run;     /**< Its handler. */
+    bool takes_args;    /**< false if the word is only the command when alone. */
+    int reads;          /**< READS_NEVER, READS_BARE or READS_ALWAYS. */
+} Command;
+
+/**
+ * Every command, found by a perfect hash of its first letter, last letter
+ * and length, so no two commands may share all three.
+ */
+static const Command commands[] = {
+    { "quit",      handle_quit,              false, READS_NEVER },
+    { "clear",     handle_clear,             false, READS_NEVER },
+    { "list",      handle_list,              false, READS_BARE },
+    { "save",      handle_save,              true,  READS_NEVER },
+    { "load",      handle_load,              true,  READS_NEVER },
+    { "stream",    handle_stream,            true,  READS_ALWAYS },
+    { "journal",   handle_journal,           true,  READS_NEVER },
+    { "compact",   handle_compact,           false, READS_NEVER },
+    { "stats",     handle_stats,             true,  READS_BARE },
+    { "transform", handle_transform,         true,  READS_NEVER },
+    { "dim",       handle_dimension,         true,  READS_BARE },
+    { "precision", handle_precision,         true,  READS_BARE },
+    { "nearest",   handle_nearest,           true,  READS_NEVER },
+    { "normalize", handle_normalize,         true,  READS_NEVER },
+    { "delete",    handle_delete,            true,  READS_NEVER },
+    { "reserve",   handle_reserve,           true,  READS_NEVER },
+    { "shrink",    handle_shrink,            false, READS_NEVER },
+    { "mem",       handle_mem,               false, READS_BARE },
+    { "sum",       handle_reduction_command, false, READS_BARE },
+    { "mean",      handle_reduction_command, false, READS_BARE },
+    { "sumsq",     handle_reduction_command, false, READS_BARE },
+    { "min",       handle_reduction_command, false, READS_BARE },
+    { "max",       handle_reduction_command, false, READS_BARE },
+    { "minmax",    handle_reduction_command, false, READS_BARE },
+    { "maxnorm",   handle_reduction_command, false, READS_BARE },
+};
+
+#define COMMAND_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+static signed char command_slots[COMMAND_SLOTS];  // index into commands, or -1
+static unsigned int command_seed;
+
+/**
+ * @brief Hashes a command word into a slot.
+ * @param word The word's first character.
+ * @param length The word's length (at least 1).
+ * @param seed The multiplier chosen by init_commands.
+ * @return A slot index below COMMAND_SLOTS.
+ */
+static unsigned int command_hash(const char *word, int length, unsigned int seed)
+{
+    unsigned int key = (unsigned int)(unsigned char)word[0] << 16 |
+                       (unsigned int)(unsigned char)word[length - 1] << 8 |
+                       (unsigned int)length;
+    return (key * seed) >> (32 - COMMAND_BITS);
+}
+
+/**
+ * @brief Finds a hash seed that gives every command its own slot.
+ *
+ * Called once at startup; multipliers are tried in a fixed sequence, so
+ * the table is the same on every run.
+ *
+ * @return true if a seed was found.
+ */
+static bool init_commands(void)
+{
+    unsigned int seed = 0x9E3779B9u;
+    for (int tries = 0; tries < COMMAND_SEED_TRIES; tries++) {
+        size_t i = 0;
+        memset(command_slots, -1, sizeof(command_slots));
+        for (; i < COMMAND_COUNT; i++) {
+            const char *word = commands[i].word;
+            unsigned int slot = command_hash(word, (int)strlen(word), seed);
+            if (command_slots[slot] >= 0) {
+                break;
+            }
+            command_slots[slot] = (signed char)i;
+        }
+        if (i == COMMAND_COUNT) {
+            command_seed = seed;
+            return true;
+        }
+        seed = (seed * 1664525u + 1013904223u) | 1u;
+    }
+    return false;
+}
+
+/**
+ * @brief Looks up the command a line starts with.
+ *
+ * One hash probe and one compare. A command that takes arguments must be
+ * followed by whitespace or nothing, and one that takes none must stand
+ * alone. Neither is a command when '=' or ':=' follows the word, so
+ * "sum = a + b" and "dim = a + b" assign vectors of those names.
+ *
+ * @param line The tokenized line.
+ * @return The command, or NULL.
+ */
+static const Command *find_command(const TokenList *line)
+{
+    if (line->count == 0 || line->tokens[0].kind != TOKEN_WORD) {
+        return NULL;
+    }
+    const Token *t = &line->tokens[0];
+    int index = command_slots[command_hash(t->text, t->length, command_seed)];
+    if (index < 0) {
+        return NULL;
+    }
+    const Command *command = &commands[index];
+    if (strncmp(command->word, t->text, (size_t)t->length) != 0 ||
+        command->word[t->length] != '\0') {
+        return NULL;
+    }
+    if (line->count > 1 && (!command->takes_args || line->tokens[1].joined ||
+                            line->tokens[1].kind == '=' || line->tokens[1].kind == TOKEN_BIND)) {
+        return NULL;
+    }
+    return command;
+}
+
+/**
+ * @brief Executes a single tokenized command line against the store.
+ * @param store Pointer to the VectorStore to operate on.
+ * @param line The tokenized command.
+ * @return STATUS_OK on success, STATUS_QUIT for 'quit',
+ * or the STATUS_* code of the error.
+ */
+int execute_command(VectorStore *store, TokenList *line)
+{
+    const Command *command = find_command(line);
+    if (command != NULL) {
+        return command->run(store, line);
+    }
+    int bind = lex_find(line, 0, TOKEN_BIND);
+    if (bind >= 0) {
+        return handle_formula(store, line, bind);
+    }
+    int equals = lex_find(line, 0, '=');
+    if (equals >= 0) {
+        return handle_assignment(store, line, equals);
+    }
+    if (line->count == 1 && line->tokens[0].kind == TOKEN_WORD) {
+        return handle_display(store, line);
+    }
+    return handle_operation(store, line, 0, NULL);
+}
+
+/**
+ * @brief Executes one tokenized command and writes what it changed to the
+ * journal.
+ * @param store Pointer to the VectorStore to operate on.
+ * @param line The tokenized command.
+ * @return The command's status, or STATUS_IO if the journal could not be
+ * written.
+ */
+static int run_line(VectorStore *store, TokenList *line)
+{
+    int status = execute_command(store, line);
+    if (!journal_commit(store) && status == STATUS_OK) {
+        status = STATUS_IO;
+    }
+    return status;
+}
+
+/**
+ * @brief Tokenizes and executes one command, journaling what it changed.
+ * @param store Pointer to the VectorStore to operate on.
+ * @param input The command text.
+ * @return The command's status, or STATUS_IO if the journal could not be
+ * written.
+ */
+int run_command(VectorStore *store, char *input)
+{
+    TokenList line;
+    lex_init(&line);
+    int status = STATUS_IO;
+    if (lex_line(&line, input)) {
+        status = run_line(store, &line);
     } else {
-        printf("%s = %.2f  %.2f  %.2f\n", v->name, v->x, v->y, v->z);
+        fprintf(stderr, "Memory allocation failed.\n");
     }
+    lex_free(&line);
+    return status;
+}
+
+/**
+ * @brief Reads and executes commands until 'quit' or end of input.
+ *
+ * In interactive mode a prompt is printed before every command and
+ * failed commands do not change the result. In batch mode there is no
+ * prompt, and the line number of the first failing command is reported
+ * on stderr.
+ *
+ * @param store Pointer to the VectorStore to operate on.
+ * @param in Stream to read commands from.
+ * @param interactive true to print prompts.
+ * @return STATUS_OK if every command succeeded or the session was
+ * interactive, otherwise the status of the first command that failed
+ * (STATUS_IO if a line could not be tokenized).
+ */
+int run_commands(VectorStore *store, FILE *in, bool interactive)
+{
+    char input[MAX_INPUT_LEN];
+    TokenList line;
+    int first_error = STATUS_OK;
+    int line_number = 0;
+
+    lex_init(&line);
+    if (interactive) {
+        out_printf("vectorcalc> ");
+    }
+
+    while (fgets(input, sizeof(input), in)) {
+        line_number++;
+        // The newline is whitespace to the lexer, so it is trimmed with the rest
+        if (!lex_line(&line, input)) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            first_error = first_error == STATUS_OK ? STATUS_IO : first_error;
+            break;
+        }
+
+        // Blank lines and comments are ignored in scripts
+        if (!interactive && (line.count == 0 || line.tokens[0].kind == '#')) {
+            continue;
+        }
+
+        STATS_START(start);
+        int status = run_line(store, &line);
+        STATS_STOP(STAT_COMMAND, start);
+        if (status == STATUS_QUIT) {
+            break;
+        }
+        // A typo at the prompt is not a failure of the session
+        if (!interactive && status != STATUS_OK && first_error == STATUS_OK) {
+            first_error = status;
+            fprintf(stderr, "Error: command on line %d failed.\n", line_number);
+        }
+
+        if (interactive) {
+            out_printf("vectorcalc> ");
+        }
+    }
+    lex_free(&line);
+    return first_error;
+}
+
+/**
+ * @brief Decides whether a command only reads the store, for --serve.
+ *
+ * Displays, list, dim, precision, mem, stats, stream and reductions qualify, as do
+ * expressions whose compiled form is already cached with live handles.
+ * Nothing qualifies while a formula is dirty, since reading it would
+ * recompute it. Everything else (assignments, load, save, nearest, whose
+ * index is rebuilt lazily, and expressions not yet compiled) is a write.
+ *
+ * @param store Pointer to the VectorStore.
+ * @param input The command text.
+ * @return 1 if the command can run alongside other readers.
+ */
+static int is_read_command(VectorStore *store, char *input)
+{
+    if (formula_any_dirty(store->formulas)) {
+        return 0;
+    }
+
+    TokenList line;
+    const Command *command;
+    int reads;
+    lex_init(&line);
+    if (!lex_line(&line, input)) {
+        reads = 0;
+    } else if ((command = find_command(&line)) != NULL) {
+        reads = command->reads == READS_ALWAYS ||
+                (command->reads == READS_BARE && line.count == 1);
+    } else if (lex_find(&line, 0, '=') >= 0 || lex_find(&line, 0, TOKEN_BIND) >= 0) {
+        reads = 0;
+    } else if (line.count == 1 && line.tokens[0].kind == TOKEN_WORD) {
+        reads = 1;
+    } else if (split_transform(store, &line, 0) != NULL) {
+        // Applying a transform may compile its operand
+        reads = 0;
+    } else {
+        reads = expr_cache_ready(store, lex_rest(&line, 0));
+    }
+    lex_free(&line);
+    return reads;
+}
+
+/**
+ * @brief Writes the statistics as JSON for --stats-json.
+ * @param path The file to write, or "-" for stdout.
+ * @return true if the file was written.
+ */
+static bool write_stats_json(const char *path)
+{
+    if (strcmp(path, "-") == 0) {
+        return stats_write_json(stdout);
+    }
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Error: could not open file '%s'\n", path);
+        return false;
+    }
+    bool ok = stats_write_json(out);
+    return fclose(out) == 0 && ok;
+}
+
+/**
+ * @brief Serves the store on a socket until SIGINT or SIGTERM.
+ * @param store Pointer to the VectorStore to share.
+ * @param path The socket path.
+ * @return STATUS_OK after a clean shutdown, or STATUS_IO.
+ */
+static int serve_store(VectorStore *store, const char *path)
+{
+    fprintf(stderr, "Serving on %s (Ctrl-C to stop).\n", path);
+    return serve(store, path, run_command, is_read_command) ? STATUS_OK : STATUS_IO;
+}
+
+/**
+ * @brief Prints the command-line and interactive command help.
+ */
+void print_help(void)
+{
+    out_printf("\n=== Vector Calculator Help ===\n");
+    out_printf("Usage: ./vectorcalc [OPTION]...\n\n");
+    out_printf("Options:\n");
+    out_printf("  -h           Display this help message\n");
+    out_printf("  -f <script>  Run the commands in a script file, then exit\n");
+    out_printf("  -b           Batch mode: read commands from stdin without prompts\n");
+    out_printf("  -q           Quiet: suppress per-vector add/clear messages\n");
+    out_printf("  -j <N>       Run bulk updates, load and save on N threads (default 1)\n");
+    out_printf("  -s <file> <agg>  Stream a CSV file (\"-\" for stdin) through a fixed\n");
+    out_printf("               buffer, print the aggregate and exit (see 'stream')\n");
+    out_printf("  --stats-json <file>  On exit, write the statistics as JSON (\"-\" for stdout)\n");
+    out_printf("  --precision <N>      Save CSV files with N decimals (default: shortest\n");
+    out_printf("               exact digits; see 'precision')\n");
+    out_printf("  --journal <name>     Open a journal (see 'journal') before anything else\n");
+    out_printf("  --serve <socket>     Serve the store to clients on a Unix socket until\n");
+    out_printf("               Ctrl-C (runs any -f script first)\n\n");
+    out_printf("Interactive Commands:\n");
+    out_printf("  name = x y z         Create or replace a vector (e.g., a = 1 2 3)\n");
+    out_printf("  dim [N]              Show or set the number of components per vector\n");
+    out_printf("                       (clears the store; load sets it from the file)\n");
+    out_printf("  list                 List all stored vectors\n");
+    out_printf("  clear                Remove all stored vectors\n");
+    out_printf("  delete <name>        Remove one vector (the last vector takes its place)\n");
+    out_printf("  reserve <N>          Preallocate room for N vectors before a bulk load\n");
+    out_printf("  shrink               Give back memory kept after clears and deletes\n");
+    out_printf("  mem                  Show bytes used against bytes allocated\n");
+    out_printf("  save <file>          Ability to save to existing or new file\n");
+    out_printf("  load <file>          Need to load from an existing file\n");
+    out_printf("  save/load <f>.vbin   Save or load a binary snapshot (exact, fast)\n");
+    out_printf("  save/load <f>.vcol   Save or load a chunked columnar file with zone maps\n");
+    out_printf("  load <f>.vcol where <predicate>\n");
+    out_printf("                       Load only matching rows, skipping whole chunks;\n");
+    out_printf("                       e.g. where x > 0 and |v| < 10 (x y z w cN |v|,\n");
+    out_printf("                       < <= > >= == !=, and, or, not, parentheses)\n");
+    out_printf("  precision [N]        Show or set the decimals CSV saves write: 0-9, or\n");
+    out_printf("                       'shortest' (default) for exact round trips\n");
+    out_printf("  name                 Display a single vector (e.g., a)\n");
+    out_printf("  a + b, a - b         Vector addition and subtraction\n");
+    out_printf("  a * b                Dot product (scalar result)\n");
+    out_printf("  a x b                Cross product\n");
+    out_printf("  2 * a or a * 2       Scalar multiplication\n");
+    out_printf("  d = (a + b) x c * 2  Chained expressions with precedence,\n");
+    out_printf("                       parentheses and unary minus\n");
+    out_printf("  c := a + b           Bind c to a formula; it is recomputed when read\n");
+    out_printf("                       after any of its inputs change\n");
+    out_printf("  all = all * 2        Update every vector; 'all' stands for each one\n");
+    out_printf("  p* = p* x axis       Update vectors whose names match a '*'/'?' pattern\n");
+    out_printf("  normalize <pattern>  Scale matching vectors (or 'all') to unit length\n");
+    out_printf("  M = mat3 <9 numbers> Define a 3x3 matrix (row by row); mat4 takes 16\n");
+    out_printf("  Q = quat w x y z     Define a rotation quaternion; C = A * B composes\n");
+    out_printf("  d = M * a            Apply a transform to a vector or (expression)\n");
+    out_printf("  transform all by M   Apply M in place to every (or matching) vector\n");
+    out_printf("  nearest q [k]        List the k vectors closest to q (k-d tree)\n");
+    out_printf("  sum, mean, sumsq     Store-wide reductions (compensated SIMD sums);\n");
+    out_printf("  minmax, maxnorm      assign with e.g. c = mean, lo = min, hi = max\n");
+    out_printf("                       (a stored vector of the same name is used instead)\n");
+    out_printf("  stream <file> <agg>  Aggregate a CSV file without loading it: sum, mean,\n");
+    out_printf("                       bounds, magnitude, dot <name | x y z> or all (3-D rows)\n");
+    out_printf("  load --merge <f> ... Merge CSV files into the store in parallel (the\n");
+    out_printf("               last file wins for duplicate names)\n");
+    out_printf("  journal <name>       Journal changes to <name>.log over the snapshot\n");
+    out_printf("               <name>.vbin, replaying both first if they exist\n");
+    out_printf("  journal [off]        Show the journal, or stop journaling\n");
+    out_printf("  compact              Fold the journal's log into a new snapshot\n");
+    out_printf("  stats [reset]        Show (or clear) latency histograms and counters\n");
+    out_printf("  quit                 Exit the program\n");
+    out_printf("\nExample Session:\n");
+    out_printf("  vectorcalc> a = 1 2 3\n");
+    out_printf("  vectorcalc> b = 4 5 6\n");
+    out_printf("  vectorcalc> c = a x b\n");
+    out_printf("  vectorcalc> list\n");
+    out_printf("  vectorcalc> quit\n\n");
+    out_printf("Batch modes exit with the status of the first failing command:\n");
+    out_printf("  2 = bad syntax, 3 = vector not found, 4 = file or memory error\n\n");
 }
 
 /**
  * @brief Main entry point for the vector calculator.
  *
  * Initializes the vector store, checks for command-line arguments
- * (like -h for help), and then enters the main interactive
- * read-process-print loop until the user types 'quit'.
+ * (like -h for help), and then enters the read-process-print loop
+ * until the user types 'quit'. With -f or -b the loop runs without
+ * prompts and with fully buffered output, so throughput is not bound
+ * by terminal I/O.
  *
  * @param argc The count of command-line arguments.
  * @param argv An array of strings containing the command-line arguments.
  * @return 0 on successful program termination (e.g., 'quit' or '-h').
  * @return 1 if an invalid command-line option is provided.
+ * @return The status of the first failing command of a -f or -b run.
  */
 int main(int argc, char *argv[])
 {
     VectorStore store;
+    if (!init_commands()) {
+        fprintf(stderr, "Error: no perfect hash for the command table.\n");
+        return STATUS_IO;
+    }
     init_store(&store);  
 
-    if (argc > 1) {
-        if (strcmp(argv[1], "-h") == 0) {
-            printf("\n=== Vector Calculator Help ===\n");
-            printf("Usage: ./vectorcalc [OPTION]\n\n");
-            printf("Options:\n");
-            printf("  -h           Display this help message\n\n");
-            printf("Interactive Commands:\n");
-            printf("  name = x y z         Create or replace a vector (e.g., a = 1 2 3)\n");
-            printf("  list                 List all stored vectors\n");
-            printf("  clear                Remove all stored vectors\n");
-            printf("  save <file>          Ability to save to existing or new file\n");
-            printf("  load <file>          Need to load from an existing file\n");
-            printf("  name                 Display a single vector (e.g., a)\n");
-            printf("  a + b, a - b         Vector addition and subtraction\n");
-            printf("  a * b                Dot product (scalar result)\n");
-            printf("  a x b                Cross product\n");
-            printf("  2 * a or a * 2       Scalar multiplication\n");
-            printf("  quit                 Exit the program\n");
-            printf("\nExample Session:\n");
-            printf("  vectorcalc> a = 1 2 3\n");
-            printf("  vectorcalc> b = 4 5 6\n");
-            printf("  vectorcalc> c = a x b\n");
-            printf("  vectorcalc> list\n");
-            printf("  vectorcalc> quit\n\n");
+    const char *script = NULL;
+    const char *stats_json = NULL;
+    const char *socket_path = NULL;
+    const char *journal_base = NULL;
+    bool batch = false;
+    const char *stream_path = NULL;
+    char *stream_agg = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-h") == 0) {
+            print_help();
             free_store(&store);
-            return 0;
+            return STATUS_OK;
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            script = argv[++i];
+            batch = true;
+        } else if (strcmp(argv[i], "-b") == 0) {
+            batch = true;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            store.quiet = 1;
+        } else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+            if (!parse_precision(argv[++i], &store.precision)) {
+                out_printf("Invalid precision '%s' (shortest or 0 to %d).\n", argv[i],
+                           FTOA_MAX_DECIMALS);
+                free_store(&store);
+                return STATUS_BAD_OPTION;
+            }
+        } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            journal_base = argv[++i];
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--stats-json") == 0 && i + 1 < argc) {
+            stats_json = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i + 2 < argc) {
+            stream_path = argv[++i];
+            stream_agg = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            char *end;
+            long threads = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || threads < 1 || threads > MAX_THREADS) {
+                out_printf("Invalid thread count '%s' (1 to %d).\n", argv[i], MAX_THREADS);
+                free_store(&store);
+                return STATUS_BAD_OPTION;
+            }
+            pool_free(store.pool);
+            store.pool = pool_create((int)threads);
+            if (threads > 1 && store.pool == NULL) {
+                fprintf(stderr, "Warning: could not start %ld threads; running serially.\n",
+                        threads);
+            }
         } else {
-            printf("Unknown option: %s\n", argv[1]);
-            printf("Use './vectorcalc -h' for help.\n");
+            out_printf("Unknown option: %s\n", argv[i]);
+            out_printf("Use './vectorcalc -h' for help.\n");
             free_store(&store);
-            return 1;
+            return STATUS_BAD_OPTION;
         }
     }
 
-    char input[MAX_INPUT_LEN];
-    printf("vectorcalc> ");
+    if (stream_path != NULL) {
+        // Stream mode needs no store contents, so it runs and exits. The
+        // path is used as given; only the aggregate (e.g., "dot 1 0 0") is lexed.
+        TokenList line;
+        lex_init(&line);
+        int status = lex_line(&line, stream_agg) ? stream_file(&store, stream_path, &line, 0)
+                                                 : STATUS_IO;
+        lex_free(&line);
+        free_store(&store);
+        return status;
+    }
 
-    while (fgets(input, sizeof(input), stdin)) {
-        input[strcspn(input, "\n")] = '\0';
-        trim(input);
+    if (journal_base != NULL && open_journal(&store, journal_base) != STATUS_OK) {
+        free_store(&store);
+        return STATUS_IO;
+    }
 
-        if (strcmp(input, "quit") == 0) {
-            break;
-        } else if (strcmp(input, "clear") == 0) {
-            clear_vectors(&store);
-        } else if (strcmp(input, "list") == 0) {
-            list_vectors(&store);
-        } else if (strcmp(input, "save") == 0) {
-            // Catches the user typing just "save"
-            printf("Error: Please provide a filename.\n");
-            printf("Usage: save <filename.csv>\n");
-        } else if (strncmp(input, "save ", 5) == 0) {
-            char* filename = input + 5; 
-            trim(filename);
-
-            if (strlen(filename) == 0) {
-                printf("Error: Please provide a filename.\n");
-                printf("Usage: save <filename.csv>\n");
-            } else {
-                // save_vectors returns bool, but we can just call it
-                if (save_vectors(&store, filename)) {
-                    printf("Vectors have been saved to %s.\n", filename);
-                } else {
-                    // Error message was already printed inside save_vectors
-                    printf("Failed to save vectors to %s.\n", filename);
-                }
-            }
-        // --- LOAD BLOCK ---
-        } else if (strcmp(input, "load") == 0) {
-            // Catches the user typing just "load"
-            printf("Error: Please provide a filename.\n");
-            printf("Usage: load <filename.csv>\n");
-        } else if (strncmp(input, "load ", 5) == 0) {
-            char* filename = input + 5;
-            trim(filename);
-
-            if (strlen(filename) == 0) {
-                printf("Error: Please provide a filename.\n");
-                printf("Usage: load <filename.csv>\n");
-            } else {
-                // *** THIS IS THE KEY PART ***
-                // Check the boolean return value from load_vectors
-                if (load_vectors(&store, filename)) {
-                    printf("Vectors have been loaded from %s.\n", filename);
-                } else {
-                    // Error message was already printed inside load_vectors
-                    printf("Failed to load vectors from %s.\n", filename);
-                }
-            }
-        } else if (strchr(input, '=') != NULL) {
-            handle_assignment(&store, input);
-        } else if (strchr(input, '+') || strchr(input, '-') ||
-                   strchr(input, '*') || strchr(input, 'x') || strchr(input, 'X')) {
-            handle_operation(&store, input);
-        } else {
-            handle_display(&store, input);
+    if (socket_path != NULL && script == NULL) {
+        int status = serve_store(&store, socket_path);
+        if (stats_json != NULL && !write_stats_json(stats_json) && status == STATUS_OK) {
+            status = STATUS_IO;
         }
+        free_store(&store);
+        return status;
+    }
 
-        printf("vectorcalc> ");
+    FILE *in = stdin;
+    if (script != NULL) {
+        in = fopen(script, "r");
+        if (in == NULL) {
+            fprintf(stderr, "Error: could not open script '%s'\n", script);
+            free_store(&store);
+            return STATUS_BAD_OPTION;
+        }
     }
 
-    printf("Goodbye!\n");
+    if (batch) {
+        // Let stdio collect output into large blocks instead of lines
+        setvbuf(stdout, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+    }
+
+    int status = run_commands(&store, in, !batch);
+
+    if (script != NULL) {
+        fclose(in);
+    }
+    if (socket_path != NULL && status == STATUS_OK) {
+        // The script only prepared the store
+        status = serve_store(&store, socket_path);
+    }
+    if (!batch) {
+        out_printf("Goodbye!\n");
+    }
+    if (stats_json != NULL && !write_stats_json(stats_json) && status == STATUS_OK) {
+        status = STATUS_IO;
+    }
     free_store(&store);  
-    return 0;
+    return status;
 }
@@ -0,0 +1,216 @@
+/**
+ * @file      : pool.c
+ * @brief     : Defines a persistent pthread worker pool that runs
+ *              chunked jobs over the vector store.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#define _POSIX_C_SOURCE 200809L // Needed for pthreads under -std=c11
+
+#include "pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/**
+ * @brief Pool state shared by the submitting thread and the workers.
+ *
+ * A job is published by bumping job_id under the lock. Tasks are then
+ * claimed with an atomic counter, so no lock is held while they run.
+ * Jobs submitted from several threads at once (the server's readers) take
+ * turns on submit_lock.
+ */
+struct WorkerPool {
+    pthread_t *workers;        /**< The worker threads. */
+    int worker_count;          /**< Number of worker threads. */
+    pthread_mutex_t submit_lock; /**< Held by the thread whose job is running. */
+    pthread_mutex_t lock;      /**< Guards everything below except next_task. */
+    pthread_cond_t job_ready;  /**< Signaled when a job is published. */
+    pthread_cond_t job_done;   /**< Signaled when the last worker finishes. */
+    pool_task_fn task;         /**< Task function of the current job. */
+    void *context;             /**< Shared state of the current job. */
+    int task_count;            /**< Number of tasks in the current job. */
+    atomic_int next_task;      /**< Next unclaimed task index. */
+    int busy;                  /**< Workers still inside the current job. */
+    unsigned long job_id;      /**< Incremented for every published job. */
+    int shutdown;              /**< Nonzero tells the workers to exit. */
+};
+
+/**
+ * @brief Claims and runs tasks of the current job until none are left.
+ * @param pool - The pool.
+ */
+static void drain_tasks(WorkerPool *pool) {
+    int task;
+    while ((task = atomic_fetch_add(&pool->next_task, 1)) < pool->task_count) {
+        pool->task(pool->context, task);
+    }
+}
+
+/**
+ * @brief Worker thread body: waits for each job and helps run it.
+ * @param arg - The pool.
+ * @return NULL.
+ */
+static void *worker_main(void *arg) {
+    WorkerPool *pool = arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->job_id == seen) {
+            pthread_cond_wait(&pool->job_ready, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->job_id;
+        pthread_mutex_unlock(&pool->lock);
+
+        drain_tasks(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) {
+            pthread_cond_signal(&pool->job_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * @brief Starts a pool whose jobs run on threads threads in total.
+ * @param threads - Total threads per job, including the caller.
+ * @return The pool, or NULL if threads < 2 or the threads could not start.
+ */
+WorkerPool *pool_create(int threads) {
+    if (threads < 2) {
+        return NULL;
+    }
+    WorkerPool *pool = calloc(1, sizeof(WorkerPool));
+    if (!pool) {
+        return NULL;
+    }
+    pool->workers = malloc((size_t)(threads - 1) * sizeof(pthread_t));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->submit_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->job_ready, NULL);
+    pthread_cond_init(&pool->job_done, NULL);
+    atomic_init(&pool->next_task, 0);
+
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&pool->workers[i], NULL, worker_main, pool) != 0) {
+            break;
+        }
+        pool->worker_count++;
+    }
+    if (pool->worker_count == 0) {
+        pool_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/**
+ * @brief Stops and joins the workers and frees the pool.
+ * @param pool - The pool to free (NULL is allowed).
+ */
+void pool_free(WorkerPool *pool) {
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    pthread_cond_destroy(&pool->job_done);
+    pthread_cond_destroy(&pool->job_ready);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->submit_lock);
+    free(pool->workers);
+    free(pool);
+}
+
+/**
+ * @brief Returns the number of threads a job runs on.
+ * @param pool - The pool, or NULL for serial execution.
+ * @return The thread count (1 for NULL).
+ */
+int pool_threads(const WorkerPool *pool) {
+    return pool ? pool->worker_count + 1 : 1;
+}
+
+/**
+ * @brief Runs task(context, i) for every i in [0, tasks) and waits.
+ * @param pool - The pool, or NULL to run on the calling thread.
+ * @param tasks - Number of tasks.
+ * @param task - The task function.
+ * @param context - Shared state passed to every task.
+ */
+void pool_run(WorkerPool *pool, int tasks, pool_task_fn task, void *context) {
+    if (!pool || tasks <= 1) {
+        for (int i = 0; i < tasks; i++) {
+            task(context, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->task_count = tasks;
+    atomic_store(&pool->next_task, 0);
+    pool->busy = pool->worker_count;
+    pool->job_id++;
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    // The submitting thread works too instead of sitting idle
+    drain_tasks(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) {
+        pthread_cond_wait(&pool->job_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+/**
+ * @brief Returns how many chunks of POOL_CHUNK_VECTORS cover count items.
+ * @param count - Number of items.
+ * @return The number of chunks (0 for an empty range).
+ */
+int pool_chunks(int count) {
+    return count > 0 ? (count - 1) / POOL_CHUNK_VECTORS + 1 : 0;
+}
+
+/**
+ * @brief Combines per-chunk partial results in a fixed pairwise tree.
+ * @param partials - Array of count partial results, each size bytes.
+ * @param count - Number of partials.
+ * @param size - Size of one partial.
+ * @param combine - The merge operation.
+ */
+void pool_combine_tree(void *partials, int count, size_t size, pool_combine_fn combine) {
+    char *base = partials;
+    for (int step = 1; step < count; step *= 2) {
+        for (int i = 0; i + step < count; i += 2 * step) {
+            combine(base + (size_t)i * size, base + (size_t)(i + step) * size);
+        }
+    }
+}
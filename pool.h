@@ -0,0 +1,100 @@
+/**
+ * @file      : pool.h
+ * @brief     : Declares a persistent pthread worker pool that runs
+ *              chunked jobs over the vector store.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+/*
+ * Vectors per chunk of a bulk job. 8192 vectors of 24 bytes is 192 KiB,
+ * which stays inside a typical per-core L2 cache. Chunk boundaries depend
+ * only on this constant, never on the number of threads, which is what
+ * keeps chunked reductions deterministic.
+ */
+#define POOL_CHUNK_VECTORS 8192
+
+/**
+ * @brief A fixed set of threads that wait for jobs and run their tasks.
+ */
+typedef struct WorkerPool WorkerPool;
+
+/**
+ * @brief One task of a job; called once for every task index.
+ * @param context The job's shared state.
+ * @param task Index of the task, 0 <= task < task count.
+ */
+typedef void (*pool_task_fn)(void *context, int task);
+
+/**
+ * @brief Merges the partial result from into into (into = into op from).
+ * @param into The left partial, updated in place.
+ * @param from The right partial.
+ */
+typedef void (*pool_combine_fn)(void *into, const void *from);
+
+/**
+ * @brief Starts a pool whose jobs run on threads threads in total.
+ * The calling thread takes part in every job, so threads - 1 workers are
+ * created.
+ * @param threads Total threads per job (at least 2 to be useful).
+ * @return The pool, or NULL if threads < 2 or the threads could not start.
+ */
+WorkerPool *pool_create(int threads);
+
+/**
+ * @brief Stops and joins the workers and frees the pool.
+ * @param pool The pool to free (NULL is allowed).
+ */
+void pool_free(WorkerPool *pool);
+
+/**
+ * @brief Returns the number of threads a job runs on.
+ * @param pool The pool, or NULL for serial execution.
+ * @return The thread count (1 for NULL).
+ */
+int pool_threads(const WorkerPool *pool);
+
+/**
+ * @brief Runs task(context, i) for every i in [0, tasks) and waits for
+ * all of them. Tasks are handed out dynamically, so their order and the
+ * thread each one runs on are unspecified. Several threads may submit
+ * jobs at once; the jobs then run one after another.
+ * @param pool The pool, or NULL to run every task on the calling thread.
+ * @param tasks Number of tasks.
+ * @param task The task function.
+ * @param context Shared state passed to every task.
+ */
+void pool_run(WorkerPool *pool, int tasks, pool_task_fn task, void *context);
+
+/**
+ * @brief Returns how many chunks of POOL_CHUNK_VECTORS cover count items.
+ * @param count Number of items.
+ * @return The number of chunks (0 for an empty range).
+ */
+int pool_chunks(int count);
+
+/**
+ * @brief Combines per-chunk partial results in a fixed pairwise tree.
+ *
+ * Level by level, partial i absorbs partial i + step for step = 1, 2,
+ * 4, ..., so the order of every floating-point operation depends only on
+ * the number of partials. The result is left in the first partial.
+ *
+ * @param partials Array of count partial results, each size bytes.
+ * @param count Number of partials.
+ * @param size Size of one partial.
+ * @param combine The merge operation.
+ */
+void pool_combine_tree(void *partials, int count, size_t size, pool_combine_fn combine);
+
+#endif /* POOL_H */
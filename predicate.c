@@ -0,0 +1,425 @@
+/**
+ * @file      : predicate.c
+ * @brief     : Defines the row predicates of 'load <file> where ...' and
+ *              their evaluation against per-chunk zone maps.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "predicate.h"
+#include "util.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_COLUMN 4095   /**< Highest cN accepted (WIDE_MAX_DIM - 1). */
+
+/** Node kinds: the comparisons first, then the connectives. */
+enum { NODE_LT, NODE_LE, NODE_GT, NODE_GE, NODE_EQ, NODE_NE, NODE_AND, NODE_OR, NODE_NOT };
+
+/**
+ * @brief Parser state: the text and how far it has been read.
+ */
+typedef struct {
+    Predicate *predicate;  /**< Receives the nodes. */
+    const char *p;         /**< Next unread character. */
+    const char *end;       /**< End of the text. */
+} PredicateParser;
+
+static int parse_or(PredicateParser *parser);
+
+/**
+ * @brief Skips blanks.
+ * @param parser - The parser.
+ */
+static void skip_blanks(PredicateParser *parser) {
+    while (parser->p < parser->end && isspace((unsigned char)*parser->p)) {
+        parser->p++;
+    }
+}
+
+/**
+ * @brief Consumes a keyword if it comes next as a whole word.
+ * @param parser - The parser.
+ * @param word - The keyword.
+ * @return 1 if it was consumed, 0 otherwise.
+ */
+static int accept_word(PredicateParser *parser, const char *word) {
+    skip_blanks(parser);
+    size_t length = strlen(word);
+    if ((size_t)(parser->end - parser->p) < length || strncmp(parser->p, word, length) != 0) {
+        return 0;
+    }
+    const char *after = parser->p + length;
+    if (after < parser->end && (isalnum((unsigned char)*after) || *after == '_')) {
+        return 0;
+    }
+    parser->p = after;
+    return 1;
+}
+
+/**
+ * @brief Adds a node.
+ * @param parser - The parser.
+ * @param node - The node to add.
+ * @return Its index, or -1 if the predicate is too long (reported).
+ */
+static int add_node(PredicateParser *parser, PredicateNode node) {
+    Predicate *predicate = parser->predicate;
+    if (predicate->count == PREDICATE_MAX_NODES) {
+        fprintf(stderr, "Error: predicate has more than %d terms.\n", PREDICATE_MAX_NODES);
+        return -1;
+    }
+    predicate->nodes[predicate->count] = node;
+    return predicate->count++;
+}
+
+/**
+ * @brief Adds a connective over one or two operands.
+ * @param parser - The parser.
+ * @param kind - NODE_AND, NODE_OR or NODE_NOT.
+ * @param left - The first operand.
+ * @param right - The second operand (-1 for not).
+ * @return Its index, or -1 on error.
+ */
+static int add_connective(PredicateParser *parser, int kind, int left, int right) {
+    PredicateNode node = { kind, 0, 0.0f, left, right };
+    return add_node(parser, node);
+}
+
+/**
+ * @brief Reports a syntax error at the current position.
+ * @param parser - The parser.
+ * @param expected - What should have come next.
+ * @return -1.
+ */
+static int syntax_error(PredicateParser *parser, const char *expected) {
+    skip_blanks(parser);
+    if (parser->p == parser->end) {
+        fprintf(stderr, "Error: predicate ends where %s was expected.\n", expected);
+    } else {
+        fprintf(stderr, "Error: expected %s at '%.*s' in the predicate.\n", expected,
+                (int)(parser->end - parser->p), parser->p);
+    }
+    return -1;
+}
+
+/**
+ * @brief Reads an operand: x, y, z, w, cN or |v|.
+ * @param parser - The parser.
+ * @param column - Receives the component, or PREDICATE_NORM.
+ * @return 1 if one was read, 0 if none comes next (nothing consumed).
+ */
+static int parse_operand(PredicateParser *parser, int *column) {
+    skip_blanks(parser);
+    const char *p = parser->p;
+    size_t left = (size_t)(parser->end - p);
+    if (left >= 3 && strncmp(p, "|v|", 3) == 0) {
+        *column = PREDICATE_NORM;
+        parser->p += 3;
+        return 1;
+    }
+    if (left == 0 || !isalpha((unsigned char)*p)) {
+        return 0;
+    }
+    size_t length = 1;
+    while (length < left && isalnum((unsigned char)p[length])) {
+        length++;
+    }
+    static const char axes[] = "xyzw";
+    const char *axis = length == 1 ? strchr(axes, *p) : NULL;
+    if (axis != NULL) {
+        *column = (int)(axis - axes);
+    } else if (*p == 'c' && length > 1 && length <= 5) {
+        *column = 0;
+        for (size_t i = 1; i < length; i++) {
+            if (!isdigit((unsigned char)p[i])) {
+                return 0;
+            }
+            *column = *column * 10 + (p[i] - '0');
+        }
+        if (*column > MAX_COLUMN) {
+            return 0;
+        }
+    } else {
+        return 0;
+    }
+    parser->p += length;
+    return 1;
+}
+
+/**
+ * @brief Reads a comparison operator.
+ * @param parser - The parser.
+ * @param kind - Receives the NODE_* comparison.
+ * @return 1 if one was read, 0 otherwise.
+ */
+static int parse_operator(PredicateParser *parser, int *kind) {
+    skip_blanks(parser);
+    const char *p = parser->p;
+    int two = parser->end - p >= 2 && p[1] == '=';
+    if (p == parser->end) {
+        return 0;
+    }
+    if (*p == '<') {
+        *kind = two ? NODE_LE : NODE_LT;
+    } else if (*p == '>') {
+        *kind = two ? NODE_GE : NODE_GT;
+    } else if (*p == '=' && two) {
+        *kind = NODE_EQ;
+    } else if (*p == '!' && two) {
+        *kind = NODE_NE;
+    } else {
+        return 0;
+    }
+    parser->p += two ? 2 : 1;
+    return 1;
+}
+
+/**
+ * @brief Reads a comparison, in either order.
+ * @param parser - The parser.
+ * @return The comparison's node, or -1 on error.
+ */
+static int parse_comparison(PredicateParser *parser) {
+    // Mirror images, for "number op operand"
+    static const int flipped[] = { NODE_GT, NODE_GE, NODE_LT, NODE_LE, NODE_EQ, NODE_NE };
+    PredicateNode node = { 0, 0, 0.0f, -1, -1 };
+    int number_first = !parse_operand(parser, &node.column);
+    if (number_first) {
+        const char *after = parse_float(parser->p, parser->end, &node.value);
+        if (after == NULL) {
+            return syntax_error(parser, "x, y, z, w, cN, |v| or a number");
+        }
+        parser->p = after;
+    }
+    if (!parse_operator(parser, &node.kind)) {
+        return syntax_error(parser, "<, <=, >, >=, == or !=");
+    }
+    if (number_first) {
+        if (!parse_operand(parser, &node.column)) {
+            return syntax_error(parser, "x, y, z, w, cN or |v|");
+        }
+        node.kind = flipped[node.kind];
+    } else {
+        const char *after = parse_float(parser->p, parser->end, &node.value);
+        if (after == NULL) {
+            return syntax_error(parser, "a number");
+        }
+        parser->p = after;
+    }
+    if (node.column > parser->predicate->max_column) {
+        parser->predicate->max_column = node.column;
+    }
+    return add_node(parser, node);
+}
+
+/**
+ * @brief Reads a factor: a negation, a parenthesized predicate or a comparison.
+ * @param parser - The parser.
+ * @return The factor's node, or -1 on error.
+ */
+static int parse_factor(PredicateParser *parser) {
+    if (accept_word(parser, "not")) {
+        int operand = parse_factor(parser);
+        return operand < 0 ? -1 : add_connective(parser, NODE_NOT, operand, -1);
+    }
+    skip_blanks(parser);
+    if (parser->p < parser->end && *parser->p == '(') {
+        parser->p++;
+        int inner = parse_or(parser);
+        if (inner < 0) {
+            return -1;
+        }
+        skip_blanks(parser);
+        if (parser->p == parser->end || *parser->p != ')') {
+            return syntax_error(parser, "')'");
+        }
+        parser->p++;
+        return inner;
+    }
+    return parse_comparison(parser);
+}
+
+/**
+ * @brief Reads factors joined by "and".
+ * @param parser - The parser.
+ * @return The conjunction's node, or -1 on error.
+ */
+static int parse_and(PredicateParser *parser) {
+    int left = parse_factor(parser);
+    while (left >= 0 && accept_word(parser, "and")) {
+        int right = parse_factor(parser);
+        left = right < 0 ? -1 : add_connective(parser, NODE_AND, left, right);
+    }
+    return left;
+}
+
+/**
+ * @brief Reads conjunctions joined by "or".
+ * @param parser - The parser.
+ * @return The disjunction's node, or -1 on error.
+ */
+static int parse_or(PredicateParser *parser) {
+    int left = parse_and(parser);
+    while (left >= 0 && accept_word(parser, "or")) {
+        int right = parse_and(parser);
+        left = right < 0 ? -1 : add_connective(parser, NODE_OR, left, right);
+    }
+    return left;
+}
+
+/**
+ * @brief Compiles a predicate.
+ * @param predicate - Receives the compiled form.
+ * @param text - The predicate text (e.g., "x > 0 and |v| < 10").
+ * @return 1 if successful, 0 if the text is malformed (reported on stderr).
+ */
+int predicate_parse(Predicate *predicate, const char *text) {
+    PredicateParser parser = { predicate, text, text + strlen(text) };
+    predicate->count = 0;
+    predicate->max_column = -1;
+    predicate->root = parse_or(&parser);
+    if (predicate->root < 0) {
+        return 0;
+    }
+    skip_blanks(&parser);
+    if (parser.p != parser.end) {
+        syntax_error(&parser, "'and', 'or' or the end");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Judges one comparison over a range of values.
+ * @param kind - The NODE_* comparison.
+ * @param low - Smallest value in the range.
+ * @param high - Largest value in the range.
+ * @param value - The constant compared against.
+ * @return Whether none, some or all values in [low, high] satisfy it.
+ */
+static zone_match_t compare_range(int kind, double low, double high, double value) {
+    int all, none;
+    switch (kind) {
+        case NODE_LT: all = high < value;  none = low >= value; break;
+        case NODE_LE: all = high <= value; none = low > value;  break;
+        case NODE_GT: all = low > value;   none = high <= value; break;
+        case NODE_GE: all = low >= value;  none = high < value; break;
+        case NODE_EQ: all = low == value && high == value; none = value < low || value > high; break;
+        default:      all = value < low || value > high; none = low == value && high == value; break;
+    }
+    return all ? ZONE_ALL : none ? ZONE_NONE : ZONE_SOME;
+}
+
+/**
+ * @brief Judges a node over a chunk.
+ * @param predicate - The compiled predicate.
+ * @param index - The node.
+ * @param zone - The chunk's ranges.
+ * @return ZONE_NONE, ZONE_SOME or ZONE_ALL.
+ */
+static zone_match_t zone_node(const Predicate *predicate, int index, const ZoneMap *zone) {
+    const PredicateNode *node = &predicate->nodes[index];
+    zone_match_t left, right;
+    switch (node->kind) {
+        case NODE_AND:
+            left = zone_node(predicate, node->left, zone);
+            if (left == ZONE_NONE) {
+                return ZONE_NONE;
+            }
+            right = zone_node(predicate, node->right, zone);
+            return right == ZONE_NONE ? ZONE_NONE : left == ZONE_ALL ? right : ZONE_SOME;
+        case NODE_OR:
+            left = zone_node(predicate, node->left, zone);
+            if (left == ZONE_ALL) {
+                return ZONE_ALL;
+            }
+            right = zone_node(predicate, node->right, zone);
+            return right == ZONE_ALL ? ZONE_ALL : left == ZONE_NONE ? right : ZONE_SOME;
+        case NODE_NOT:
+            left = zone_node(predicate, node->left, zone);
+            return left == ZONE_ALL ? ZONE_NONE : left == ZONE_NONE ? ZONE_ALL : ZONE_SOME;
+        default:
+            if (node->column == PREDICATE_NORM) {
+                return compare_range(node->kind, zone->min_norm, zone->max_norm, node->value);
+            }
+            return compare_range(node->kind, zone->min[node->column], zone->max[node->column],
+                                 node->value);
+    }
+}
+
+/**
+ * @brief Judges a whole chunk from its zone map.
+ * @param predicate - The compiled predicate.
+ * @param zone - The chunk's ranges.
+ * @return ZONE_NONE, ZONE_SOME or ZONE_ALL.
+ */
+zone_match_t predicate_zone(const Predicate *predicate, const ZoneMap *zone) {
+    return zone_node(predicate, predicate->root, zone);
+}
+
+/**
+ * @brief Tests a node against one row.
+ * @param predicate - The compiled predicate.
+ * @param index - The node.
+ * @param row - The row's components.
+ * @param dim - Number of components.
+ * @return 1 if the node holds for the row.
+ */
+static int row_node(const Predicate *predicate, int index, const float *row, int dim) {
+    const PredicateNode *node = &predicate->nodes[index];
+    switch (node->kind) {
+        case NODE_AND:
+            return row_node(predicate, node->left, row, dim) &&
+                   row_node(predicate, node->right, row, dim);
+        case NODE_OR:
+            return row_node(predicate, node->left, row, dim) ||
+                   row_node(predicate, node->right, row, dim);
+        case NODE_NOT:
+            return !row_node(predicate, node->left, row, dim);
+        default: {
+            double x = node->column == PREDICATE_NORM ? predicate_norm(row, dim) : row[node->column];
+            double value = node->value;
+            switch (node->kind) {
+                case NODE_LT: return x < value;
+                case NODE_LE: return x <= value;
+                case NODE_GT: return x > value;
+                case NODE_GE: return x >= value;
+                case NODE_EQ: return x == value;
+                default:      return x != value;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Tests one row.
+ * @param predicate - The compiled predicate.
+ * @param row - The row's components (at least max_column + 1 of them).
+ * @param dim - Number of components in row.
+ * @return 1 if the row matches, 0 otherwise.
+ */
+int predicate_row(const Predicate *predicate, const float *row, int dim) {
+    return row_node(predicate, predicate->root, row, dim);
+}
+
+/**
+ * @brief Computes |v| the way predicates compare it.
+ * @param row - The components.
+ * @param dim - Number of components.
+ * @return The Euclidean length, accumulated in double precision.
+ */
+double predicate_norm(const float *row, int dim) {
+    double sum = 0.0;
+    for (int d = 0; d < dim; d++) {
+        sum += (double)row[d] * row[d];
+    }
+    return sqrt(sum);
+}
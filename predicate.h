@@ -0,0 +1,109 @@
+/**
+ * @file      : predicate.h
+ * @brief     : Declares the row predicates of 'load <file> where ...' and
+ *              their evaluation against per-chunk zone maps.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#define PREDICATE_MAX_NODES 64   /**< Comparisons plus connectives in one predicate. */
+#define PREDICATE_NORM      -1   /**< Column index that stands for |v|. */
+
+/*
+ * Grammar (keywords are lowercase):
+ *
+ *   predicate  := conjunction { "or" conjunction }
+ *   conjunction:= factor { "and" factor }
+ *   factor     := "not" factor | "(" predicate ")" | comparison
+ *   comparison := operand op number | number op operand
+ *   operand    := x | y | z | w | c<N> | |v|
+ *   op         := < | <= | > | >= | == | !=
+ *
+ * x, y, z and w are components 0 to 3, cN is component N and |v| is the
+ * Euclidean length. Comparisons with NaN are false, as in C.
+ */
+
+/**
+ * @brief How many rows of a chunk can match, judged from its zone map.
+ */
+typedef enum {
+    ZONE_NONE,  /**< No row can match: skip the chunk. */
+    ZONE_SOME,  /**< Some rows may match: test each one. */
+    ZONE_ALL    /**< Every row matches: take them all untested. */
+} zone_match_t;
+
+/**
+ * @brief Minimum and maximum of every column of a chunk, and of |v|.
+ *
+ * A column holding a NaN is widened to [-inf, inf], so the ranges only
+ * ever overstate what the chunk holds and skipping stays safe.
+ */
+typedef struct {
+    const float *min;   /**< Smallest value of each component. */
+    const float *max;   /**< Largest value of each component. */
+    double min_norm;    /**< Smallest |v| (as computed by predicate_norm). */
+    double max_norm;    /**< Largest |v|. */
+} ZoneMap;
+
+/**
+ * @brief One node of a compiled predicate.
+ */
+typedef struct {
+    int kind;       /**< A comparison operator, or an and/or/not connective. */
+    int column;     /**< Component compared, or PREDICATE_NORM. */
+    float value;    /**< Constant compared against. */
+    int left;       /**< First operand node of a connective. */
+    int right;      /**< Second operand node of and/or. */
+} PredicateNode;
+
+/**
+ * @brief A compiled predicate; a plain value, no cleanup needed.
+ */
+typedef struct {
+    PredicateNode nodes[PREDICATE_MAX_NODES];  /**< Nodes, operands before users. */
+    int count;       /**< Nodes in use. */
+    int root;        /**< The node whose value is the predicate's. */
+    int max_column;  /**< Highest component referenced (-1 for none). */
+} Predicate;
+
+/**
+ * @brief Compiles a predicate.
+ * @param predicate Receives the compiled form.
+ * @param text The predicate text (e.g., "x > 0 and |v| < 10").
+ * @return 1 if successful, 0 if the text is malformed (reported on stderr).
+ */
+int predicate_parse(Predicate *predicate, const char *text);
+
+/**
+ * @brief Judges a whole chunk from its zone map.
+ * @param predicate The compiled predicate.
+ * @param zone The chunk's ranges.
+ * @return ZONE_NONE, ZONE_SOME or ZONE_ALL.
+ */
+zone_match_t predicate_zone(const Predicate *predicate, const ZoneMap *zone);
+
+/**
+ * @brief Tests one row.
+ * @param predicate The compiled predicate.
+ * @param row The row's components (at least max_column + 1 of them).
+ * @param dim Number of components in row.
+ * @return 1 if the row matches, 0 otherwise.
+ */
+int predicate_row(const Predicate *predicate, const float *row, int dim);
+
+/**
+ * @brief Computes |v| the way predicates compare it.
+ * @param row The components.
+ * @param dim Number of components.
+ * @return The Euclidean length, accumulated in double precision.
+ */
+double predicate_norm(const float *row, int dim);
+
+#endif /* PREDICATE_H */
@@ -0,0 +1,470 @@
+/**
+ * @file      : reduce.c
+ * @brief     : Defines store-wide reductions (sum, mean, bounds, norms)
+ *              computed with vectorized compensated summation.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "reduce.h"
+#include "pool.h"
+#include "simd.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define REDUCE_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Every kernel accumulates into REDUCE_LANES independent lanes, element i
+ * of a column going to lane i % REDUCE_LANES. AVX holds the lanes in one
+ * register, SSE in two and the scalar fallback in arrays, and all of them
+ * perform the same IEEE operations on each lane, so results match bit for
+ * bit whichever kernel runs.
+ */
+#define REDUCE_LANES 8
+
+/**
+ * @brief Per-lane accumulators for one column of one chunk.
+ * Kahan sums keep the running sum and the negated lost low part.
+ */
+typedef struct {
+    float sum[REDUCE_LANES];
+    float sum_c[REDUCE_LANES];
+    float sq[REDUCE_LANES];
+    float sq_c[REDUCE_LANES];
+    float min[REDUCE_LANES];
+    float max[REDUCE_LANES];
+} ColumnLanes;
+
+/** Signature of the column kernels. */
+typedef void (*column_fn)(const float *v, int n, ColumnLanes *lanes);
+
+/** Signature of the squared-norm maximum kernels. */
+typedef void (*norm_fn)(const float *x, const float *y, const float *z, int n,
+                        float *lanes);
+
+/**
+ * @brief One complete set of kernels for a single instruction set.
+ */
+typedef struct {
+    column_fn column;
+    norm_fn norm;
+} ReduceKernels;
+
+/**
+ * @brief A compensated sum represented as hi + lo.
+ */
+typedef struct {
+    float hi;
+    float lo;
+} CompSum;
+
+/**
+ * @brief Reductions of one chunk, merged pairwise into the final result.
+ */
+typedef struct {
+    int count;
+    CompSum sum[3];
+    CompSum sq[3];
+    float min[3];
+    float max[3];
+    float norm_sq;
+    int norm_slot;
+} ReducePartial;
+
+/* ==================== Kernel Implementations ==================== */
+
+/**
+ * @brief Continues the lane accumulators over elements [from, n).
+ * Also serves as the whole scalar kernel and as the SIMD kernels' tail.
+ * @param v - The column.
+ * @param from - First element to process (a multiple of REDUCE_LANES).
+ * @param n - Number of elements in the column.
+ * @param lanes - Accumulators to update.
+ */
+static void column_tail(const float *v, int from, int n, ColumnLanes *lanes) {
+    for (int i = from; i < n; i++) {
+        int l = i % REDUCE_LANES;
+        float x = v[i];
+        float y = x - lanes->sum_c[l];
+        float t = lanes->sum[l] + y;
+        lanes->sum_c[l] = (t - lanes->sum[l]) - y;
+        lanes->sum[l] = t;
+
+        y = x * x - lanes->sq_c[l];
+        t = lanes->sq[l] + y;
+        lanes->sq_c[l] = (t - lanes->sq[l]) - y;
+        lanes->sq[l] = t;
+
+        lanes->min[l] = x < lanes->min[l] ? x : lanes->min[l];
+        lanes->max[l] = x > lanes->max[l] ? x : lanes->max[l];
+    }
+}
+
+static void scalar_column(const float *v, int n, ColumnLanes *lanes) {
+    column_tail(v, 0, n, lanes);
+}
+
+/**
+ * @brief Continues the squared-norm maxima over elements [from, n).
+ * @param x - x column.
+ * @param y - y column.
+ * @param z - z column.
+ * @param from - First element to process (a multiple of REDUCE_LANES).
+ * @param n - Number of elements.
+ * @param lanes - Per-lane maxima to update.
+ */
+static void norm_tail(const float *x, const float *y, const float *z, int from, int n,
+                      float *lanes) {
+    for (int i = from; i < n; i++) {
+        int l = i % REDUCE_LANES;
+        float norm_sq = (x[i] * x[i] + y[i] * y[i]) + z[i] * z[i];
+        lanes[l] = norm_sq > lanes[l] ? norm_sq : lanes[l];
+    }
+}
+
+static void scalar_norm(const float *x, const float *y, const float *z, int n,
+                        float *lanes) {
+    norm_tail(x, y, z, 0, n, lanes);
+}
+
+static const ReduceKernels scalar_kernels = {scalar_column, scalar_norm};
+
+#ifdef REDUCE_X86
+
+/*
+ * The SSE and AVX kernels are stamped out from the same templates; regs
+ * registers of width floats cover the REDUCE_LANES lanes.
+ */
+#define SIMD_COLUMN(name, isa, type, width, regs, load, store,               \
+                    addp, subp, mulp, minp, maxp)                             \
+    __attribute__((target(isa)))                                             \
+    static void name(const float *v, int n, ColumnLanes *lanes) {             \
+        type sum[regs], sum_c[regs], sq[regs], sq_c[regs], lo[regs], hi[regs];\
+        for (int r = 0; r < regs; r++) {                                      \
+            sum[r] = load(lanes->sum + r * width);                            \
+            sum_c[r] = load(lanes->sum_c + r * width);                        \
+            sq[r] = load(lanes->sq + r * width);                              \
+            sq_c[r] = load(lanes->sq_c + r * width);                          \
+            lo[r] = load(lanes->min + r * width);                             \
+            hi[r] = load(lanes->max + r * width);                             \
+        }                                                                     \
+        int i = 0;                                                            \
+        for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {                    \
+            for (int r = 0; r < regs; r++) {                                  \
+                type x = load(v + i + r * width);                             \
+                type y = subp(x, sum_c[r]);                                   \
+                type t = addp(sum[r], y);                                     \
+                sum_c[r] = subp(subp(t, sum[r]), y);                          \
+                sum[r] = t;                                                   \
+                y = subp(mulp(x, x), sq_c[r]);                                \
+                t = addp(sq[r], y);                                           \
+                sq_c[r] = subp(subp(t, sq[r]), y);                            \
+                sq[r] = t;                                                    \
+                lo[r] = minp(x, lo[r]);                                       \
+                hi[r] = maxp(x, hi[r]);                                       \
+            }                                                                 \
+        }                                                                     \
+        for (int r = 0; r < regs; r++) {                                      \
+            store(lanes->sum + r * width, sum[r]);                            \
+            store(lanes->sum_c + r * width, sum_c[r]);                        \
+            store(lanes->sq + r * width, sq[r]);                              \
+            store(lanes->sq_c + r * width, sq_c[r]);                          \
+            store(lanes->min + r * width, lo[r]);                             \
+            store(lanes->max + r * width, hi[r]);                             \
+        }                                                                     \
+        column_tail(v, i, n, lanes);                                          \
+    }
+
+#define SIMD_NORM(name, isa, type, width, regs, load, store, addp, mulp, maxp)\
+    __attribute__((target(isa)))                                             \
+    static void name(const float *x, const float *y, const float *z, int n,   \
+                     float *lanes) {                                          \
+        type best[regs];                                                      \
+        for (int r = 0; r < regs; r++) {                                      \
+            best[r] = load(lanes + r * width);                                \
+        }                                                                     \
+        int i = 0;                                                            \
+        for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {                    \
+            for (int r = 0; r < regs; r++) {                                  \
+                int at = i + r * width;                                       \
+                type vx = load(x + at);                                       \
+                type vy = load(y + at);                                       \
+                type vz = load(z + at);                                       \
+                type norm_sq = addp(addp(mulp(vx, vx), mulp(vy, vy)),         \
+                                    mulp(vz, vz));                            \
+                best[r] = maxp(norm_sq, best[r]);                             \
+            }                                                                 \
+        }                                                                     \
+        for (int r = 0; r < regs; r++) {                                      \
+            store(lanes + r * width, best[r]);                                \
+        }                                                                     \
+        norm_tail(x, y, z, i, n, lanes);                                      \
+    }
+
+SIMD_COLUMN(sse_column, "sse2", __m128, 4, 2, _mm_loadu_ps, _mm_storeu_ps,
+            _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_min_ps, _mm_max_ps)
+SIMD_NORM(sse_norm, "sse2", __m128, 4, 2, _mm_loadu_ps, _mm_storeu_ps,
+          _mm_add_ps, _mm_mul_ps, _mm_max_ps)
+SIMD_COLUMN(avx_column, "avx", __m256, 8, 1, _mm256_loadu_ps, _mm256_storeu_ps,
+            _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_min_ps, _mm256_max_ps)
+SIMD_NORM(avx_norm, "avx", __m256, 8, 1, _mm256_loadu_ps, _mm256_storeu_ps,
+          _mm256_add_ps, _mm256_mul_ps, _mm256_max_ps)
+
+static const ReduceKernels sse_kernels = {sse_column, sse_norm};
+static const ReduceKernels avx_kernels = {avx_column, avx_norm};
+
+#endif /* REDUCE_X86 */
+
+/**
+ * @brief Picks the widest kernel set the CPU supports.
+ * @return Pointer to the kernel table to use for this process.
+ */
+static const ReduceKernels *kernels(void) {
+#ifdef REDUCE_X86
+    simd_level_t level = simd_level();
+    if (level >= SIMD_AVX) {
+        return &avx_kernels;
+    }
+    if (level >= SIMD_SSE) {
+        return &sse_kernels;
+    }
+#endif
+    return &scalar_kernels;
+}
+
+/* ==================== Combining ==================== */
+
+/**
+ * @brief Adds two compensated sums without losing the rounding error.
+ * @param a - The left sum.
+ * @param b - The right sum.
+ * @return a + b as hi + lo.
+ */
+static CompSum comp_add(CompSum a, CompSum b) {
+    // Knuth's two-sum: s + e == a.hi + b.hi exactly
+    float s = a.hi + b.hi;
+    float bb = s - a.hi;
+    float e = (a.hi - (s - bb)) + (b.hi - bb);
+    CompSum out = {s, (a.lo + b.lo) + e};
+    return out;
+}
+
+/**
+ * @brief Folds eight Kahan lanes into one compensated sum, in lane order.
+ * @param sum - Per-lane running sums.
+ * @param comp - Per-lane negated low parts.
+ * @return The total as hi + lo.
+ */
+static CompSum fold_lanes(const float *sum, const float *comp) {
+    CompSum total = {0.0f, 0.0f};
+    for (int l = 0; l < REDUCE_LANES; l++) {
+        CompSum lane = {sum[l], -comp[l]};
+        total = comp_add(total, lane);
+    }
+    return total;
+}
+
+/**
+ * @brief Merges the partial from into into; the pool_combine_fn.
+ * @param into - The left (lower slots) partial.
+ * @param from - The right partial.
+ */
+static void combine_partials(void *into, const void *from) {
+    ReducePartial *a = into;
+    const ReducePartial *b = from;
+    if (b->count == 0) {
+        return;
+    }
+    if (a->count == 0) {
+        *a = *b;
+        return;
+    }
+    a->count += b->count;
+    for (int c = 0; c < 3; c++) {
+        a->sum[c] = comp_add(a->sum[c], b->sum[c]);
+        a->sq[c] = comp_add(a->sq[c], b->sq[c]);
+        a->min[c] = b->min[c] < a->min[c] ? b->min[c] : a->min[c];
+        a->max[c] = b->max[c] > a->max[c] ? b->max[c] : a->max[c];
+    }
+    // Ties keep the lower slot, which is always on the left
+    if (b->norm_sq > a->norm_sq) {
+        a->norm_sq = b->norm_sq;
+        a->norm_slot = b->norm_slot;
+    }
+}
+
+/* ==================== Chunk Task ==================== */
+
+/**
+ * @brief State shared by the chunk tasks of one reduction.
+ */
+typedef struct {
+    const VectorStore *store;
+    const ReduceKernels *kernels;
+    ReducePartial *partials;
+} ReduceJob;
+
+/**
+ * @brief Reduces one chunk of the store into its partial.
+ * @param context - The ReduceJob.
+ * @param task - Index of the chunk.
+ */
+static void reduce_chunk(void *context, int task) {
+    ReduceJob *job = context;
+    ReducePartial *part = &job->partials[task];
+    int first = task * POOL_CHUNK_VECTORS;
+    int n = job->store->count - first;
+    if (n > POOL_CHUNK_VECTORS) {
+        n = POOL_CHUNK_VECTORS;
+    }
+
+    // Transpose the chunk into columns so the kernels use full-width loads
+    float columns[3][POOL_CHUNK_VECTORS];
+    const vector *v = job->store->vectors + first;
+    for (int i = 0; i < n; i++) {
+        columns[0][i] = v[i].x;
+        columns[1][i] = v[i].y;
+        columns[2][i] = v[i].z;
+    }
+
+    part->count = n;
+    for (int c = 0; c < 3; c++) {
+        ColumnLanes lanes;
+        memset(&lanes, 0, sizeof(lanes));
+        for (int l = 0; l < REDUCE_LANES; l++) {
+            lanes.min[l] = INFINITY;
+            lanes.max[l] = -INFINITY;
+        }
+        job->kernels->column(columns[c], n, &lanes);
+
+        part->sum[c] = fold_lanes(lanes.sum, lanes.sum_c);
+        part->sq[c] = fold_lanes(lanes.sq, lanes.sq_c);
+        part->min[c] = lanes.min[0];
+        part->max[c] = lanes.max[0];
+        for (int l = 1; l < REDUCE_LANES; l++) {
+            part->min[c] = lanes.min[l] < part->min[c] ? lanes.min[l] : part->min[c];
+            part->max[c] = lanes.max[l] > part->max[c] ? lanes.max[l] : part->max[c];
+        }
+    }
+
+    float norms[REDUCE_LANES];
+    for (int l = 0; l < REDUCE_LANES; l++) {
+        norms[l] = -INFINITY;
+    }
+    job->kernels->norm(columns[0], columns[1], columns[2], n, norms);
+    part->norm_sq = norms[0];
+    for (int l = 1; l < REDUCE_LANES; l++) {
+        part->norm_sq = norms[l] > part->norm_sq ? norms[l] : part->norm_sq;
+    }
+    // Recompute norms the same way to find the first vector that reached it
+    part->norm_slot = first;
+    for (int i = 0; i < n; i++) {
+        float norm_sq = (columns[0][i] * columns[0][i] + columns[1][i] * columns[1][i]) +
+                        columns[2][i] * columns[2][i];
+        if (norm_sq == part->norm_sq) {
+            part->norm_slot = first + i;
+            break;
+        }
+    }
+}
+
+/* ==================== Public Interface ==================== */
+
+/**
+ * @brief Reduces the whole store.
+ * @param store - The store to reduce.
+ * @param out - Receives the reductions.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+int reduce_store(VectorStore *store, Reduction *out) {
+    memset(out, 0, sizeof(*out));
+    out->maxnorm_slot = -1;
+    refresh_vectors(store);
+    int chunks = pool_chunks(store->count);
+    if (chunks == 0) {
+        return 1;
+    }
+
+    ReduceJob job;
+    job.store = store;
+    job.kernels = kernels();
+    job.partials = calloc((size_t)chunks, sizeof(ReducePartial));
+    if (!job.partials) {
+        return 0;
+    }
+    pool_run(store->pool, chunks, reduce_chunk, &job);
+    pool_combine_tree(job.partials, chunks, sizeof(ReducePartial), combine_partials);
+
+    const ReducePartial *total = &job.partials[0];
+    float *sum[3] = {&out->sum.x, &out->sum.y, &out->sum.z};
+    float *mean[3] = {&out->mean.x, &out->mean.y, &out->mean.z};
+    float *sumsq[3] = {&out->sumsq.x, &out->sumsq.y, &out->sumsq.z};
+    float *min[3] = {&out->min.x, &out->min.y, &out->min.z};
+    float *max[3] = {&out->max.x, &out->max.y, &out->max.z};
+    for (int c = 0; c < 3; c++) {
+        *sum[c] = total->sum[c].hi + total->sum[c].lo;
+        // Divide the unrounded hi + lo pair in double for the mean
+        *mean[c] = (float)(((double)total->sum[c].hi + total->sum[c].lo) / total->count);
+        *sumsq[c] = total->sq[c].hi + total->sq[c].lo;
+        *min[c] = total->min[c];
+        *max[c] = total->max[c];
+    }
+    out->count = total->count;
+    out->maxnorm = sqrtf(total->norm_sq);
+    out->maxnorm_slot = total->norm_slot;
+    free(job.partials);
+    return 1;
+}
+
+/**
+ * @brief Looks up a reduction by command name.
+ * @param red - The computed reductions.
+ * @param name - "sum", "mean", "sumsq", "min", "max" or "maxnorm".
+ * @param out - Receives the result as a vector.
+ * @return 1 if name is a single-valued reduction, 0 otherwise.
+ */
+int reduction_value(const Reduction *red, const char *name, vector *out) {
+    memset(out, 0, sizeof(*out));
+    if (strcmp(name, "sum") == 0) {
+        *out = red->sum;
+    } else if (strcmp(name, "mean") == 0) {
+        *out = red->mean;
+    } else if (strcmp(name, "sumsq") == 0) {
+        *out = red->sumsq;
+    } else if (strcmp(name, "min") == 0) {
+        *out = red->min;
+    } else if (strcmp(name, "max") == 0) {
+        *out = red->max;
+    } else if (strcmp(name, "maxnorm") == 0) {
+        out->x = red->maxnorm;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Checks whether a word names a reduction command.
+ * @param name - The word to test.
+ * @return 1 for sum, mean, minmax, min, max, maxnorm and sumsq.
+ */
+int is_reduction_name(const char *name) {
+    static const char *const names[] = {
+        "sum", "mean", "minmax", "min", "max", "maxnorm", "sumsq"
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
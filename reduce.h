@@ -0,0 +1,64 @@
+/**
+ * @file      : reduce.h
+ * @brief     : Declares store-wide reductions (sum, mean, bounds, norms)
+ *              computed with vectorized compensated summation.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include "vector.h"
+
+/**
+ * @brief Every reduction of a store, computed together in one pass.
+ * Vector results have no name (their id is left unset).
+ */
+typedef struct {
+    int count;          /**< Number of vectors reduced. */
+    vector sum;         /**< Component-wise sum. */
+    vector mean;        /**< Component-wise mean (centroid). */
+    vector sumsq;       /**< Component-wise sum of squares. */
+    vector min;         /**< Lower corner of the bounding box. */
+    vector max;         /**< Upper corner of the bounding box. */
+    float maxnorm;      /**< Largest vector length. */
+    int maxnorm_slot;   /**< Slot of the (first) longest vector, -1 if empty. */
+} Reduction;
+
+/**
+ * @brief Reduces the whole store.
+ *
+ * Sums use Kahan summation in eight SIMD lanes within each chunk of the
+ * store, and the chunks' compensated results are merged in a fixed
+ * pairwise tree, so the error stays bounded on millions of vectors and
+ * the result is bit-identical for every thread count and instruction set.
+ *
+ * @param store The store to reduce (its worker pool is used if present).
+ * @param out Receives the reductions.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+int reduce_store(VectorStore *store, Reduction *out);
+
+/**
+ * @brief Looks up a reduction by command name.
+ * @param red The computed reductions.
+ * @param name "sum", "mean", "sumsq", "min", "max" or "maxnorm".
+ * @param out Receives the result as a vector; the scalar maxnorm is
+ *            returned in x with y and z set to 0.
+ * @return 1 if name is a single-valued reduction, 0 otherwise.
+ */
+int reduction_value(const Reduction *red, const char *name, vector *out);
+
+/**
+ * @brief Checks whether a word names a reduction command.
+ * @param name The word to test.
+ * @return 1 for sum, mean, minmax, min, max, maxnorm and sumsq.
+ */
+int is_reduction_name(const char *name);
+
+#endif /* REDUCE_H */
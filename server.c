@@ -0,0 +1,380 @@
+/**
+ * @file      : server.c
+ * @brief     : Defines the --serve daemon that shares one vector store
+ *              between clients connected over a Unix domain socket.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#define _POSIX_C_SOURCE 200809L // Needed for sockets, sigaction and pselect under -std=c11
+
+#include "server.h"
+#include "util.h"
+#include "stats.h"
+#include <ctype.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define LINE_TOO_LONG_STATUS 2   /**< Reported like any other syntax error. */
+#define TOO_MANY_CLIENTS_STATUS 4  /**< Reported like running out of memory. */
+
+/**
+ * @brief State shared by the accepting thread and every client thread.
+ */
+typedef struct {
+    VectorStore *store;              /**< The one resident store. */
+    server_command_fn run;           /**< Executes a command. */
+    server_read_fn is_read;          /**< Classifies a command as read-only. */
+    pthread_rwlock_t lock;           /**< Shared for reads, exclusive for writes. */
+    pthread_mutex_t clients_lock;    /**< Guards fds and client_count. */
+    pthread_cond_t clients_done;     /**< Signaled when client_count drops to 0. */
+    int fds[SERVER_MAX_CLIENTS];     /**< Socket of each connected client, or -1. */
+    int client_count;                /**< Number of connected clients. */
+} Server;
+
+/**
+ * @brief One connection, owned by its thread.
+ */
+typedef struct {
+    Server *server;  /**< The server it belongs to. */
+    int fd;        /**< The connected socket. */
+    int slot;      /**< Index of fd in server->fds. */
+} Client;
+
+/** Set by SIGINT / SIGTERM to stop accepting. */
+static volatile sig_atomic_t stop_requested;
+
+/**
+ * @brief Signal handler that asks the accept loop to stop.
+ * @param sig - The signal number (unused).
+ */
+static void request_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+/**
+ * @brief Writes a whole buffer to a socket.
+ * @param fd - The socket.
+ * @param data - The bytes to send.
+ * @param length - Number of bytes.
+ * @return 1 if everything was sent, 0 if the client went away.
+ */
+static int send_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        // MSG_NOSIGNAL: a vanished client is an error here, not a SIGPIPE
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return 0;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 1;
+}
+
+/**
+ * @brief Runs a command under the store's reader-writer lock.
+ *
+ * The command is first classified under the shared lock, since whether it
+ * only reads can depend on state (dirty formulas, cached expressions) that
+ * a writer could change. Reads run right there; anything else drops the
+ * shared lock and runs once the exclusive lock is granted.
+ *
+ * @param server - The server.
+ * @param command - The command line, from its first non-blank character.
+ * @return The command's status.
+ */
+static int run_locked(Server *server, char *command) {
+    pthread_rwlock_rdlock(&server->lock);
+    if (server->is_read(server->store, command)) {
+        int status = server->run(server->store, command);
+        pthread_rwlock_unlock(&server->lock);
+        return status;
+    }
+    pthread_rwlock_unlock(&server->lock);
+
+    pthread_rwlock_wrlock(&server->lock);
+    int status = server->run(server->store, command);
+    pthread_rwlock_unlock(&server->lock);
+    return status;
+}
+
+/**
+ * @brief Runs one line from a client and appends its answer.
+ * @param server - The server.
+ * @param line - The line, without its newline.
+ * @param out - The client's reply buffer (also the thread's output stream).
+ * @return 1 to keep the connection open, 0 after 'quit'.
+ */
+static int answer(Server *server, char *line, FILE *out) {
+    // The command's tokenizer ignores trailing blanks; skip the leading ones
+    while (isspace((unsigned char)*line)) {
+        line++;
+    }
+    if (line[0] == '\0' || line[0] == '#') {
+        return 1;
+    }
+    STATS_START(start);
+    int status = run_locked(server, line);
+    STATS_STOP(STAT_COMMAND, start);
+    if (status < 0) {
+        return 0;
+    }
+    if (status == 0) {
+        fputs("OK\n", out);
+    } else {
+        fprintf(out, "ERR %d\n", status);
+    }
+    return 1;
+}
+
+/**
+ * @brief Client thread body: answers every batch of lines the client sends.
+ *
+ * Each read may carry many commands. All complete lines in it are run in
+ * order with the thread's output pointed at one memory stream, and the
+ * collected answers go back in a single send.
+ *
+ * @param arg - The Client (freed here).
+ * @return NULL.
+ */
+static void *client_main(void *arg) {
+    Client *client = arg;
+    Server *server = client->server;
+    char *buffer = malloc(SERVER_BUFFER_SIZE);
+    size_t used = 0;
+    int open = buffer != NULL;
+
+    while (open) {
+        ssize_t got = read(client->fd, buffer + used, SERVER_BUFFER_SIZE - used);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        used += (size_t)got;
+
+        char *reply = NULL;
+        size_t reply_length = 0;
+        FILE *out = open_memstream(&reply, &reply_length);
+        if (out == NULL) {
+            break;
+        }
+        set_output(out);
+
+        char *line = buffer;
+        char *newline;
+        while (open && (newline = memchr(line, '\n', used - (size_t)(line - buffer))) != NULL) {
+            *newline = '\0';
+            open = answer(server, line, out);
+            line = newline + 1;
+        }
+        size_t rest = used - (size_t)(line - buffer);
+        if (open && rest == SERVER_BUFFER_SIZE) {
+            fprintf(out, "Error: line longer than %d bytes.\nERR %d\n",
+                    SERVER_BUFFER_SIZE, LINE_TOO_LONG_STATUS);
+            open = 0;
+        }
+        memmove(buffer, line, rest);
+        used = rest;
+
+        set_output(NULL);
+        fclose(out);
+        if (!send_all(client->fd, reply, reply_length)) {
+            open = 0;
+        }
+        free(reply);
+    }
+    free(buffer);
+
+    pthread_mutex_lock(&server->clients_lock);
+    server->fds[client->slot] = -1;
+    close(client->fd);
+    if (--server->client_count == 0) {
+        pthread_cond_signal(&server->clients_done);
+    }
+    pthread_mutex_unlock(&server->clients_lock);
+    free(client);
+    return NULL;
+}
+
+/**
+ * @brief Registers a new connection and starts its thread.
+ * @param server - The server.
+ * @param fd - The accepted socket (closed here on failure).
+ */
+static void start_client(Server *server, int fd) {
+    pthread_mutex_lock(&server->clients_lock);
+    int slot = 0;
+    while (slot < SERVER_MAX_CLIENTS && server->fds[slot] >= 0) {
+        slot++;
+    }
+    if (slot == SERVER_MAX_CLIENTS) {
+        pthread_mutex_unlock(&server->clients_lock);
+        char message[64];
+        int length = snprintf(message, sizeof(message), "Error: too many clients.\nERR %d\n",
+                              TOO_MANY_CLIENTS_STATUS);
+        send_all(fd, message, (size_t)length);
+        close(fd);
+        return;
+    }
+
+    Client *client = malloc(sizeof(Client));
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (client != NULL) {
+        client->server = server;
+        client->fd = fd;
+        client->slot = slot;
+        server->fds[slot] = fd;
+        server->client_count++;
+        if (pthread_create(&thread, &attr, client_main, client) != 0) {
+            server->fds[slot] = -1;
+            server->client_count--;
+            free(client);
+            client = NULL;
+        }
+    }
+    pthread_attr_destroy(&attr);
+    pthread_mutex_unlock(&server->clients_lock);
+
+    if (client == NULL) {
+        fprintf(stderr, "Error: could not start a client thread.\n");
+        close(fd);
+    }
+}
+
+/**
+ * @brief Creates the listening socket at path.
+ * @param path - The socket path.
+ * @return The socket, or -1 on error (already reported).
+ */
+static int open_listener(const char *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: socket path '%s' is too long.\n", path);
+        return -1;
+    }
+    // Replace a socket left behind by an earlier run, but nothing else
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "Error: '%s' exists and is not a socket.\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Error: could not listen on '%s': %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Serves the store on a Unix domain socket until SIGINT or SIGTERM.
+ * @param store - The store to serve.
+ * @param path - The socket path.
+ * @param run - Executes one command.
+ * @param is_read - Classifies a command as read-only.
+ * @return 1 after a clean shutdown, 0 if the socket could not be set up.
+ */
+int serve(VectorStore *store, const char *path, server_command_fn run, server_read_fn is_read) {
+    int listener = open_listener(path);
+    if (listener < 0) {
+        return 0;
+    }
+
+    Server server;
+    server.store = store;
+    server.run = run;
+    server.is_read = is_read;
+    server.client_count = 0;
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        server.fds[i] = -1;
+    }
+    pthread_rwlock_init(&server.lock, NULL);
+    pthread_mutex_init(&server.clients_lock, NULL);
+    pthread_cond_init(&server.clients_done, NULL);
+
+    // The stop signals stay blocked (client threads inherit that) except
+    // inside pselect, so only this thread sees them and none is missed
+    sigset_t stop_signals, old_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &old_mask);
+
+    struct sigaction action, old_int, old_term;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_stop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &old_int);
+    sigaction(SIGTERM, &action, &old_term);
+    stop_requested = 0;
+
+    while (!stop_requested) {
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(listener, &ready);
+        if (pselect(listener + 1, &ready, NULL, NULL, NULL, &old_mask) <= 0) {
+            continue;
+        }
+        int fd = accept(listener, NULL, NULL);
+        if (fd >= 0) {
+            start_client(&server, fd);
+        }
+    }
+
+    // Wake every client blocked in read and wait for them to finish
+    pthread_mutex_lock(&server.clients_lock);
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        if (server.fds[i] >= 0) {
+            shutdown(server.fds[i], SHUT_RDWR);
+        }
+    }
+    while (server.client_count > 0) {
+        pthread_cond_wait(&server.clients_done, &server.clients_lock);
+    }
+    pthread_mutex_unlock(&server.clients_lock);
+
+    close(listener);
+    unlink(path);
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    pthread_cond_destroy(&server.clients_done);
+    pthread_mutex_destroy(&server.clients_lock);
+    pthread_rwlock_destroy(&server.lock);
+    return 1;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file      : server.h
+ * @brief     : Declares the --serve daemon that shares one vector store
+ *              between clients connected over a Unix domain socket.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "vector.h"
+
+/*
+ * Protocol: a client sends commands in the REPL's language, one per line.
+ * Every command is answered by its output followed by a line "OK" or
+ * "ERR <status>" (the batch exit statuses: 2 syntax, 3 not found, 4 file
+ * or memory). Blank lines and '#' comments get no answer. A client need
+ * not wait for an answer before sending more; all commands that arrived
+ * in one read are answered with a single write, so a pipelined batch
+ * costs one round trip. A client that pipelines more than a socket
+ * buffer's worth must keep reading answers while it sends. 'quit' closes
+ * the connection.
+ */
+
+#define SERVER_MAX_CLIENTS 256     /**< Connections served at once. */
+#define SERVER_BUFFER_SIZE 65536   /**< Per-client read buffer; also the longest line. */
+
+/**
+ * @brief Runs one command against the store.
+ * @param store The store.
+ * @param command The command line, trimmed (may be modified).
+ * @return 0 on success, a positive status on error, or a negative value
+ * to close the connection.
+ */
+typedef int (*server_command_fn)(VectorStore *store, char *command);
+
+/**
+ * @brief Decides whether a command only reads the store.
+ *
+ * Called with the shared lock held. Returning 1 lets the command run
+ * alongside other readers, so it must be exact: a command that would
+ * modify anything reachable from the store, including caches and
+ * lazily built indexes, must return 0.
+ *
+ * @param store The store.
+ * @param command The command line (may be modified, but must be restored).
+ * @return 1 if the command is read-only, 0 otherwise.
+ */
+typedef int (*server_read_fn)(VectorStore *store, char *command);
+
+/**
+ * @brief Serves the store on a Unix domain socket until SIGINT or SIGTERM.
+ *
+ * Each client runs on its own thread. Read-only commands run in parallel
+ * under the shared side of a reader-writer lock; all others take it
+ * exclusively, so writes are serialized. Command output is captured per
+ * client and sent back over the socket; diagnostics on stderr go to the
+ * server's own stderr.
+ *
+ * @param store The store to serve.
+ * @param path The socket path (an existing socket file there is replaced).
+ * @param run Executes one command.
+ * @param is_read Classifies a command as read-only.
+ * @return 1 after a clean shutdown, 0 if the socket could not be set up.
+ */
+int serve(VectorStore *store, const char *path, server_command_fn run, server_read_fn is_read);
+
+#endif /* SERVER_H */
@@ -0,0 +1,81 @@
+/**
+ * @file      : simd.c
+ * @brief     : Defines runtime detection of the SIMD instruction sets
+ *              available to the vector kernels.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "simd.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *level_names[] = {"scalar", "sse", "avx", "avx2", "avx512"};
+
+/**
+ * @brief Queries the CPU for the highest supported SIMD level.
+ * @return The detected level, SIMD_SCALAR on non-x86 targets.
+ */
+static simd_level_t detect_level(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("avx")) {
+        return SIMD_AVX;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SIMD_SSE;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+/**
+ * @brief Detects the best instruction set supported by the running CPU.
+ *
+ * The first call probes the CPU and applies the optional VECTORCALC_SIMD
+ * cap; later calls return the cached answer. Threads racing on the first
+ * call all compute the same answer, so the cache is a plain atomic.
+ *
+ * @return The highest usable simd_level_t.
+ */
+simd_level_t simd_level(void) {
+    static atomic_int cached = -1;
+    int known = atomic_load_explicit(&cached, memory_order_relaxed);
+    if (known < 0) {
+        simd_level_t level = detect_level();
+        const char *cap = getenv("VECTORCALC_SIMD");
+        if (cap != NULL) {
+            for (int i = SIMD_SCALAR; i <= SIMD_AVX512; i++) {
+                if (strcmp(cap, level_names[i]) == 0 && (simd_level_t)i < level) {
+                    level = (simd_level_t)i;
+                }
+            }
+        }
+        known = (int)level;
+        atomic_store_explicit(&cached, known, memory_order_relaxed);
+    }
+    return (simd_level_t)known;
+}
+
+/**
+ * @brief Returns a printable name for a SIMD level.
+ * @param level - The level to name.
+ * @return A static string such as "avx2".
+ */
+const char *simd_level_name(simd_level_t level) {
+    if (level < SIMD_SCALAR || level > SIMD_AVX512) {
+        return "unknown";
+    }
+    return level_names[level];
+}
@@ -0,0 +1,46 @@
+/**
+ * @file      : simd.h
+ * @brief     : Declares runtime detection of the SIMD instruction sets
+ *              available to the vector kernels.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+/**
+ * @brief Instruction set levels a kernel can be dispatched to,
+ * ordered from least to most capable.
+ */
+typedef enum {
+    SIMD_SCALAR = 0,   /**< Plain C loops, available everywhere. */
+    SIMD_SSE,          /**< 128-bit SSE (baseline on x86-64). */
+    SIMD_AVX,          /**< 256-bit AVX. */
+    SIMD_AVX2,         /**< 256-bit AVX2 with FMA. */
+    SIMD_AVX512        /**< 512-bit AVX-512F. */
+} simd_level_t;
+
+/**
+ * @brief Detects the best instruction set supported by the running CPU.
+ *
+ * The result is computed once and cached. Setting the environment variable
+ * VECTORCALC_SIMD to "scalar", "sse", "avx", "avx2" or "avx512" caps the
+ * level, which is useful for testing the fallback paths.
+ *
+ * @return The highest usable simd_level_t.
+ */
+simd_level_t simd_level(void);
+
+/**
+ * @brief Returns a printable name for a SIMD level.
+ * @param level The level to name.
+ * @return A static string such as "avx2".
+ */
+const char *simd_level_name(simd_level_t level);
+
+#endif /* SIMD_H */
@@ -0,0 +1,270 @@
+/**
+ * @file      : soa.c
+ * @brief     : Defines the structure-of-arrays kernels that update a
+ *              block of 3-D vectors held as x, y and z columns.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "soa.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOA_X86 1
+#include <immintrin.h>
+#endif
+
+/* ==================== Kernel Implementations ==================== */
+
+/** Signature shared by every column kernel; c holds one constant per column. */
+typedef void (*column_fn)(float *x, float *y, float *z, const float *c, int n);
+
+/**
+ * @brief One complete set of kernels for a single instruction set,
+ * indexed by soa_op_t.
+ */
+typedef struct {
+    simd_level_t level;
+    column_fn run[SOA_RCROSS + 1];
+} SoaKernels;
+
+/*
+ * Scalar fallbacks, also used for the tails of the SIMD loops. The
+ * column-wise ones combine each element e with its column's constant k.
+ */
+#define SCALAR_COLUMNWISE(name, expr)                                         \
+    static void name(float *x, float *y, float *z, const float *c, int n) {   \
+        float *columns[3] = {x, y, z};                                        \
+        for (int j = 0; j < 3; j++) {                                         \
+            float *column = columns[j];                                       \
+            float k = c[j];                                                   \
+            for (int i = 0; i < n; i++) {                                     \
+                float e = column[i];                                          \
+                column[i] = (expr);                                           \
+            }                                                                 \
+        }                                                                     \
+    }
+
+SCALAR_COLUMNWISE(scalar_negate, ((void)k, -e))
+SCALAR_COLUMNWISE(scalar_add, e + k)
+SCALAR_COLUMNWISE(scalar_sub, e - k)
+SCALAR_COLUMNWISE(scalar_rsub, k - e)
+SCALAR_COLUMNWISE(scalar_mult, e * k)
+
+// Same association as dot_prod: (x * cx + y * cy) + z * cz
+static void scalar_dot(float *x, float *y, float *z, const float *c, int n) {
+    for (int i = 0; i < n; i++) {
+        x[i] = (x[i] * c[0]) + (y[i] * c[1]) + (z[i] * c[2]);
+        y[i] = 0;
+        z[i] = 0;
+    }
+}
+
+// e x c, as cross_prod(e, c)
+static void scalar_cross(float *x, float *y, float *z, const float *c, int n) {
+    for (int i = 0; i < n; i++) {
+        float ex = x[i], ey = y[i], ez = z[i];
+        x[i] = (ey * c[2]) - (ez * c[1]);
+        y[i] = (ez * c[0]) - (ex * c[2]);
+        z[i] = (ex * c[1]) - (ey * c[0]);
+    }
+}
+
+// c x e, as cross_prod(c, e)
+static void scalar_rcross(float *x, float *y, float *z, const float *c, int n) {
+    for (int i = 0; i < n; i++) {
+        float ex = x[i], ey = y[i], ez = z[i];
+        x[i] = (c[1] * ez) - (c[2] * ey);
+        y[i] = (c[2] * ex) - (c[0] * ez);
+        z[i] = (c[0] * ey) - (c[1] * ex);
+    }
+}
+
+static const SoaKernels scalar_kernels = {
+    SIMD_SCALAR,
+    { scalar_negate, scalar_add, scalar_sub, scalar_rsub, scalar_mult, scalar_dot,
+      scalar_cross, scalar_rcross }
+};
+
+#ifdef SOA_X86
+
+/*
+ * The SSE and AVX kernels are stamped out from the same templates; only
+ * the register type, lane count and intrinsics differ. combine(e, k) is
+ * an intrinsic (or a macro over one) applied to an element register and
+ * its column's constant. Negation flips the sign bit with k = -0.0f,
+ * exactly as unary minus does.
+ */
+#define SIMD_COLUMNWISE(name, isa, type, lanes, load, store, set1, combine, tail) \
+    __attribute__((target(isa)))                                              \
+    static void name(float *x, float *y, float *z, const float *c, int n) {   \
+        float *columns[3] = {x, y, z};                                        \
+        int i = 0;                                                            \
+        for (int j = 0; j < 3; j++) {                                         \
+            float *column = columns[j];                                       \
+            type k = set1(c[j]);                                              \
+            for (i = 0; i + lanes <= n; i += lanes) {                         \
+                store(column + i, combine(load(column + i), k));              \
+            }                                                                 \
+        }                                                                     \
+        tail(x + i, y + i, z + i, c, n - i);                                  \
+    }
+
+#define SIMD_DOT(name, isa, type, lanes, load, store, set1, add, mul, zero)     \
+    __attribute__((target(isa)))                                              \
+    static void name(float *x, float *y, float *z, const float *c, int n) {   \
+        type k0 = set1(c[0]), k1 = set1(c[1]), k2 = set1(c[2]);               \
+        int i = 0;                                                            \
+        for (; i + lanes <= n; i += lanes) {                                  \
+            type d = add(add(mul(load(x + i), k0), mul(load(y + i), k1)),     \
+                         mul(load(z + i), k2));                               \
+            store(x + i, d);                                                  \
+            store(y + i, zero());                                             \
+            store(z + i, zero());                                             \
+        }                                                                     \
+        scalar_dot(x + i, y + i, z + i, c, n - i);                            \
+    }
+
+/* a and b name the left and right operands: e (the element) or k (c) */
+#define SIMD_CROSS(name, isa, type, lanes, load, store, set1, sub, mul, a, b, tail) \
+    __attribute__((target(isa)))                                              \
+    static void name(float *x, float *y, float *z, const float *c, int n) {   \
+        type k0 = set1(c[0]), k1 = set1(c[1]), k2 = set1(c[2]);               \
+        int i = 0;                                                            \
+        for (; i + lanes <= n; i += lanes) {                                  \
+            type e0 = load(x + i), e1 = load(y + i), e2 = load(z + i);        \
+            store(x + i, sub(mul(a##1, b##2), mul(a##2, b##1)));              \
+            store(y + i, sub(mul(a##2, b##0), mul(a##0, b##2)));              \
+            store(z + i, sub(mul(a##0, b##1), mul(a##1, b##0)));              \
+        }                                                                     \
+        tail(x + i, y + i, z + i, c, n - i);                                  \
+    }
+
+#define SSE_NEGATE(e, k)     _mm_xor_ps(e, k)
+#define SSE_RSUB(e, k)       _mm_sub_ps(k, e)
+#define AVX_NEGATE(e, k)     _mm256_xor_ps(e, k)
+#define AVX_RSUB(e, k)       _mm256_sub_ps(k, e)
+
+#define SSE_ARGS  __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps
+#define AVX_ARGS  __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps
+
+/* Expands the ISA argument list before the template sees it */
+#define EXPAND(template, ...) template(__VA_ARGS__)
+
+EXPAND(SIMD_COLUMNWISE, sse_negate, "sse2", SSE_ARGS, SSE_NEGATE, scalar_negate)
+EXPAND(SIMD_COLUMNWISE, sse_add, "sse2", SSE_ARGS, _mm_add_ps, scalar_add)
+EXPAND(SIMD_COLUMNWISE, sse_sub, "sse2", SSE_ARGS, _mm_sub_ps, scalar_sub)
+EXPAND(SIMD_COLUMNWISE, sse_rsub, "sse2", SSE_ARGS, SSE_RSUB, scalar_rsub)
+EXPAND(SIMD_COLUMNWISE, sse_mult, "sse2", SSE_ARGS, _mm_mul_ps, scalar_mult)
+EXPAND(SIMD_DOT, sse_dot, "sse2", SSE_ARGS, _mm_add_ps, _mm_mul_ps, _mm_setzero_ps)
+EXPAND(SIMD_CROSS, sse_cross, "sse2", SSE_ARGS, _mm_sub_ps, _mm_mul_ps, e, k, scalar_cross)
+EXPAND(SIMD_CROSS, sse_rcross, "sse2", SSE_ARGS, _mm_sub_ps, _mm_mul_ps, k, e, scalar_rcross)
+
+EXPAND(SIMD_COLUMNWISE, avx_negate, "avx", AVX_ARGS, AVX_NEGATE, scalar_negate)
+EXPAND(SIMD_COLUMNWISE, avx_add, "avx", AVX_ARGS, _mm256_add_ps, scalar_add)
+EXPAND(SIMD_COLUMNWISE, avx_sub, "avx", AVX_ARGS, _mm256_sub_ps, scalar_sub)
+EXPAND(SIMD_COLUMNWISE, avx_rsub, "avx", AVX_ARGS, AVX_RSUB, scalar_rsub)
+EXPAND(SIMD_COLUMNWISE, avx_mult, "avx", AVX_ARGS, _mm256_mul_ps, scalar_mult)
+EXPAND(SIMD_DOT, avx_dot, "avx", AVX_ARGS, _mm256_add_ps, _mm256_mul_ps, _mm256_setzero_ps)
+EXPAND(SIMD_CROSS, avx_cross, "avx", AVX_ARGS, _mm256_sub_ps, _mm256_mul_ps, e, k,
+       scalar_cross)
+EXPAND(SIMD_CROSS, avx_rcross, "avx", AVX_ARGS, _mm256_sub_ps, _mm256_mul_ps, k, e,
+       scalar_rcross)
+
+static const SoaKernels sse_kernels = {
+    SIMD_SSE,
+    { sse_negate, sse_add, sse_sub, sse_rsub, sse_mult, sse_dot, sse_cross, sse_rcross }
+};
+
+static const SoaKernels avx_kernels = {
+    SIMD_AVX,
+    { avx_negate, avx_add, avx_sub, avx_rsub, avx_mult, avx_dot, avx_cross, avx_rcross }
+};
+
+#endif /* SOA_X86 */
+
+/**
+ * @brief Picks the widest kernel set the CPU supports.
+ * @return Pointer to the kernel table to use for this process.
+ */
+static const SoaKernels *kernels(void) {
+#ifdef SOA_X86
+    simd_level_t level = simd_level();
+    if (level >= SIMD_AVX) {
+        return &avx_kernels;
+    }
+    if (level >= SIMD_SSE) {
+        return &sse_kernels;
+    }
+#endif
+    return &scalar_kernels;
+}
+
+/* ==================== Public Interface ==================== */
+
+/**
+ * @brief Copies vectors into columns.
+ * @param vectors - The records to read.
+ * @param slots - Positions of the records to take, or NULL for the first n.
+ * @param n - Number of vectors.
+ * @param x - Receives the x components.
+ * @param y - Receives the y components.
+ * @param z - Receives the z components.
+ */
+void soa_gather(const vector *vectors, const int *slots, int n, float *x, float *y, float *z) {
+    for (int i = 0; i < n; i++) {
+        const vector *v = &vectors[slots ? slots[i] : i];
+        x[i] = v->x;
+        y[i] = v->y;
+        z[i] = v->z;
+    }
+}
+
+/**
+ * @brief Copies columns back into vectors, leaving their name ids alone.
+ * @param vectors - The records to write.
+ * @param slots - Positions of the records, as given to soa_gather, or NULL.
+ * @param n - Number of vectors.
+ * @param x - The x components.
+ * @param y - The y components.
+ * @param z - The z components.
+ */
+void soa_scatter(vector *vectors, const int *slots, int n, const float *x, const float *y,
+                 const float *z) {
+    for (int i = 0; i < n; i++) {
+        vector *v = &vectors[slots ? slots[i] : i];
+        v->x = x[i];
+        v->y = y[i];
+        v->z = z[i];
+    }
+}
+
+/**
+ * @brief Applies one operation to every element of the columns in place.
+ * @param op - The operation.
+ * @param c - The constant operand (for SOA_MULT, c.x is the scale factor).
+ * @param x - The x column.
+ * @param y - The y column.
+ * @param z - The z column.
+ * @param n - Number of elements.
+ */
+void soa_apply(soa_op_t op, vector c, float *x, float *y, float *z, int n) {
+    float k[3] = {c.x, c.y, c.z};
+    if (op == SOA_MULT) {
+        k[1] = k[2] = c.x;
+    } else if (op == SOA_NEGATE) {
+        k[0] = k[1] = k[2] = -0.0f;
+    }
+    kernels()->run[op](x, y, z, k, n);
+}
+
+/**
+ * @brief Returns the instruction set the kernels dispatch to.
+ * @return The simd_level_t chosen at runtime.
+ */
+simd_level_t soa_kernel_level(void) {
+    return kernels()->level;
+}
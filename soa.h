@@ -0,0 +1,83 @@
+/**
+ * @file      : soa.h
+ * @brief     : Declares the structure-of-arrays kernels that update a
+ *              block of 3-D vectors held as x, y and z columns.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef SOA_H
+#define SOA_H
+
+#include "vector.h"
+#include "simd.h"
+
+/*
+ * The store keeps 3-D vectors as records, so a whole-store update takes
+ * a block of them apart into one column per component (soa_gather), runs
+ * one kernel over full-width loads, and puts the results back
+ * (soa_scatter). Every kernel performs the same IEEE operations per
+ * element as the scalar functions in vector.c (no FMA), so the results
+ * are identical for any instruction set.
+ */
+
+/**
+ * @brief Element-wise updates of a block against one constant operand c
+ * (or the scale factor s).
+ */
+typedef enum {
+    SOA_NEGATE,    /**< e = -e */
+    SOA_ADD,       /**< e = e + c */
+    SOA_SUB,       /**< e = e - c */
+    SOA_RSUB,      /**< e = c - e */
+    SOA_MULT,      /**< e = s * e */
+    SOA_DOT,       /**< e = (e . c, 0, 0) */
+    SOA_CROSS,     /**< e = e x c */
+    SOA_RCROSS     /**< e = c x e */
+} soa_op_t;
+
+/**
+ * @brief Copies vectors into columns.
+ * @param vectors The records to read.
+ * @param slots Positions of the records to take, or NULL for the first n.
+ * @param n Number of vectors.
+ * @param x Receives the x components.
+ * @param y Receives the y components.
+ * @param z Receives the z components.
+ */
+void soa_gather(const vector *vectors, const int *slots, int n, float *x, float *y, float *z);
+
+/**
+ * @brief Copies columns back into vectors, leaving their name ids alone.
+ * @param vectors The records to write.
+ * @param slots Positions of the records, as given to soa_gather, or NULL.
+ * @param n Number of vectors.
+ * @param x The x components.
+ * @param y The y components.
+ * @param z The z components.
+ */
+void soa_scatter(vector *vectors, const int *slots, int n, const float *x, const float *y,
+                 const float *z);
+
+/**
+ * @brief Applies one operation to every element of the columns in place.
+ * @param op The operation.
+ * @param c The constant operand (for SOA_MULT, c.x is the scale factor).
+ * @param x The x column.
+ * @param y The y column.
+ * @param z The z column.
+ * @param n Number of elements.
+ */
+void soa_apply(soa_op_t op, vector c, float *x, float *y, float *z, int n);
+
+/**
+ * @brief Returns the instruction set the kernels dispatch to.
+ * @return The simd_level_t chosen at runtime (AVX, SSE or scalar).
+ */
+simd_level_t soa_kernel_level(void);
+
+#endif /* SOA_H */
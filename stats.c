@@ -0,0 +1,204 @@
+/**
+ * @file      : stats.c
+ * @brief     : Defines the latency histograms and counters behind the
+ *              'stats' command and the --stats-json exit dump.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "stats.h"
+#include "util.h"
+#include <stdatomic.h>
+#include <time.h>
+
+/**
+ * @brief A log-bucketed latency histogram.
+ *
+ * A time of t ns lands in bucket floor(log2(t)) + 1 (0 ns in bucket 0),
+ * so bucket i covers [2^(i-1), 2^i) ns and percentiles are reported as
+ * the upper bound of their bucket, within a factor of two.
+ */
+typedef struct {
+    atomic_uint_fast64_t buckets[STATS_BUCKETS];
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t total_ns;
+    atomic_uint_fast64_t max_ns;
+} Histogram;
+
+static Histogram histograms[STAT_METRICS];
+static atomic_uint_fast64_t counters[STAT_COUNTERS];
+
+#ifdef VECTORCALC_STATS
+static const char *metric_names[STAT_METRICS] = {
+    "command", "find", "grow", "load", "save", "expr"
+};
+
+static const char *counter_names[STAT_COUNTERS] = {
+    "find_misses", "expr_errors"
+};
+#endif /* VECTORCALC_STATS */
+
+/**
+ * @brief Reads the monotonic clock.
+ * @return Nanoseconds since an arbitrary fixed point.
+ */
+uint64_t stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Finds the histogram bucket of a time.
+ * @param ns - The time in nanoseconds.
+ * @return The bucket index.
+ */
+static int bucket_of(uint64_t ns) {
+    return ns == 0 ? 0 : 64 - __builtin_clzll(ns);
+}
+
+/**
+ * @brief Adds one timing to a metric's histogram.
+ * @param metric - The metric timed.
+ * @param ns - The elapsed time in nanoseconds.
+ */
+void stats_record(stat_metric_t metric, uint64_t ns) {
+    Histogram *h = &histograms[metric];
+    int bucket = bucket_of(ns);
+    if (bucket >= STATS_BUCKETS) {
+        bucket = STATS_BUCKETS - 1;
+    }
+    atomic_fetch_add_explicit(&h->buckets[bucket], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->total_ns, ns, memory_order_relaxed);
+    uint_fast64_t max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak_explicit(&h->max_ns, &max, ns,
+                                                              memory_order_relaxed,
+                                                              memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Adds to an event counter.
+ * @param counter - The counter.
+ * @param n - The amount to add.
+ */
+void stats_count(stat_counter_t counter, uint64_t n) {
+    atomic_fetch_add_explicit(&counters[counter], n, memory_order_relaxed);
+}
+
+/**
+ * @brief Clears every histogram and counter.
+ */
+void stats_reset(void) {
+    for (int m = 0; m < STAT_METRICS; m++) {
+        for (int b = 0; b < STATS_BUCKETS; b++) {
+            atomic_store(&histograms[m].buckets[b], 0);
+        }
+        atomic_store(&histograms[m].count, 0);
+        atomic_store(&histograms[m].total_ns, 0);
+        atomic_store(&histograms[m].max_ns, 0);
+    }
+    for (int c = 0; c < STAT_COUNTERS; c++) {
+        atomic_store(&counters[c], 0);
+    }
+}
+
+#ifdef VECTORCALC_STATS
+/**
+ * @brief Estimates a percentile from a histogram.
+ * @param h - The histogram.
+ * @param fraction - The percentile as a fraction (e.g., 0.99).
+ * @return The upper bound of the bucket holding that percentile, in ns,
+ * capped at the largest time recorded.
+ */
+static uint64_t percentile(const Histogram *h, double fraction) {
+    uint64_t count = atomic_load(&h->count);
+    uint64_t max = atomic_load(&h->max_ns);
+    uint64_t rank = (uint64_t)(fraction * (double)count);
+    uint64_t seen = 0;
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        seen += atomic_load(&h->buckets[b]);
+        if (seen > rank) {
+            uint64_t bound = b == 0 ? 0 : ((uint64_t)1 << b) - 1;
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+#endif /* VECTORCALC_STATS */
+
+/**
+ * @brief Prints a table of every metric and the counters.
+ */
+void stats_print(void) {
+#ifdef VECTORCALC_STATS
+    out_printf("%-8s %10s %12s %10s %10s %10s %10s\n",
+           "metric", "count", "total ms", "mean us", "p50 us", "p99 us", "max us");
+    for (int m = 0; m < STAT_METRICS; m++) {
+        const Histogram *h = &histograms[m];
+        uint64_t count = atomic_load(&h->count);
+        uint64_t total = atomic_load(&h->total_ns);
+        out_printf("%-8s %10llu %12.3f %10.3f %10.3f %10.3f %10.3f\n", metric_names[m],
+               (unsigned long long)count, (double)total / 1e6,
+               count ? (double)total / (double)count / 1e3 : 0.0,
+               (double)percentile(h, 0.50) / 1e3, (double)percentile(h, 0.99) / 1e3,
+               (double)atomic_load(&h->max_ns) / 1e3);
+    }
+    for (int c = 0; c < STAT_COUNTERS; c++) {
+        out_printf("%-12s %llu\n", counter_names[c], (unsigned long long)atomic_load(&counters[c]));
+    }
+#else
+    out_printf("Statistics were compiled out; rebuild with 'make STATS=1'.\n");
+#endif
+}
+
+/**
+ * @brief Writes every metric and counter as one JSON object.
+ * @param out - The stream to write to.
+ * @return 1 if the object was written, 0 on a write error.
+ */
+int stats_write_json(FILE *out) {
+#ifdef VECTORCALC_STATS
+    fprintf(out, "{\"enabled\": true, \"metrics\": {");
+    for (int m = 0; m < STAT_METRICS; m++) {
+        const Histogram *h = &histograms[m];
+        fprintf(out, "%s\n  \"%s\": {\"count\": %llu, \"total_ns\": %llu, \"max_ns\": %llu, "
+                "\"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"buckets\": [",
+                m ? "," : "", metric_names[m],
+                (unsigned long long)atomic_load(&h->count),
+                (unsigned long long)atomic_load(&h->total_ns),
+                (unsigned long long)atomic_load(&h->max_ns),
+                (unsigned long long)percentile(h, 0.50),
+                (unsigned long long)percentile(h, 0.90),
+                (unsigned long long)percentile(h, 0.99));
+        // Each non-empty bucket as [upper bound in ns, count]
+        int first = 1;
+        for (int b = 0; b < STATS_BUCKETS; b++) {
+            uint64_t n = atomic_load(&h->buckets[b]);
+            if (n > 0) {
+                fprintf(out, "%s[%llu, %llu]", first ? "" : ", ",
+                        (unsigned long long)(b == 0 ? 0 : ((uint64_t)1 << b) - 1),
+                        (unsigned long long)n);
+                first = 0;
+            }
+        }
+        fprintf(out, "]}");
+    }
+    fprintf(out, "\n}, \"counters\": {");
+    for (int c = 0; c < STAT_COUNTERS; c++) {
+        fprintf(out, "%s\"%s\": %llu", c ? ", " : "", counter_names[c],
+                (unsigned long long)atomic_load(&counters[c]));
+    }
+    fprintf(out, "}}\n");
+#else
+    fprintf(out, "{\"enabled\": false}\n");
+#endif
+    return !ferror(out);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file      : stats.h
+ * @brief     : Declares the latency histograms and counters behind the
+ *              'stats' command and the --stats-json exit dump.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Instrumentation is compiled in only when VECTORCALC_STATS is defined
+ * ('make debug' or 'make STATS=1'; the default build leaves it out). When
+ * it is not, every STATS_* macro expands to nothing, so instrumented code
+ * pays no cost at all.
+ */
+
+#define STATS_BUCKETS 64   /**< Latency bucket i holds times below 2^i ns. */
+
+/**
+ * @brief Timed operations, each with its own latency histogram.
+ */
+typedef enum {
+    STAT_COMMAND,      /**< One REPL command, dispatch to completion. */
+    STAT_FIND,         /**< A vector lookup by name. */
+    STAT_GROW,         /**< Growing the store's committed capacity. */
+    STAT_LOAD,         /**< load_vectors (CSV or vbin). */
+    STAT_SAVE,         /**< save_vectors (CSV or vbin). */
+    STAT_EXPR,         /**< Evaluating a compiled expression. */
+    STAT_METRICS       /**< Number of metrics. */
+} stat_metric_t;
+
+/**
+ * @brief Event counters that have no latency.
+ */
+typedef enum {
+    STAT_FIND_MISSES,  /**< Lookups of names with no stored vector. */
+    STAT_EXPR_ERRORS,  /**< Evaluations that failed (e.g., missing operand). */
+    STAT_COUNTERS      /**< Number of counters. */
+} stat_counter_t;
+
+#ifdef VECTORCALC_STATS
+
+/** Starts a timer named var. */
+#define STATS_START(var) uint64_t var = stats_now()
+/** Records the time since STATS_START(var) under metric. */
+#define STATS_STOP(metric, var) stats_record((metric), stats_now() - (var))
+/** Adds n to counter. */
+#define STATS_COUNT(counter, n) stats_count((counter), (n))
+
+#else
+
+#define STATS_START(var)
+#define STATS_STOP(metric, var)
+#define STATS_COUNT(counter, n)
+
+#endif /* VECTORCALC_STATS */
+
+/**
+ * @brief Reads the monotonic clock.
+ * @return Nanoseconds since an arbitrary fixed point.
+ */
+uint64_t stats_now(void);
+
+/**
+ * @brief Adds one timing to a metric's histogram.
+ *
+ * Safe to call from several threads; each update is a relaxed atomic add
+ * to a single bucket, so recording never takes a lock.
+ *
+ * @param metric The metric timed.
+ * @param ns The elapsed time in nanoseconds.
+ */
+void stats_record(stat_metric_t metric, uint64_t ns);
+
+/**
+ * @brief Adds to an event counter.
+ * @param counter The counter.
+ * @param n The amount to add.
+ */
+void stats_count(stat_counter_t counter, uint64_t n);
+
+/**
+ * @brief Clears every histogram and counter.
+ */
+void stats_reset(void);
+
+/**
+ * @brief Prints a table of every metric (count, total, mean, p50, p99,
+ * max) and the counters, or a note if statistics were compiled out.
+ */
+void stats_print(void);
+
+/**
+ * @brief Writes every metric, with its non-empty buckets, and the counters
+ * as one JSON object.
+ * @param out The stream to write to.
+ * @return 1 if the object was written, 0 on a write error.
+ */
+int stats_write_json(FILE *out);
+
+#endif /* STATS_H */
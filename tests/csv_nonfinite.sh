@@ -0,0 +1,27 @@
+#!/bin/sh
+# Saves a store holding inf and nan components to CSV, loads it back and
+# saves it again. Every vector must survive and both files must match.
+#
+# Usage: tests/csv_nonfinite.sh [path/to/vectorcalc]
+
+BIN=$(cd "$(dirname "${1:-./vectorcalc}")" && pwd)/$(basename "${1:-./vectorcalc}")
+DIR=$(mktemp -d) || exit 1
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR" || exit 1
+
+fail() {
+    echo "FAIL: $1"
+    exit 1
+}
+
+printf 'a = 3e38 1 1\nb = a * 10\nc = b - b\nd = b * -1\nsave first.csv\n' |
+    "$BIN" -b > /dev/null || fail "could not save the store"
+
+out=$(printf 'load first.csv\nsave second.csv\n' | "$BIN" -b 2>&1) ||
+    fail "could not reload the store: $out"
+case "$out" in
+    *[Mm]alformed*) fail "lines were skipped on reload: $out" ;;
+esac
+[ "$(wc -l < second.csv)" -eq 4 ] || fail "vectors were lost: $(cat second.csv)"
+cmp -s first.csv second.csv || fail "reloaded values differ: $(cat first.csv second.csv)"
+echo "PASS: csv_nonfinite"
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Replays a journal left by a crash inside 'compact': the new snapshot was
+# renamed into place but the old log was never emptied, so the log still
+# deletes a vector the snapshot no longer has. Opening it must succeed.
+#
+# Usage: tests/journal_crash.sh [path/to/vectorcalc]
+
+BIN=$(cd "$(dirname "${1:-./vectorcalc}")" && pwd)/$(basename "${1:-./vectorcalc}")
+DIR=$(mktemp -d) || exit 1
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR" || exit 1
+
+fail() {
+    echo "FAIL: $1"
+    exit 1
+}
+
+# Snapshot {a, b}, then a logged delete of a
+printf 'journal j\na = 1 2 3\nb = 4 5 6\ncompact\ndelete a\n' | "$BIN" -b -q > /dev/null ||
+    fail "could not build the journal"
+cp j.log stale.log
+
+# Compact, then put the stale log back as the crash would have left it
+printf 'journal j\ncompact\n' | "$BIN" -b -q > /dev/null || fail "compact failed"
+cp stale.log j.log
+
+out=$(printf 'journal j\nlist\n' | "$BIN" -b 2>&1) || fail "journal could not be reopened: $out"
+case "$out" in
+    *"a = "*) fail "deleted vector came back: $out" ;;
+esac
+case "$out" in
+    *"b = 4.00  5.00  6.00"*) ;;
+    *) fail "vector b is missing: $out" ;;
+esac
+echo "PASS: journal_crash"
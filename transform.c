@@ -0,0 +1,577 @@
+/**
+ * @file      : transform.c
+ * @brief     : Defines named 3x3 / 4x4 matrices and quaternions, and the
+ *              batched kernels that apply them to stored vectors.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "transform.h"
+#include "bulk.h"
+#include "pool.h"
+#include "util.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TRANSFORM_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief The named transforms of a store, searched linearly (a session
+ * holds a handful of them, and each lookup is once per command).
+ */
+struct TransformSet {
+    char **names;          /**< Name of each transform. */
+    Transform *items;      /**< The transforms. */
+    int count;             /**< Number of transforms stored. */
+    int capacity;          /**< Allocated entries. */
+};
+
+/* ==================== Kernel Implementations ==================== */
+
+/*
+ * The kernels take the affine part of the matrix as four columns of four
+ * floats: the x, y and z columns and the translation, each with a zero in
+ * the fourth lane. A record is x, y, z and its name id, so a whole record
+ * fits one 128-bit lane: x, y and z are splatted across the lane, the
+ * columns are multiplied and added in the same order the scalar code
+ * uses, and the id lane is copied back from the input unchanged.
+ */
+
+/** Signature of the affine batch kernels. */
+typedef void (*affine_fn)(const float *cols, vector *v, int n);
+
+/**
+ * @brief One affine kernel for a single instruction set.
+ */
+typedef struct {
+    simd_level_t level;
+    affine_fn affine;
+} TransformKernels;
+
+// Scalar fallback, also used for the tails of the SIMD loops and for
+// single vectors, so every path rounds the same way
+static void scalar_affine(const float *c, vector *v, int n) {
+    for (int i = 0; i < n; i++) {
+        float x = v[i].x;
+        float y = v[i].y;
+        float z = v[i].z;
+        v[i].x = c[0] * x + c[4] * y + c[8] * z + c[12];
+        v[i].y = c[1] * x + c[5] * y + c[9] * z + c[13];
+        v[i].z = c[2] * x + c[6] * y + c[10] * z + c[14];
+    }
+}
+
+static const TransformKernels scalar_kernels = { SIMD_SCALAR, scalar_affine };
+
+#ifdef TRANSFORM_X86
+
+/*
+ * The SSE, AVX and AVX-512 kernels are stamped out from one template;
+ * per is the number of records a register holds, bcast copies a column
+ * into every 128-bit lane, splat copies one component across each lane
+ * and keep_id restores the fourth float of every lane from the input.
+ */
+#define SIMD_AFFINE(name, isa, type, per, load, store, bcast, splat, mul, add, keep_id) \
+    __attribute__((target(isa)))                                                   \
+    static void name(const float *c, vector *v, int n) {                           \
+        type c0 = bcast(c);                                                        \
+        type c1 = bcast(c + 4);                                                    \
+        type c2 = bcast(c + 8);                                                    \
+        type t = bcast(c + 12);                                                    \
+        int i = 0;                                                                 \
+        for (; i + per <= n; i += per) {                                           \
+            float *p = &v[i].x;                                                    \
+            type r = load(p);                                                      \
+            type o = mul(c0, splat(r, 0x00));                                      \
+            o = add(o, mul(c1, splat(r, 0x55)));                                   \
+            o = add(o, mul(c2, splat(r, 0xAA)));                                   \
+            o = add(o, t);                                                         \
+            store(p, keep_id(o, r));                                               \
+        }                                                                          \
+        scalar_affine(c, v + i, n - i);                                            \
+    }
+
+#define SSE_SPLAT(r, imm)    _mm_shuffle_ps(r, r, imm)
+#define SSE_KEEP_ID(o, r)    _mm_or_ps(_mm_andnot_ps(SSE_ID_MASK, o), _mm_and_ps(SSE_ID_MASK, r))
+#define SSE_ID_MASK          _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0))
+#define AVX_BCAST(c)         _mm256_broadcast_ps((const __m128 *)(c))
+#define AVX_KEEP_ID(o, r)    _mm256_blend_ps(o, r, 0x88)
+#define AVX512_BCAST(c)      _mm512_broadcast_f32x4(_mm_loadu_ps(c))
+#define AVX512_KEEP_ID(o, r) _mm512_mask_blend_ps(0x8888, o, r)
+
+SIMD_AFFINE(sse_affine, "sse2", __m128, 1, _mm_loadu_ps, _mm_storeu_ps, _mm_loadu_ps,
+            SSE_SPLAT, _mm_mul_ps, _mm_add_ps, SSE_KEEP_ID)
+SIMD_AFFINE(avx_affine, "avx", __m256, 2, _mm256_loadu_ps, _mm256_storeu_ps, AVX_BCAST,
+            _mm256_permute_ps, _mm256_mul_ps, _mm256_add_ps, AVX_KEEP_ID)
+SIMD_AFFINE(avx512_affine, "avx512f", __m512, 4, _mm512_loadu_ps, _mm512_storeu_ps,
+            AVX512_BCAST, _mm512_permute_ps, _mm512_mul_ps, _mm512_add_ps, AVX512_KEEP_ID)
+
+static const TransformKernels sse_kernels = { SIMD_SSE, sse_affine };
+static const TransformKernels avx_kernels = { SIMD_AVX, avx_affine };
+static const TransformKernels avx512_kernels = { SIMD_AVX512, avx512_affine };
+
+#endif /* TRANSFORM_X86 */
+
+/**
+ * @brief Picks the widest kernel the CPU supports.
+ * @return Pointer to the kernel table to use for this process.
+ */
+static const TransformKernels *kernels(void) {
+#ifdef TRANSFORM_X86
+    simd_level_t level = simd_level();
+    if (level >= SIMD_AVX512) {
+        return &avx512_kernels;
+    }
+    if (level >= SIMD_AVX) {
+        return &avx_kernels;
+    }
+    if (level >= SIMD_SSE) {
+        return &sse_kernels;
+    }
+#endif
+    return &scalar_kernels;
+}
+
+/**
+ * @brief Extracts the column layout the kernels take from a matrix.
+ * @param t - The transform.
+ * @param cols - Receives 16 floats: x, y, z columns and translation.
+ */
+static void affine_columns(const Transform *t, float *cols) {
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 3; row++) {
+            cols[col * 4 + row] = t->m[row * 4 + col];
+        }
+        cols[col * 4 + 3] = 0.0f;
+    }
+}
+
+/**
+ * @brief Applies a transform to one vector using precomputed columns.
+ * @param t - The transform.
+ * @param cols - The affine columns of t.
+ * @param v - The vector (its name id is kept).
+ * @return The transformed vector.
+ */
+static vector apply_one(const Transform *t, const float *cols, vector v) {
+    float x = v.x;
+    float y = v.y;
+    float z = v.z;
+    scalar_affine(cols, &v, 1);
+    if (t->projective) {
+        const float *m = t->m;
+        float w = m[12] * x + m[13] * y + m[14] * z + m[15];
+        v.x /= w;
+        v.y /= w;
+        v.z /= w;
+    }
+    return v;
+}
+
+/* ==================== Construction ==================== */
+
+/**
+ * @brief Fills the rotation matrix of a unit quaternion.
+ * @param t - The transform; t->q must already be normalized.
+ */
+static void quat_matrix(Transform *t) {
+    float w = t->q[0];
+    float x = t->q[1];
+    float y = t->q[2];
+    float z = t->q[3];
+    float *m = t->m;
+
+    memset(m, 0, 16 * sizeof(float));
+    m[0] = 1 - 2 * (y * y + z * z);
+    m[1] = 2 * (x * y - w * z);
+    m[2] = 2 * (x * z + w * y);
+    m[4] = 2 * (x * y + w * z);
+    m[5] = 1 - 2 * (x * x + z * z);
+    m[6] = 2 * (y * z - w * x);
+    m[8] = 2 * (x * z - w * y);
+    m[9] = 2 * (y * z + w * x);
+    m[10] = 1 - 2 * (x * x + y * y);
+    m[15] = 1;
+    t->projective = 0;
+}
+
+/**
+ * @brief Scales a quaternion to unit length.
+ * @param q - The quaternion w, x, y, z.
+ * @return 1 if successful, 0 if q is zero.
+ */
+static int quat_normalize(float *q) {
+    float length = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if (length == 0.0f) {
+        return 0;
+    }
+    for (int i = 0; i < 4; i++) {
+        q[i] /= length;
+    }
+    return 1;
+}
+
+/**
+ * @brief Checks whether text is a transform literal.
+ * @param text - The right-hand side of an assignment.
+ * @return 1 if text starts with the keyword mat3, mat4 or quat.
+ */
+int is_transform_literal(const char *text) {
+    static const char *keywords[] = { "mat3", "mat4", "quat" };
+    for (int i = 0; i < 3; i++) {
+        size_t length = strlen(keywords[i]);
+        if (strncmp(text, keywords[i], length) == 0 &&
+            (text[length] == '\0' || isspace((unsigned char)text[length]))) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses a transform literal.
+ * @param text - The literal (e.g., "mat3 1 0 0 0 1 0 0 0 1").
+ * @param out - Receives the transform.
+ * @param error - Buffer of TRANSFORM_ERROR_LEN bytes for a message on failure.
+ * @return 1 if successful, 0 if the literal is malformed.
+ */
+int transform_parse(const char *text, Transform *out, char *error) {
+    float values[16];
+    int expected;
+    const char *keyword = text;
+
+    memset(out, 0, sizeof(*out));
+    if (strncmp(text, "mat3", 4) == 0) {
+        out->kind = XFORM_MAT3;
+        expected = 9;
+    } else if (strncmp(text, "mat4", 4) == 0) {
+        out->kind = XFORM_MAT4;
+        expected = 16;
+    } else {
+        out->kind = XFORM_QUAT;
+        expected = 4;
+    }
+
+    int given = 0;
+    const char *p = text + 4;
+    for (;;) {
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        char *end;
+        float value = strtof(p, &end);
+        if (end == p) {
+            snprintf(error, TRANSFORM_ERROR_LEN, "Invalid number in %.4s literal.", keyword);
+            return 0;
+        }
+        if (given < 16) {
+            values[given] = value;
+        }
+        given++;
+        p = end;
+    }
+    if (given != expected) {
+        snprintf(error, TRANSFORM_ERROR_LEN, "%.4s needs %d numbers, got %d.",
+                 keyword, expected, given);
+        return 0;
+    }
+
+    if (out->kind == XFORM_QUAT) {
+        memcpy(out->q, values, sizeof(out->q));
+        if (!quat_normalize(out->q)) {
+            snprintf(error, TRANSFORM_ERROR_LEN, "A quaternion must not be zero.");
+            return 0;
+        }
+        quat_matrix(out);
+    } else if (out->kind == XFORM_MAT3) {
+        for (int row = 0; row < 3; row++) {
+            memcpy(&out->m[row * 4], &values[row * 3], 3 * sizeof(float));
+        }
+        out->m[15] = 1;
+    } else {
+        memcpy(out->m, values, sizeof(out->m));
+        out->projective = out->m[12] != 0 || out->m[13] != 0 || out->m[14] != 0 ||
+                          out->m[15] != 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Composes two transforms so out applies b first, then a.
+ * @param a - The transform applied second.
+ * @param b - The transform applied first.
+ * @param out - Receives a * b (may alias a or b).
+ */
+void transform_compose(const Transform *a, const Transform *b, Transform *out) {
+    Transform result;
+    memset(&result, 0, sizeof(result));
+
+    if (a->kind == XFORM_QUAT && b->kind == XFORM_QUAT) {
+        // Hamilton product
+        const float *p = a->q;
+        const float *q = b->q;
+        result.kind = XFORM_QUAT;
+        result.q[0] = p[0] * q[0] - p[1] * q[1] - p[2] * q[2] - p[3] * q[3];
+        result.q[1] = p[0] * q[1] + p[1] * q[0] + p[2] * q[3] - p[3] * q[2];
+        result.q[2] = p[0] * q[2] - p[1] * q[3] + p[2] * q[0] + p[3] * q[1];
+        result.q[3] = p[0] * q[3] + p[1] * q[2] - p[2] * q[1] + p[3] * q[0];
+        quat_normalize(result.q);
+        quat_matrix(&result);
+    } else {
+        result.kind = a->kind == XFORM_MAT4 || b->kind == XFORM_MAT4 ? XFORM_MAT4 : XFORM_MAT3;
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++) {
+                float sum = 0;
+                for (int k = 0; k < 4; k++) {
+                    sum += a->m[row * 4 + k] * b->m[k * 4 + col];
+                }
+                result.m[row * 4 + col] = sum;
+            }
+        }
+        result.projective = result.m[12] != 0 || result.m[13] != 0 || result.m[14] != 0 ||
+                            result.m[15] != 1;
+    }
+    *out = result;
+}
+
+/* ==================== Named Transforms ==================== */
+
+/**
+ * @brief Finds the index of a named transform.
+ * @param set - The set to search (NULL is allowed).
+ * @param name - The name to find.
+ * @return The index, or -1 if there is none with that name.
+ */
+static int find_index(const TransformSet *set, const char *name) {
+    for (int i = 0; set != NULL && i < set->count; i++) {
+        if (strcmp(set->names[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Creates or replaces a named transform.
+ * @param store - The store owning the transforms.
+ * @param name - The transform's name.
+ * @param t - The transform to store.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+int transform_define(VectorStore *store, const char *name, const Transform *t) {
+    if (store->transforms == NULL) {
+        store->transforms = calloc(1, sizeof(TransformSet));
+        if (store->transforms == NULL) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            return 0;
+        }
+    }
+    TransformSet *set = store->transforms;
+
+    int index = find_index(set, name);
+    if (index >= 0) {
+        set->items[index] = *t;
+        return 1;
+    }
+
+    if (set->count == set->capacity) {
+        int capacity = set->capacity > 0 ? set->capacity * 2 : 4;
+        char **names = realloc(set->names, (size_t)capacity * sizeof(char *));
+        if (names == NULL) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            return 0;
+        }
+        set->names = names;
+        Transform *items = realloc(set->items, (size_t)capacity * sizeof(Transform));
+        if (items == NULL) {
+            fprintf(stderr, "Memory allocation failed.\n");
+            return 0;
+        }
+        set->items = items;
+        set->capacity = capacity;
+    }
+
+    set->names[set->count] = malloc(strlen(name) + 1);
+    if (set->names[set->count] == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return 0;
+    }
+    strcpy(set->names[set->count], name);
+    set->items[set->count] = *t;
+    set->count++;
+    return 1;
+}
+
+/**
+ * @brief Looks up a named transform.
+ * @param store - The store owning the transforms.
+ * @param name - The name to find.
+ * @return The transform, or NULL if there is none with that name.
+ */
+const Transform *transform_find(const VectorStore *store, const char *name) {
+    int index = find_index(store->transforms, name);
+    return index >= 0 ? &store->transforms->items[index] : NULL;
+}
+
+/**
+ * @brief Prints a transform.
+ * @param name - The name to print.
+ * @param t - The transform.
+ */
+void transform_print(const char *name, const Transform *t) {
+    if (t->kind == XFORM_QUAT) {
+        out_printf("%s = quat %.2f  %.2f  %.2f  %.2f\n", name, t->q[0], t->q[1], t->q[2], t->q[3]);
+        return;
+    }
+    int size = t->kind == XFORM_MAT3 ? 3 : 4;
+    out_printf("%s = mat%d\n", name, size);
+    for (int row = 0; row < size; row++) {
+        out_printf(" ");
+        for (int col = 0; col < size; col++) {
+            out_printf(" %.2f%s", t->m[row * 4 + col], col + 1 < size ? " " : "\n");
+        }
+    }
+}
+
+/**
+ * @brief Prints every named transform, if there are any.
+ * @param store - The store owning the transforms.
+ */
+void transform_list(const VectorStore *store) {
+    const TransformSet *set = store->transforms;
+    if (set == NULL || set->count == 0) {
+        return;
+    }
+    out_printf("Stored transforms:\n");
+    for (int i = 0; i < set->count; i++) {
+        transform_print(set->names[i], &set->items[i]);
+    }
+}
+
+/**
+ * @brief Frees a transform set.
+ * @param set - The set to free (NULL is allowed).
+ */
+void transform_free(TransformSet *set) {
+    if (set == NULL) {
+        return;
+    }
+    for (int i = 0; i < set->count; i++) {
+        free(set->names[i]);
+    }
+    free(set->names);
+    free(set->items);
+    free(set);
+}
+
+/* ==================== Application ==================== */
+
+/**
+ * @brief State shared by the chunk tasks of one transform job.
+ */
+typedef struct {
+    VectorStore *store;        /**< The store being updated. */
+    const char *pattern;       /**< Pattern selecting the targets. */
+    int match_all;             /**< Nonzero when pattern is "all". */
+    const Transform *t;        /**< The transform to apply. */
+    float cols[16];            /**< Affine columns of t for the kernels. */
+    int *updated;              /**< Vectors changed, one count per chunk. */
+} TransformJob;
+
+/**
+ * @brief Transforms the matching vectors of one chunk of the store.
+ * @param context - The TransformJob.
+ * @param task - Index of the chunk.
+ */
+static void transform_chunk(void *context, int task) {
+    TransformJob *job = context;
+    int first = task * POOL_CHUNK_VECTORS;
+    int last = first + POOL_CHUNK_VECTORS;
+    if (last > job->store->count) {
+        last = job->store->count;
+    }
+    vector *v = job->store->vectors;
+
+    if (job->match_all && !job->t->projective) {
+        kernels()->affine(job->cols, v + first, last - first);
+        job->updated[task] = last - first;
+        return;
+    }
+
+    int count = 0;
+    for (int i = first; i < last; i++) {
+        if (job->match_all || glob_match(job->pattern, vector_name(job->store, &v[i]))) {
+            v[i] = apply_one(job->t, job->cols, v[i]);
+            count++;
+        }
+    }
+    job->updated[task] = count;
+}
+
+/**
+ * @brief Applies a transform to one vector.
+ * @param t - The transform.
+ * @param v - The vector (its name id is kept).
+ * @return The transformed vector.
+ */
+vector transform_vector(const Transform *t, vector v) {
+    float cols[16];
+    affine_columns(t, cols);
+    return apply_one(t, cols, v);
+}
+
+/**
+ * @brief Applies a transform in place to every vector matching pattern.
+ * @param store - The store to update (dimension 3).
+ * @param pattern - "all", a '*' / '?' pattern, or a single name.
+ * @param t - The transform.
+ * @return The number of vectors transformed, or -1 if allocation failed.
+ */
+int transform_vectors(VectorStore *store, const char *pattern, const Transform *t) {
+    TransformJob job;
+    refresh_vectors(store);
+    int chunks = pool_chunks(store->count);
+
+    job.store = store;
+    job.pattern = pattern;
+    job.match_all = strcmp(pattern, BULK_ALL) == 0;
+    job.t = t;
+    affine_columns(t, job.cols);
+    job.updated = calloc(chunks > 0 ? (size_t)chunks : 1, sizeof(int));
+    if (job.updated == NULL) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return -1;
+    }
+
+    // Chunks are disjoint, so each streams through its own records once
+    pool_run(store->pool, chunks, transform_chunk, &job);
+    note_vector_change(store, -1);
+
+    int total = 0;
+    for (int i = 0; i < chunks; i++) {
+        total += job.updated[i];
+    }
+    free(job.updated);
+    return total;
+}
+
+/**
+ * @brief Returns the instruction set the batch kernel dispatches to.
+ * @return The simd_level_t chosen at runtime.
+ */
+simd_level_t transform_kernel_level(void) {
+    return kernels()->level;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file      : transform.h
+ * @brief     : Declares named 3x3 / 4x4 matrices and quaternions, and the
+ *              batched kernels that apply them to stored vectors.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "vector.h"
+#include "simd.h"
+
+#define TRANSFORM_ERROR_LEN 128   /**< Size of the error message buffers. */
+
+/**
+ * @brief How a transform was written, which decides how it is displayed.
+ */
+typedef enum {
+    XFORM_MAT3,        /**< A 3x3 linear map. */
+    XFORM_MAT4,        /**< A 4x4 homogeneous matrix (rotation, scale, translation). */
+    XFORM_QUAT         /**< A rotation given as a quaternion. */
+} transform_kind_t;
+
+/**
+ * @brief A transform of 3D vectors.
+ *
+ * Every kind is kept as a row-major 4x4 matrix: a 3x3 or a quaternion
+ * fills the upper-left block with no translation. A vector (x, y, z) is
+ * treated as the column (x, y, z, 1); when the bottom row is not 0 0 0 1
+ * the result is divided by its w.
+ */
+typedef struct {
+    transform_kind_t kind;  /**< How the transform was defined. */
+    float m[16];            /**< Row-major 4x4 matrix. */
+    float q[4];             /**< Unit quaternion w, x, y, z (XFORM_QUAT only). */
+    int projective;         /**< Nonzero when the bottom row is not 0 0 0 1. */
+} Transform;
+
+/**
+ * @brief The named transforms of a store. Transforms live in their own
+ * namespace and survive clear and load.
+ */
+typedef struct TransformSet TransformSet;
+
+/* ==================== Construction ==================== */
+
+/**
+ * @brief Checks whether text is a transform literal.
+ * @param text The right-hand side of an assignment.
+ * @return 1 if text starts with the keyword mat3, mat4 or quat.
+ */
+int is_transform_literal(const char *text);
+
+/**
+ * @brief Parses a transform literal.
+ *
+ * "mat3" takes 9 numbers and "mat4" 16, both row by row; "quat" takes
+ * w x y z and is normalized to a unit rotation.
+ *
+ * @param text The literal (e.g., "quat 0.7071 0 0.7071 0").
+ * @param out Receives the transform.
+ * @param error Buffer of TRANSFORM_ERROR_LEN bytes for a message on failure.
+ * @return 1 if successful, 0 if the literal is malformed.
+ */
+int transform_parse(const char *text, Transform *out, char *error);
+
+/**
+ * @brief Composes two transforms so out applies b first, then a.
+ *
+ * Two quaternions compose to a quaternion; a product involving a 4x4
+ * matrix is a 4x4 matrix, and anything else is a 3x3 matrix.
+ *
+ * @param a The transform applied second.
+ * @param b The transform applied first.
+ * @param out Receives a * b (may alias a or b).
+ */
+void transform_compose(const Transform *a, const Transform *b, Transform *out);
+
+/* ==================== Named Transforms ==================== */
+
+/**
+ * @brief Creates or replaces a named transform.
+ * @param store The store owning the transforms (the set is created on first use).
+ * @param name The transform's name.
+ * @param t The transform to store.
+ * @return 1 if successful, 0 if allocation failed.
+ */
+int transform_define(VectorStore *store, const char *name, const Transform *t);
+
+/**
+ * @brief Looks up a named transform.
+ * @param store The store owning the transforms.
+ * @param name The name to find.
+ * @return The transform, or NULL if there is none with that name.
+ */
+const Transform *transform_find(const VectorStore *store, const char *name);
+
+/**
+ * @brief Prints a transform (e.g., "M = mat3" followed by its rows).
+ * @param name The name to print.
+ * @param t The transform.
+ */
+void transform_print(const char *name, const Transform *t);
+
+/**
+ * @brief Prints every named transform, if there are any.
+ * @param store The store owning the transforms.
+ */
+void transform_list(const VectorStore *store);
+
+/**
+ * @brief Frees a transform set.
+ * @param set The set to free (NULL is allowed).
+ */
+void transform_free(TransformSet *set);
+
+/* ==================== Application ==================== */
+
+/**
+ * @brief Applies a transform to one vector.
+ * @param t The transform.
+ * @param v The vector (its name id is kept).
+ * @return The transformed vector.
+ */
+vector transform_vector(const Transform *t, vector v);
+
+/**
+ * @brief Applies a transform in place to every vector matching pattern.
+ *
+ * For "all" and an affine transform, each chunk of the store is streamed
+ * once through a kernel that transforms whole 16-byte records in SIMD
+ * registers (one per SSE register, two per AVX, four per AVX-512) and
+ * writes them back with their name ids untouched. Patterns, and
+ * projective matrices, use transform_vector per match; both paths round
+ * identically, so results never depend on the path, thread count or CPU.
+ *
+ * @param store The store to update (dimension 3).
+ * @param pattern "all", a '*' / '?' pattern, or a single name.
+ * @param t The transform.
+ * @return The number of vectors transformed, or -1 if allocation failed.
+ */
+int transform_vectors(VectorStore *store, const char *pattern, const Transform *t);
+
+/**
+ * @brief Returns the instruction set the batch kernel dispatches to.
+ * @return The simd_level_t chosen at runtime (AVX-512, AVX, SSE or scalar).
+ */
+simd_level_t transform_kernel_level(void);
+
+#endif /* TRANSFORM_H */
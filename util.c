@@ -11,8 +11,26 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
 #include "util.h"
 
+/** Largest power of ten that is exactly representable as a double. */
+#define MAX_EXACT_POW10 22
+
+/** Widest mantissa (in bits) a double holds exactly. */
+#define MAX_EXACT_MANTISSA (1ULL << 53)
+
+/** Output stream of this thread; NULL means stdout. */
+static _Thread_local FILE *thread_output;
+
+static const double pow10_table[MAX_EXACT_POW10 + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
 /**
  * @brief Removes leading and trailing whitespace characters from a string.
  * 
@@ -56,3 +74,320 @@ void trim(char *str)
         memmove(str, start, end - start + 2);
     }
 }
+
+/**
+ * @brief Hashes a null-terminated string with 32-bit FNV-1a.
+ * @param str The string to hash.
+ * @return The hash value of the string.
+ */
+unsigned int hash_string(const char *str)
+{
+    unsigned int hash = 2166136261u;
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hashes a range of bytes with 32-bit FNV-1a.
+ * @param data First byte to hash.
+ * @param length Number of bytes.
+ * @return The hash value of the bytes.
+ */
+unsigned int hash_bytes(const char *data, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Checks whether a filename ends with the given extension.
+ * @param filename The filename to test.
+ * @param extension The extension including its dot (e.g., ".vbin").
+ * @return 1 if filename ends with extension, 0 otherwise.
+ */
+int has_extension(const char *filename, const char *extension)
+{
+    size_t name_length = strlen(filename);
+    size_t ext_length = strlen(extension);
+    return name_length > ext_length &&
+           strcmp(filename + name_length - ext_length, extension) == 0;
+}
+
+/**
+ * @brief Matches a name against a shell-style pattern.
+ *
+ * Runs in linear time by remembering only the most recent '*' and
+ * retrying from one character further on a mismatch.
+ *
+ * @param pattern - The pattern (e.g., "p*").
+ * @param name - The name to test.
+ * @return 1 if name matches pattern, 0 otherwise.
+ */
+int glob_match(const char *pattern, const char *name)
+{
+    const char *star = NULL;
+    const char *resume = NULL;
+
+    while (*name != '\0') {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        } else if (*pattern == '?' || *pattern == *name) {
+            pattern++;
+            name++;
+        } else if (star != NULL) {
+            pattern = star + 1;
+            name = ++resume;
+        } else {
+            return 0;
+        }
+    }
+    while (*pattern == '*') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
+
+/**
+ * @brief Checks whether a double lies exactly halfway between two floats.
+ *
+ * Rounding a correctly rounded double to float gives the correctly rounded
+ * float unless the double landed exactly on such a tie, since the ties
+ * themselves are doubles: the first rounding can reach one but never cross it.
+ *
+ * @param value - The double.
+ * @return 1 if value is a tie (or too small to tell cheaply), 0 otherwise.
+ */
+static int float_tie(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int exponent = (int)((bits >> 52) & 0x7FF);
+    // A float keeps 24 of the 53 bits, fewer once it is subnormal (below 2^-126)
+    int dropped = 29;
+    if (exponent < 1023 - 126) {
+        dropped += (1023 - 126) - exponent;
+    }
+    if (value == 0.0) {
+        return 0;
+    }
+    if (dropped >= 52) {
+        return 1;
+    }
+    uint64_t mask = ((uint64_t)1 << dropped) - 1;
+    return (bits & mask) == (uint64_t)1 << (dropped - 1);
+}
+
+/**
+ * @brief Matches a word at p without regard to case.
+ * @param p Start of the characters to compare.
+ * @param end One past the last character that may be read.
+ * @param word The lowercase word.
+ * @return Pointer just past the word, or NULL if it is not there.
+ */
+static const char *match_word(const char *p, const char *end, const char *word)
+{
+    for (; *word != '\0'; word++, p++) {
+        if (p >= end || tolower((unsigned char)*p) != *word) {
+            return NULL;
+        }
+    }
+    return p;
+}
+
+/**
+ * @brief Parses a decimal floating-point number from a character range.
+ *
+ * "inf", "infinity" and "nan" (in any case, with an optional sign) are
+ * read as well, since that is how a save writes non-finite components.
+ * The digits are accumulated into a 64-bit integer mantissa and a decimal
+ * exponent. When the mantissa fits in 53 bits and the exponent is within
+ * the range of exactly representable powers of ten, the value is produced
+ * with a single multiply or divide (the classic Clinger fast path), which
+ * is then rounded to float unless it is a tie that the double rounding could
+ * have broken the wrong way. Anything longer, more extreme or tied is copied
+ * into a terminated buffer (on the stack, or the heap for a numeral of 64
+ * characters or more) and handed to strtof, so the result is always the
+ * correctly rounded float and saved text reads back bit for bit.
+ *
+ * @param str Start of the characters to parse.
+ * @param end One past the last character that may be read.
+ * @param out Receives the parsed value on success.
+ * @return Pointer to the first unconsumed character, or NULL if no number
+ *         could be parsed.
+ */
+const char *parse_float(const char *str, const char *end, float *out)
+{
+    const char *p = str;
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    int significant = 0;
+    int negative = 0;
+    int exact = 1;
+
+    // Skip leading blanks
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    const char *number = p;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    // Non-finite values, as the savers write them
+    const char *special = match_word(p, end, "inf");
+    if (special != NULL) {
+        const char *longer = match_word(p, end, "infinity");
+        p = longer != NULL ? longer : special;
+        *out = negative ? -INFINITY : INFINITY;
+    } else if ((special = match_word(p, end, "nan")) != NULL) {
+        p = special;
+        *out = negative ? -NAN : NAN;
+    }
+    if (special != NULL) {
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        return p;
+    }
+
+    // Integer part
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (significant < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa != 0) {
+                significant++;
+            }
+        } else {
+            // Digits beyond what fits only shift the exponent
+            exponent++;
+            exact = 0;
+        }
+        digits++;
+        p++;
+    }
+
+    // Fraction part
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (significant < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa != 0) {
+                    significant++;
+                }
+                exponent--;
+            } else {
+                exact = 0;
+            }
+            digits++;
+            p++;
+        }
+    }
+
+    if (digits == 0) {
+        return NULL;
+    }
+
+    // Optional exponent, only consumed if it is well formed
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        int exp_negative = 0;
+        int exp_value = 0;
+        if (q < end && (*q == '-' || *q == '+')) {
+            exp_negative = (*q == '-');
+            q++;
+        }
+        if (q < end && *q >= '0' && *q <= '9') {
+            while (q < end && *q >= '0' && *q <= '9') {
+                if (exp_value < 10000) {
+                    exp_value = exp_value * 10 + (*q - '0');
+                }
+                q++;
+            }
+            exponent += exp_negative ? -exp_value : exp_value;
+            p = q;
+        }
+    }
+
+    double value = 0.0;
+    int fast = exact && mantissa < MAX_EXACT_MANTISSA &&
+               exponent >= -MAX_EXACT_POW10 && exponent <= MAX_EXACT_POW10;
+    if (fast) {
+        value = (double)mantissa;
+        if (exponent < 0) {
+            value /= pow10_table[-exponent];
+        } else {
+            value *= pow10_table[exponent];
+        }
+        if (negative) {
+            value = -value;
+        }
+        fast = !float_tie(value);
+    }
+    if (!fast) {
+        // Slow path: let the C library do the exact conversion
+        char small[64];
+        size_t length = (size_t)(p - number);
+        char *buffer = length < sizeof(small) ? small : malloc(length + 1);
+        if (buffer == NULL) {
+            return NULL;
+        }
+        memcpy(buffer, number, length);
+        buffer[length] = '\0';
+        value = strtof(buffer, NULL);
+        if (buffer != small) {
+            free(buffer);
+        }
+    }
+
+    // Skip trailing blanks
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+
+    *out = (float)value;
+    return p;
+}
+
+/**
+ * @brief Sets where the calling thread's command output goes.
+ * @param stream - The stream to write to, or NULL for stdout.
+ */
+void set_output(FILE *stream)
+{
+    thread_output = stream;
+}
+
+/**
+ * @brief Returns the calling thread's output stream.
+ * @return The stream given to set_output, or stdout.
+ */
+FILE *output(void)
+{
+    return thread_output != NULL ? thread_output : stdout;
+}
+
+/**
+ * @brief Like printf, but writes to the calling thread's output stream.
+ * @param format - The printf format string.
+ * @return The number of characters written, or a negative value on error.
+ */
+int out_printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = vfprintf(output(), format, args);
+    va_end(args);
+    return written;
+}
@@ -12,6 +12,9 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <stddef.h>
+#include <stdio.h>
+
 /**
  * @brief Removes leading and trailing whitespace characters from a string.
  * 
@@ -23,4 +26,77 @@
  */
 void trim(char *str);
 
+/**
+ * @brief Hashes a null-terminated string with 32-bit FNV-1a.
+ * @param str The string to hash.
+ * @return The hash value of the string.
+ */
+unsigned int hash_string(const char *str);
+
+/**
+ * @brief Hashes a range of bytes with 32-bit FNV-1a.
+ * Gives the same value as hash_string for the same characters.
+ * @param data First byte to hash.
+ * @param length Number of bytes.
+ * @return The hash value of the bytes.
+ */
+unsigned int hash_bytes(const char *data, size_t length);
+
+/**
+ * @brief Checks whether a filename ends with the given extension.
+ * @param filename The filename to test.
+ * @param extension The extension including its dot (e.g., ".vbin").
+ * @return 1 if filename ends with extension, 0 otherwise.
+ */
+int has_extension(const char *filename, const char *extension);
+
+/**
+ * @brief Matches a name against a shell-style pattern.
+ * '*' matches any run of characters and '?' matches exactly one.
+ * @param pattern The pattern (e.g., "p*").
+ * @param name The name to test.
+ * @return 1 if name matches pattern, 0 otherwise.
+ */
+int glob_match(const char *pattern, const char *name);
+
+/**
+ * @brief Parses a decimal floating-point number from a character range.
+ *
+ * Unlike atof/strtof this does not consult the locale and does not need a
+ * null-terminated string, so it can read fields directly out of a mapped
+ * file. Leading and trailing spaces or tabs are skipped. Accepted syntax is
+ * an optional sign, digits with an optional '.', and an optional exponent,
+ * or an optional sign and "inf", "infinity" or "nan" in any case.
+ *
+ * @param str Start of the characters to parse.
+ * @param end One past the last character that may be read.
+ * @param out Receives the parsed value on success.
+ * @return Pointer to the first unconsumed character, or NULL if no number
+ *         could be parsed (or memory for copying a very long numeral ran out).
+ */
+const char *parse_float(const char *str, const char *end, float *out);
+
+/**
+ * @brief Sets where the calling thread's command output goes.
+ *
+ * Every thread starts out writing to stdout; a server thread points its
+ * output at the buffer it sends to its client.
+ *
+ * @param stream The stream to write to, or NULL for stdout.
+ */
+void set_output(FILE *stream);
+
+/**
+ * @brief Returns the calling thread's output stream.
+ * @return The stream given to set_output, or stdout.
+ */
+FILE *output(void);
+
+/**
+ * @brief Like printf, but writes to the calling thread's output stream.
+ * @param format The printf format string.
+ * @return The number of characters written, or a negative value on error.
+ */
+int out_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
 #endif /* UTIL_H */
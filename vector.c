@@ -12,22 +12,94 @@
 #include "vector.h"
 #include "stdio.h"
 #include "string.h"
-#include <ctype.h>
 #include <stdlib.h>
 #include "util.h"
+#include "expr.h"
+#include "pool.h"
+#include "kdtree.h"
+#include "formula.h"
+#include "transform.h"
+#include "wide.h"
+#include "stats.h"
+#include "journal.h"
+#include "ftoa.h"
+#include <math.h>
+
+/**
+ * @brief Makes room for at least capacity vectors.
+ *
+ * The vector array lives in an arena whose whole maximum size was
+ * reserved by init_store, so growing only commits more fixed-size blocks:
+ * nothing is copied and no stored vector moves.
+ *
+ * @param store - Pointer to the VectorStore to grow.
+ * @param capacity - Minimum number of slots required.
+ * @return 1 if successful, 0 if memory could not be committed.
+ */
+static int grow_storage(VectorStore *store, int capacity) {
+    if (capacity <= store->capacity) {
+        return 1;
+    }
+    STATS_START(start);
+    size_t row_bytes = (size_t)store->row_stride * sizeof(float);
+    if (capacity > MAX_VECTORS ||
+        !arena_commit(&store->arena, (size_t)capacity * sizeof(vector))) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return 0;
+    }
+    // The vector arena rounds up to whole blocks; rows must cover all of it
+    size_t committed = store->arena.committed / sizeof(vector);
+    capacity = committed < MAX_VECTORS ? (int)committed : MAX_VECTORS;
+    if (store->rows && !arena_commit(&store->row_arena, (size_t)capacity * row_bytes)) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return 0;
+    }
+    // The bases only change when the arenas fell back to the heap
+    store->vectors = (vector *)store->arena.base;
+    if (store->rows) {
+        store->rows = (float *)store->row_arena.base;
+    }
+    store->capacity = capacity;
+    STATS_STOP(STAT_GROW, start);
+    return 1;
+}
 
 /**
  * @brief Initializes a vector store with an initial memory allocation.
+ *
+ * Address space for MAX_VECTORS vectors is reserved up front; memory is
+ * only committed as the store grows.
+ *
  * @param store - Pointer to the VectorStore structure to initialize.
  */
 void init_store(VectorStore *store) {
-    store->vectors = malloc(INITIAL_CAPACITY * sizeof(vector));
-    if (!store->vectors) {
+    int ok = arena_init(&store->arena, (size_t)MAX_VECTORS * sizeof(vector),
+                        INITIAL_CAPACITY * sizeof(vector));
+    ok &= arena_init(&store->handle_arena, (size_t)MAX_VECTORS * sizeof(int),
+                     INITIAL_CAPACITY * sizeof(int));
+    ok &= names_init(&store->names);
+    if (!ok) {
         fprintf(stderr, "Memory allocation failed.\n");
         exit(EXIT_FAILURE);
     }
+    store->vectors = (vector *)store->arena.base;
+    store->handle_slots = (int *)store->handle_arena.base;
     store->count = 0;
-    store->capacity = INITIAL_CAPACITY;
+    store->capacity = (int)(store->arena.committed / sizeof(vector));
+    store->handle_count = 0;
+    store->dim = 3;
+    store->row_stride = 0;
+    store->rows = NULL;
+    memset(&store->row_arena, 0, sizeof(store->row_arena));
+    store->quiet = 0;
+    store->precision = FTOA_SHORTEST;
+    store->generation = 0;
+    store->exprs = NULL;
+    store->pool = NULL;
+    store->kd = NULL;
+    store->formulas = NULL;
+    store->transforms = NULL;
+    store->journal = NULL;
 }
 
 /**
@@ -35,10 +107,27 @@ void init_store(VectorStore *store) {
  * @param store - Pointer to the VectorStore to free.
  */
 void free_store(VectorStore *store) {
-    free(store->vectors);
+    journal_close(store);
+    arena_free(&store->arena);
+    arena_free(&store->handle_arena);
+    arena_free(&store->row_arena);
+    names_free(&store->names);
+    expr_cache_free(store->exprs);
+    pool_free(store->pool);
+    kd_free(store->kd);
+    formula_free(store->formulas);
+    transform_free(store->transforms);
     store->vectors = NULL;
+    store->handle_slots = NULL;
+    store->rows = NULL;
+    store->exprs = NULL;
+    store->pool = NULL;
+    store->kd = NULL;
+    store->formulas = NULL;
+    store->transforms = NULL;
     store->count = 0;
     store->capacity = 0;
+    store->handle_count = 0;
 }
 
 /**
@@ -110,46 +199,418 @@ vector cross_prod(vector a, vector b) {
 /**
  * @brief Adds or replaces a vector in the given vector store.
  * 
- * If a vector with the same name already exists, it is replaced. 
- * If there is available space, the vector is appended to the store.
- * If there is no available space, the array is doubled and the data is transferred over. 
+ * A thin wrapper over add_row for stores of dimension 3.
  * 
  * @param store - Pointer to the VectorStore structure where vectors are stored.
  * @param v - The vector to add or replace.
  * @return 1 after successful
  */
 int add_vector(VectorStore *store, vector v) {
-    vector *existing = find_vector(store, v.name);
+    if (store->dim != 3) {
+        fprintf(stderr, "This store holds %d-dimensional vectors.\n", store->dim);
+        return 0;
+    }
+    return add_row(store, v.id, &v.x);
+}
+
+/**
+ * @brief Adds or replaces a vector of the store's dimension.
+ * 
+ * If a vector with the same name already exists, it is replaced. 
+ * Otherwise it is appended; when the store is full, more arena blocks are
+ * committed in place, so growth never copies the existing vectors.
+ * Both cases find the slot through the name id, with no hashing.
+ * 
+ * @param store - Pointer to the VectorStore where the vector is stored.
+ * @param id - The vector's name, from store_name.
+ * @param row - store->dim components.
+ * @return 1 if successful, 0 if memory allocation failed.
+ */
+int add_row(VectorStore *store, name_id id, const float *row) {
+    size_t row_bytes = (size_t)store->dim * sizeof(float);
+    // A direct assignment replaces any formula bound to the name
+    formula_unbind(store->formulas, id);
+    vector *existing = handle_vector(store, id);
     if (existing != NULL) {
-        *existing = v;
-        printf("Vector '%s' replaced.\n", v.name);
+        memcpy(vector_row(store, existing), row, row_bytes);
+        note_vector_change(store, (int)(existing - store->vectors));
+        if (!store->quiet) {
+            out_printf("Vector '%s' replaced.\n", names_get(&store->names, id));
+        }
         return 1;
     }
 
     // Expand if full
     if (store->count >= store->capacity) {
-        // double the capacity
-        int new_capacity = store->capacity * 2;
-        // move the vectors into the new storage
-        vector *temp = realloc(store->vectors, new_capacity * sizeof(vector));
-        // check if realloc = NULL, this means that the realloc failed
-        if (!temp) {
-            // print error message
-            fprintf(stderr, "Memory reallocation failed.\n");
+        if (!grow_storage(store, store->count + 1)) {
             return 0;
         }
-        // update stores pointer to the new block returned by realloc
-        store->vectors = temp;
-        // update the capacity field to that future resizes are correct
-        store->capacity = new_capacity;
-        printf("Vector storage expanded to %d.\n", new_capacity);
+        if (!store->quiet) {
+            out_printf("Vector storage expanded to %d.\n", store->capacity);
+        }
     }
 
-    store->vectors[store->count++] = v;
-    printf("Vector '%s' added.\n", v.name);
+    vector *v = &store->vectors[store->count];
+    v->id = id;
+    memcpy(vector_row(store, v), row, row_bytes);
+    store->handle_slots[id] = store->count;
+    note_vector_change(store, store->count);
+    store->count++;
+    if (!store->quiet) {
+        out_printf("Vector '%s' added.\n", names_get(&store->names, id));
+    }
     return 1;
 }
 
+/**
+ * @brief Ensures the store can hold at least capacity vectors.
+ *
+ * Commits the vector storage and slot table straight to the requested
+ * size and sizes the name table so it needs no rehash until that many
+ * names are stored.
+ *
+ * @param store - Pointer to the VectorStore to grow.
+ * @param capacity - Minimum number of slots required.
+ * @return 1 if successful, 0 if memory allocation failed.
+ */
+int reserve_vectors(VectorStore *store, int capacity) {
+    if (!grow_storage(store, capacity)) {
+        return 0;
+    }
+    if (capacity > 0 &&
+        (!names_reserve(&store->names, (uint32_t)capacity) ||
+         !arena_commit(&store->handle_arena, (size_t)capacity * sizeof(int)))) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return 0;
+    }
+    store->handle_slots = (int *)store->handle_arena.base;
+    return 1;
+}
+
+/**
+ * @brief Adds or replaces a batch of vectors without per-vector messages.
+ *
+ * Used by the bulk loaders: capacity for the whole batch is reserved up
+ * front, then each vector either overwrites the existing entry with the
+ * same name or is appended and indexed.
+ *
+ * @param store - Pointer to the VectorStore to add to.
+ * @param batch - Array of vectors to add (their ids name them).
+ * @param rows - store->dim components per vector, packed, or NULL to take
+ *               the components from batch (dimension 3 only).
+ * @param n - Number of vectors in batch.
+ * @return 1 if successful, 0 if memory allocation failed.
+ */
+int append_vectors(VectorStore *store, const vector *batch, const float *rows, int n) {
+    if (!reserve_vectors(store, store->count + n)) {
+        return 0;
+    }
+    size_t row_bytes = (size_t)store->dim * sizeof(float);
+    for (int i = 0; i < n; i++) {
+        const float *row = rows ? rows + (size_t)i * store->dim : &batch[i].x;
+        formula_unbind(store->formulas, batch[i].id);
+        vector *existing = handle_vector(store, batch[i].id);
+        if (existing != NULL) {
+            memcpy(vector_row(store, existing), row, row_bytes);
+            note_vector_change(store, (int)(existing - store->vectors));
+        } else {
+            vector *v = &store->vectors[store->count];
+            v->id = batch[i].id;
+            memcpy(vector_row(store, v), row, row_bytes);
+            store->handle_slots[batch[i].id] = store->count;
+            note_vector_change(store, store->count);
+            store->count++;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Fills an empty store from a packed component block.
+ * @param store - Pointer to the empty VectorStore to fill.
+ * @param names - Exactly n distinct names, in row order; taken over (or
+ * freed on failure) and left empty.
+ * @param rows - n * store->dim components, packed.
+ * @param n - Number of vectors.
+ * @return 1 if successful, 0 if memory ran out or names does not hold n names.
+ */
+int fill_vectors(VectorStore *store, NameTable *names, const float *rows, int n) {
+    if (store->count != 0 || names->count != (uint32_t)n || !reserve_vectors(store, n) ||
+        !arena_commit(&store->handle_arena, (size_t)(n > 0 ? n : 1) * sizeof(int))) {
+        names_free(names);
+        return 0;
+    }
+    names_free(&store->names);
+    store->names = *names;
+    memset(names, 0, sizeof(*names));
+    store->handle_slots = (int *)store->handle_arena.base;
+    store->handle_count = (uint32_t)n;
+
+    size_t row_bytes = (size_t)store->dim * sizeof(float);
+    if (store->rows != NULL && store->row_stride == store->dim) {
+        memcpy(store->rows, rows, (size_t)n * row_bytes);
+    }
+    for (int i = 0; i < n; i++) {
+        vector *v = &store->vectors[i];
+        v->id = (name_id)i;
+        if (store->rows == NULL || store->row_stride != store->dim) {
+            memcpy(vector_row(store, v), rows + (size_t)i * store->dim, row_bytes);
+        }
+        store->handle_slots[i] = i;
+    }
+    store->count = n;
+    note_vector_change(store, -1);
+    return 1;
+}
+
+/**
+ * @brief Removes one vector by moving the last vector into its slot.
+ *
+ * Only the moved vector's slot entry changes, so handles to every other
+ * vector stay valid. The name stays interned (with no slot) until the
+ * store is cleared or shrunk, so the deleted handle can never come to
+ * mean another name in between.
+ *
+ * @param store - Pointer to the VectorStore to remove from.
+ * @param handle - The vector to remove, from find_handle.
+ * @return 1 if successful, 0 if the handle names no stored vector.
+ */
+int delete_vector(VectorStore *store, vector_handle handle) {
+    vector *v = handle_vector(store, handle);
+    if (v == NULL) {
+        return 0;
+    }
+    int slot = (int)(v - store->vectors);
+    int last = store->count - 1;
+    formula_forget(store, handle);
+    if (slot != last) {
+        const vector *moved = &store->vectors[last];
+        *v = *moved;
+        if (store->rows) {
+            memcpy(vector_row(store, v), vector_row(store, moved),
+                   (size_t)store->dim * sizeof(float));
+        }
+        store->handle_slots[v->id] = slot;
+        kd_touch(store->kd, slot);
+    }
+    store->handle_slots[handle] = -1;
+    store->count--;
+    kd_touch(store->kd, last);
+    journal_delete(store, handle);
+    if (!store->quiet) {
+        out_printf("Vector '%s' deleted.\n", names_get(&store->names, handle));
+    }
+    return 1;
+}
+
+/**
+ * @brief Rebuilds the name table with only the stored vectors' names.
+ *
+ * Deleted names stay interned so their handles never come to mean
+ * another vector; here they finally go. The survivors are renumbered in
+ * slot order, so every handle changes and the generation is bumped for
+ * cached expressions to look their names up again.
+ *
+ * @param store - Pointer to the VectorStore to compact.
+ * @return 1 if successful (or nothing was deleted), 0 if allocation failed.
+ */
+static int compact_names(VectorStore *store) {
+    if (store->names.count == (uint32_t)store->count) {
+        return 1;
+    }
+    NameTable names;
+    name_id *map = malloc((store->handle_count > 0 ? store->handle_count : 1) * sizeof(name_id));
+    if (!map || !names_init(&names)) {
+        free(map);
+        return 0;
+    }
+    int ok = names_reserve(&names, (uint32_t)store->count);
+    for (uint32_t i = 0; i < store->handle_count; i++) {
+        map[i] = NO_NAME;
+    }
+    // Intern everything before changing anything, so a failure leaves the store as it was
+    for (int i = 0; ok && i < store->count; i++) {
+        name_id old = store->vectors[i].id;
+        const char *name = names_get(&store->names, old);
+        map[old] = names_intern(&names, name, strlen(name));
+        ok = map[old] != NO_NAME;
+    }
+    if (!ok) {
+        names_free(&names);
+        free(map);
+        return 0;
+    }
+
+    for (int i = 0; i < store->count; i++) {
+        store->vectors[i].id = map[store->vectors[i].id];
+        store->handle_slots[i] = i;
+    }
+    formula_renumber(store->formulas, map, store->handle_count);
+    names_free(&store->names);
+    store->names = names;
+    store->handle_count = (uint32_t)store->count;
+    store->generation++;
+    free(map);
+    return 1;
+}
+
+/**
+ * @brief Returns memory the store holds beyond what its vectors need.
+ *
+ * Deleted names are dropped (see compact_names), each arena is trimmed to
+ * whole blocks covering the live vectors (at least INITIAL_CAPACITY of
+ * them), the name table to its names, and the nearest-neighbour index is
+ * dropped, to be rebuilt by the next query.
+ *
+ * @param store - Pointer to the VectorStore to shrink.
+ * @return 1 if successful, 0 if some memory could not be released.
+ */
+int shrink_vectors(VectorStore *store) {
+    kd_free(store->kd);
+    store->kd = NULL;
+    int ok = compact_names(store);
+
+    int keep = store->count > INITIAL_CAPACITY ? store->count : INITIAL_CAPACITY;
+    ok &= arena_trim(&store->arena, (size_t)keep * sizeof(vector));
+    store->vectors = (vector *)store->arena.base;
+    store->capacity = (int)(store->arena.committed / sizeof(vector));
+    if (store->rows) {
+        // Rows must keep pace with the capacity the vector arena kept
+        size_t row_bytes = (size_t)store->row_stride * sizeof(float);
+        ok &= arena_trim(&store->row_arena, (size_t)store->capacity * row_bytes);
+        store->rows = (float *)store->row_arena.base;
+    }
+
+    size_t handles = store->handle_count > INITIAL_CAPACITY ? store->handle_count
+                                                            : INITIAL_CAPACITY;
+    ok &= arena_trim(&store->handle_arena, handles * sizeof(int));
+    store->handle_slots = (int *)store->handle_arena.base;
+    ok &= names_shrink(&store->names);
+    return ok;
+}
+
+/**
+ * @brief Measures the memory behind the store's vectors.
+ * @param store - Pointer to the VectorStore to measure.
+ * @param used - Receives the bytes holding live vectors and names.
+ * @return The bytes allocated for them.
+ */
+size_t store_memory(const VectorStore *store, size_t *used) {
+    size_t row_bytes = (size_t)store->row_stride * sizeof(float);
+    size_t name_bytes;
+    size_t allocated = names_memory(&store->names, &name_bytes);
+    *used = (size_t)store->count * (sizeof(vector) + row_bytes) +
+            (size_t)store->handle_count * sizeof(int) + name_bytes;
+    return allocated + store->arena.committed + store->row_arena.committed +
+           store->handle_arena.committed;
+}
+
+/**
+ * @brief Prints one line of the memory report.
+ * @param label - What the line measures.
+ * @param used - Bytes in use.
+ * @param allocated - Bytes allocated.
+ */
+static void print_memory_line(const char *label, size_t used, size_t allocated) {
+    out_printf("  %-12s %12zu of %12zu bytes\n", label, used, allocated);
+}
+
+/**
+ * @brief Prints how much memory each part of the store uses and holds.
+ * @param store - Pointer to the VectorStore to report on.
+ */
+void print_memory(const VectorStore *store) {
+    size_t used;
+    size_t allocated = store_memory(store, &used);
+    size_t name_bytes;
+    size_t name_allocated = names_memory(&store->names, &name_bytes);
+
+    out_printf("Memory (%d of %d slots in use):\n", store->count, store->capacity);
+    print_memory_line("vectors", (size_t)store->count * sizeof(vector), store->arena.committed);
+    if (store->rows) {
+        print_memory_line("rows", (size_t)store->count * store->row_stride * sizeof(float),
+                          store->row_arena.committed);
+    }
+    print_memory_line("slot table", (size_t)store->handle_count * sizeof(int),
+                      store->handle_arena.committed);
+    print_memory_line("names", name_bytes, name_allocated);
+    print_memory_line("total", used, allocated);
+}
+
+/**
+ * @brief Sets the number of components per vector, clearing the store.
+ *
+ * Rows get their own arena, reserved for as many vectors as fit in
+ * MAX_ROW_BYTES, and committed alongside the vector records.
+ *
+ * @param store - Pointer to the VectorStore to reshape.
+ * @param dim - Components per vector (1 to WIDE_MAX_DIM).
+ * @return 1 if successful, 0 if dim is out of range or memory ran out.
+ */
+int set_dimension(VectorStore *store, int dim) {
+    if (dim < 1 || dim > WIDE_MAX_DIM) {
+        fprintf(stderr, "Dimension must be between 1 and %d.\n", WIDE_MAX_DIM);
+        return 0;
+    }
+    int quiet = store->quiet;
+    store->quiet = 1;
+    clear_vectors(store);
+    store->quiet = quiet;
+
+    arena_free(&store->row_arena);
+    store->rows = NULL;
+    store->row_stride = 0;
+    store->dim = 3;
+    if (dim == 3) {
+        journal_dimension(store);
+        return 1;
+    }
+
+    int stride = wide_stride(dim);
+    size_t row_bytes = (size_t)stride * sizeof(float);
+    size_t limit = (size_t)MAX_VECTORS * row_bytes;
+    if (limit > MAX_ROW_BYTES) {
+        limit = MAX_ROW_BYTES;
+    }
+    if (!arena_init(&store->row_arena, limit, (size_t)store->capacity * row_bytes)) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        journal_dimension(store);
+        return 0;
+    }
+    store->rows = (float *)store->row_arena.base;
+    store->row_stride = stride;
+    store->dim = dim;
+    journal_dimension(store);
+    return 1;
+}
+
+/**
+ * @brief Returns the components of a stored vector.
+ * @param store - Pointer to the VectorStore holding the vector.
+ * @param v - A vector in store->vectors.
+ * @return store->dim contiguous floats (for dimension 3, &v->x).
+ */
+float *vector_row(const VectorStore *store, const vector *v) {
+    if (store->rows == NULL) {
+        return (float *)&v->x;
+    }
+    return store->rows + (size_t)(v - store->vectors) * store->row_stride;
+}
+
+/**
+ * @brief Prints a vector as "name = c0  c1  ...".
+ * @param name - The name to print.
+ * @param components - The components.
+ * @param dim - Number of components.
+ */
+void print_components(const char *name, const float *components, int dim) {
+    out_printf("%s = ", name);
+    for (int i = 0; i < dim; i++) {
+        out_printf(i > 0 ? "  %.2f" : "%.2f", components[i]);
+    }
+    out_printf("\n");
+}
+
 /**
  * @brief Searches for a vector by name within a store.
  * @param store - Pointer to the VectorStore containing the vectors.
@@ -157,12 +618,145 @@ int add_vector(VectorStore *store, vector v) {
  * @return Pointer to the vector if found, NULL otherwise.
  */
 vector *find_vector(VectorStore *store, const char *name) {
-    for (int i = 0; i < store->count; i++) {
-        if (strcmp(store->vectors[i].name, name) == 0) {
-            return &store->vectors[i];
-        }
+    return handle_vector(store, find_handle(store, name));
+}
+
+/**
+ * @brief Looks up the stable handle of a stored vector.
+ * @param store - Pointer to the VectorStore to search.
+ * @param name - The name of the vector to find.
+ * @return The vector's handle, or NO_HANDLE if not found.
+ */
+vector_handle find_handle(VectorStore *store, const char *name) {
+    STATS_START(start);
+    name_id id = names_lookup(&store->names, name, strlen(name));
+    vector_handle handle = handle_vector(store, id) ? id : NO_HANDLE;
+    STATS_STOP(STAT_FIND, start);
+    if (handle == NO_HANDLE) {
+        STATS_COUNT(STAT_FIND_MISSES, 1);
+    }
+    return handle;
+}
+
+/**
+ * @brief Interns a name in the store so vectors can be stored under it.
+ *
+ * Every id gets an entry in the slot table (-1 until a vector is stored
+ * under it), committed from an arena like the vectors themselves.
+ *
+ * @param store - Pointer to the VectorStore whose name table to extend.
+ * @param name - First character of the name (need not be null-terminated).
+ * @param length - Number of characters in the name.
+ * @return The name's id, or NO_NAME if memory allocation failed.
+ */
+name_id store_name(VectorStore *store, const char *name, size_t length) {
+    name_id id = names_intern(&store->names, name, length);
+    if (id == NO_NAME || id < store->handle_count) {
+        return id;
+    }
+    if (id >= MAX_VECTORS ||
+        !arena_commit(&store->handle_arena, (size_t)(id + 1) * sizeof(int))) {
+        fprintf(stderr, "Memory allocation failed.\n");
+        return NO_NAME;
+    }
+    store->handle_slots = (int *)store->handle_arena.base;
+    while (store->handle_count <= id) {
+        store->handle_slots[store->handle_count++] = -1;
+    }
+    return id;
+}
+
+/**
+ * @brief Returns the name of a stored vector.
+ * @param store - Pointer to the VectorStore holding the name table.
+ * @param v - The vector.
+ * @return The null-terminated name, valid until the next name is stored.
+ */
+const char *vector_name(const VectorStore *store, const vector *v) {
+    return names_get(&store->names, v->id);
+}
+
+/**
+ * @brief Resolves a handle to its vector without any name lookup.
+ * @param store - Pointer to the VectorStore that issued the handle.
+ * @param handle - A handle from find_handle.
+ * @return A pointer to the vector, or NULL if the handle is no longer valid.
+ */
+vector *handle_vector(VectorStore *store, vector_handle handle) {
+    if (handle >= store->handle_count || store->handle_slots[handle] < 0) {
+        return NULL;
+    }
+    return &store->vectors[store->handle_slots[handle]];
+}
+
+/**
+ * @brief Finds the k stored vectors closest to a point.
+ * @param store - Pointer to the VectorStore to search.
+ * @param q - The query point (its name is ignored).
+ * @param k - Number of neighbours wanted.
+ * @param out - Receives up to k pointers into the store, nearest first.
+ * @param dist - Receives the Euclidean distance of each result.
+ * @return The number of results, or -1 on allocation failure.
+ */
+int nearest_vectors(VectorStore *store, vector q, int k, vector **out, float *dist) {
+    if (k > store->count) {
+        k = store->count;
+    }
+    if (k <= 0) {
+        return 0;
+    }
+    refresh_vectors(store);
+    if (store->kd == NULL && (store->kd = kd_create()) == NULL) {
+        return -1;
     }
-    return NULL;
+    int *slots = malloc((size_t)k * sizeof(int));
+    if (!slots) {
+        return -1;
+    }
+    int found = kd_nearest(store->kd, store->vectors, store->count, q, k, slots, dist);
+    for (int i = 0; i < found; i++) {
+        out[i] = &store->vectors[slots[i]];
+        dist[i] = sqrtf(dist[i]);
+    }
+    free(slots);
+    return found;
+}
+
+/**
+ * @brief Tells the store's derived indexes that vectors were modified.
+ * @param store - Pointer to the VectorStore that changed.
+ * @param slot - Position of the single vector that changed, or -1 for many.
+ */
+void note_vector_change(VectorStore *store, int slot) {
+    if (slot < 0) {
+        kd_invalidate(store->kd);
+        formula_mark_all(store->formulas);
+    } else {
+        kd_touch(store->kd, slot);
+        formula_mark_dependents(store->formulas, store->vectors[slot].id);
+    }
+    journal_note(store, slot);
+}
+
+/**
+ * @brief Looks up a vector for reading, recomputing a stale formula first.
+ * @param store - Pointer to the VectorStore to search.
+ * @param name - The name of the vector to read.
+ * @return A pointer to the current vector, or NULL if not found.
+ */
+vector *read_vector(VectorStore *store, const char *name) {
+    vector_handle handle = find_handle(store, name);
+    formula_refresh(store, handle);
+    return handle_vector(store, handle);
+}
+
+/**
+ * @brief Recomputes every formula whose inputs changed.
+ * @param store - Pointer to the VectorStore to bring up to date.
+ * @return 1 if successful, 0 if some formula lost an input.
+ */
+int refresh_vectors(VectorStore *store) {
+    return formula_refresh_all(store);
 }
 
 /**
@@ -171,7 +765,18 @@ vector *find_vector(VectorStore *store, const char *name) {
  */
 void clear_vectors(VectorStore *store) {
     store->count = 0;
-    printf("All vectors cleared.\n");
+    // Names go too, so cached expressions must re-resolve their handles
+    names_clear(&store->names);
+    store->handle_count = 0;
+    store->generation++;
+    // Formulas refer to vectors by name, so they go with them
+    formula_free(store->formulas);
+    store->formulas = NULL;
+    journal_clear(store);
+    note_vector_change(store, -1);
+    if (!store->quiet) {
+        out_printf("All vectors cleared.\n");
+    }
 }
 
 /**
@@ -180,17 +785,14 @@ void clear_vectors(VectorStore *store) {
  */
 void list_vectors(const VectorStore *store) {
     if (store->count == 0) {
-        printf("No vectors stored.\n");
+        out_printf("No vectors stored.\n");
         return;
     }
 
-    printf("Stored vectors:\n");
+    out_printf("Stored vectors:\n");
     for (int i = 0; i < store->count; i++) {
-        printf("%s = %.2f  %.2f  %.2f\n",
-               store->vectors[i].name,
-               store->vectors[i].x,
-               store->vectors[i].y,
-               store->vectors[i].z);
+        const vector *v = &store->vectors[i];
+        print_components(vector_name(store, v), vector_row(store, v), store->dim);
     }
 }
 
@@ -203,100 +805,32 @@ void list_vectors(const VectorStore *store) {
  * - Dot product (*)
  * - Cross product (x or X)
  * - Scalar multiplication (a * 2 or 2 * a)
+ * - Unary minus and parentheses, with * and x binding tighter than + and -
+ * 
+ * The text is compiled once and kept in the store's expression cache, so
+ * repeated evaluations only run the bytecode.
  * 
  * @param store - Pointer to the VectorStore containing defined vectors.
  * @param expr - The string expression to evaluate.
  * @param result - Pointer to a vector where the computation result is stored.
- * @return 1 if the expression is valid and evaluated successfully, 0 otherwise.
+ * @return 1 if the expression is valid and evaluated successfully, 0 otherwise
+ * (including for stores whose dimension is not 3).
  */
 int evaluate_expression(VectorStore *store, const char *expr, vector *result) {
-    char left[50], right[50];
-    char op = 0;
-    int i = 0;
-
-    while (expr[i] && !strchr("+-*xX", expr[i])) i++;
-    if (!expr[i]) {
-        return 0;
-    }
-    op = expr[i];
-
-    strncpy(left, expr, i);
-    left[i] = '\0';
-    strcpy(right, expr + i + 1);
-
-    trim(left);
-    trim(right);
+    char error[EXPR_ERROR_LEN];
+    ExprValue value;
 
-    vector *v1, *v2;
-    float scalar;
     result->x = result->y = result->z = 0;
-
-    // scalar * vector
-    if (isdigit(left[0]) || left[0] == '-' || left[0] == '+') {
-        scalar = atof(left);
-        v2 = find_vector(store, right);
-        if (!v2) {
-            return 0;
-        }
-        result->x = v2->x * scalar;
-        result->y = v2->y * scalar;
-        result->z = v2->z * scalar;
-        return 1;
-    }
-    // vector * scalar
-    else if (isdigit(right[0]) || right[0] == '-' || right[0] == '+') {
-        v1 = find_vector(store, left);
-        if (!v1) {
-            return 0;
-        }
-        scalar = atof(right);
-        result->x = v1->x * scalar;
-        result->y = v1->y * scalar;
-        result->z = v1->z * scalar;
-        return 1;
-    }
-    // vector + vector
-    else if (op == '+') {
-        v1 = find_vector(store, left);
-        v2 = find_vector(store, right);
-        if (!v1 || !v2) {
-            return 0;
-        }
-        *result = add(*v1, *v2);
-        return 1;
-    }
-    // vector - vector
-    else if (op == '-') {
-        v1 = find_vector(store, left);
-        v2 = find_vector(store, right);
-        if (!v1 || !v2) {
-            return 0;
-        }
-        *result = sub(*v1, *v2);
-        return 1;
-    }
-    // vector * vector (dot product)
-    else if (op == '*') {
-        v1 = find_vector(store, left);
-        v2 = find_vector(store, right);
-        if (!v1 || !v2) {
-            return 0;
-        }
-        float dot = dot_prod(*v1, *v2);
-        result->x = dot;
-        result->y = result->z = 0;
-        return 1;
+    value.row = NULL;
+    if (store->rows != NULL || expr_run(store, expr, &value, error) != EXPR_OK) {
+        return 0;
     }
-    // vector x vector (cross product)
-    else if (op == 'x' || op == 'X') {
-        v1 = find_vector(store, left);
-        v2 = find_vector(store, right);
-        if (!v1 || !v2) {
-            return 0;
-        }
-        *result = cross_prod(*v1, *v2);
-        return 1;
+    if (value.type == EXPR_SCALAR) {
+        result->x = value.s;
+    } else {
+        result->x = value.v.x;
+        result->y = value.v.y;
+        result->z = value.v.z;
     }
-
-    return 0;
+    return 1;
 }
@@ -12,21 +12,41 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 #define INITIAL_CAPACITY 5
+#define MAX_VECTORS (1 << 28)   /**< Address space reserved for this many vectors. */
+#define NO_HANDLE NO_NAME       /**< A handle that refers to no vector. */
+
+#include "arena.h"
+#include "intern.h"
+
+#define MAX_ROW_BYTES ((size_t)1 << 40) /**< Address space reserved for rows. */
 
 /**
  * @brief Represents a named 3D vector with x, y, and z components.
  * 
- * This structure is used to store both the vector’s name
- * and its numerical components for mathematical operations.
+ * The name is stored once in the store's name table and referred to by
+ * id, which keeps the record at 16 bytes and lets names be any length.
+ * Vectors that are not stored (intermediate results) have id NO_NAME.
  */
 typedef struct
 {
-    char name[10];  /**< The vector’s name identifier (max 9 chars). */
     float x;        /**< The x-component of the vector. */
     float y;        /**< The y-component of the vector. */
     float z;        /**< The z-component of the vector. */
+    name_id id;     /**< The vector’s interned name. */
 } vector;
 
+_Static_assert(sizeof(vector) == 16, "vector records must stay 16 bytes");
+
+/**
+ * @brief A stable reference to a stored vector.
+ *
+ * A handle is the id of the vector's name: it stays valid while a vector
+ * of that name is stored and can be cached (as compiled expressions do)
+ * to skip the name lookup. Deleting the vector invalidates its handle and
+ * clearing the store invalidates every handle.
+ */
+typedef name_id vector_handle;
+
 /**
  * @brief Represents a collection of stored vectors.
  * 
@@ -36,9 +56,27 @@ typedef struct
  * storage and management into one unit.
  */
 typedef struct {
-    vector *vectors;   /**< Dynamically allocated array of vectors. */
+    vector *vectors;   /**< Array of vectors; never moves (see arena). */
     int count;         /**< Number of vectors currently stored. */
-    int capacity;      /**< Total allocated slots. */
+    int capacity;      /**< Total usable slots. */
+    Arena arena;       /**< Block-committed memory behind vectors. */
+    NameTable names;   /**< Every name ever stored since the last clear. */
+    int *handle_slots; /**< Slot of the vector with each name id (-1 = none). */
+    uint32_t handle_count; /**< Entries of handle_slots initialized. */
+    Arena handle_arena;/**< Block-committed memory behind handle_slots. */
+    int dim;           /**< Components per vector (3 unless set by dim or load). */
+    int row_stride;    /**< Floats from one row to the next (see wide_stride). */
+    float *rows;       /**< Components of every vector when dim != 3, else NULL. */
+    Arena row_arena;   /**< Block-committed memory behind rows. */
+    int quiet;         /**< Nonzero suppresses per-vector add/clear messages. */
+    int precision;     /**< Decimals in saved CSV files, or -1 for the shortest exact text. */
+    int generation;    /**< Bumped whenever slots are invalidated (e.g., clear). */
+    struct ExprCache *exprs; /**< Compiled expressions keyed by source text. */
+    struct WorkerPool *pool; /**< Threads for bulk jobs, or NULL to run serially. */
+    struct KdTree *kd;       /**< Nearest-neighbour index, built on first use. */
+    struct FormulaSet *formulas; /**< Formula bindings (c := a + b), or NULL. */
+    struct TransformSet *transforms; /**< Named matrices and quaternions, or NULL. */
+    struct Journal *journal; /**< Change journal, or NULL when not journaling. */
 } VectorStore;
 
 /* ==================== Initialization and Cleanup ==================== */
@@ -104,22 +142,221 @@ vector cross_prod(vector a, vector b);
  * @brief Adds or replaces a vector in the vector store. 
  * If a vector with the same name already exists, it is replaced. 
  * If there is capacity remaining, the vector is appended. 
+ * A confirmation line is printed unless store->quiet is set.
  * @param store Pointer to the VectorStore where the vector is stored. 
- * @param v The vector to add or replace. 
+ * @param v The vector to add or replace; v.id must come from store_name.
  * @return 1 if successful, 0 if the store is full. 
  */
 int add_vector(VectorStore *store, vector v);
 
+/**
+ * @brief Ensures the store can hold at least capacity vectors without
+ * further allocation, growing the name table to match.
+ * @param store Pointer to the VectorStore to grow.
+ * @param capacity Minimum number of slots required.
+ * @return 1 if successful, 0 if memory allocation failed.
+ */
+int reserve_vectors(VectorStore *store, int capacity);
+
+/**
+ * @brief Removes one vector in O(1).
+ *
+ * The last vector moves into the freed slot, so slot order is not kept;
+ * handles to the other vectors stay valid. A formula bound to the name is
+ * dropped, and formulas that read it keep their values as plain vectors.
+ * A confirmation line is printed unless store->quiet is set.
+ *
+ * @param store Pointer to the VectorStore to remove from.
+ * @param handle The vector to remove, from find_handle.
+ * @return 1 if successful, 0 if the handle names no stored vector.
+ */
+int delete_vector(VectorStore *store, vector_handle handle);
+
+/**
+ * @brief Returns memory the store holds beyond what its vectors need,
+ * e.g., after a clear or many deletes.
+ * @param store Pointer to the VectorStore to shrink.
+ * @return 1 if successful, 0 if some memory could not be released (the
+ *         store stays usable).
+ */
+int shrink_vectors(VectorStore *store);
+
+/**
+ * @brief Measures the memory behind the store's vectors: records, rows,
+ * slot table and names (caches and indexes are not counted).
+ * @param store Pointer to the VectorStore to measure.
+ * @param used Receives the bytes holding live vectors and names.
+ * @return The bytes allocated for them.
+ */
+size_t store_memory(const VectorStore *store, size_t *used);
+
+/**
+ * @brief Prints how much memory each part of the store uses and holds.
+ * @param store Pointer to the VectorStore to report on.
+ */
+void print_memory(const VectorStore *store);
+
+/**
+ * @brief Adds or replaces a vector of the store's dimension.
+ * Behaves like add_vector, but takes the components as a row, so it works
+ * for any dimension.
+ * @param store Pointer to the VectorStore where the vector is stored.
+ * @param id The vector's name, from store_name.
+ * @param row store->dim components.
+ * @return 1 if successful, 0 if memory allocation failed.
+ */
+int add_row(VectorStore *store, name_id id, const float *row);
+
+/**
+ * @brief Adds or replaces a batch of vectors without per-vector messages.
+ * Vectors are applied in order, so a later duplicate name replaces an
+ * earlier one. Capacity is reserved once for the whole batch.
+ * @param store Pointer to the VectorStore to add to.
+ * @param batch Array of vectors to add, named with ids from store_name.
+ * @param rows store->dim components per vector, packed, when dim is not 3;
+ *             NULL to take the components from batch.
+ * @param n Number of vectors in batch.
+ * @return 1 if successful, 0 if memory allocation failed.
+ */
+int append_vectors(VectorStore *store, const vector *batch, const float *rows, int n);
+
+/**
+ * @brief Fills an empty store from a packed component block.
+ *
+ * Used by the snapshot loader. The store takes over names as its name
+ * table, so row i is the vector whose name has id i and nothing is
+ * hashed again. When rows need no padding the whole block is one memcpy
+ * into the row arena; otherwise each row (or, for dimension 3, each
+ * record, which also holds the name id) takes one copy.
+ *
+ * @param store Pointer to the empty VectorStore to fill.
+ * @param names Exactly n distinct names, in row order. It is taken over
+ *              (or freed on failure) and left empty.
+ * @param rows n * store->dim components, packed.
+ * @param n Number of vectors.
+ * @return 1 if successful, 0 if memory ran out or names does not hold n names.
+ */
+int fill_vectors(VectorStore *store, NameTable *names, const float *rows, int n);
+
+/**
+ * @brief Sets the number of components per vector, clearing the store.
+ *
+ * Stores of dimension 3 keep components in the vector records. Any other
+ * dimension keeps them in contiguous rows aligned to WIDE_ALIGNMENT, so
+ * the wide kernels stream through them. The dimension is fixed until it
+ * is set again (directly or by loading a file).
+ *
+ * @param store Pointer to the VectorStore to reshape.
+ * @param dim Components per vector (1 to WIDE_MAX_DIM).
+ * @return 1 if successful, 0 if dim is out of range or memory ran out.
+ */
+int set_dimension(VectorStore *store, int dim);
+
+/**
+ * @brief Returns the components of a stored vector.
+ * @param store Pointer to the VectorStore holding the vector.
+ * @param v A vector in store->vectors.
+ * @return store->dim contiguous floats (for dimension 3, &v->x).
+ */
+float *vector_row(const VectorStore *store, const vector *v);
+
+/**
+ * @brief Prints a vector as "name = c0  c1  ...".
+ * @param name The name to print.
+ * @param components The components.
+ * @param dim Number of components.
+ */
+void print_components(const char *name, const float *components, int dim);
+
 /** 
  * @brief Searches the vector store for a vector by its name. 
+ * The name is hashed once to find its id in the name table; the id then
+ * indexes the slot table directly, so the lookup costs O(1) on average
+ * regardless of how many vectors are stored.
  * @param store Pointer to the VectorStore to search. 
  * @param name The name of the vector to find. 
  * @return A pointer to the found vector, or NULL if not found. 
  */
 vector *find_vector(VectorStore *store, const char *name);
 
+/**
+ * @brief Looks up the stable handle of a stored vector.
+ * @param store Pointer to the VectorStore to search.
+ * @param name The name of the vector to find.
+ * @return The vector's handle, or NO_HANDLE if not found.
+ */
+vector_handle find_handle(VectorStore *store, const char *name);
+
+/**
+ * @brief Interns a name in the store so vectors can be stored under it.
+ * @param store Pointer to the VectorStore whose name table to extend.
+ * @param name First character of the name (need not be null-terminated).
+ * @param length Number of characters in the name.
+ * @return The name's id, or NO_NAME if memory allocation failed.
+ */
+name_id store_name(VectorStore *store, const char *name, size_t length);
+
+/**
+ * @brief Returns the name of a stored vector.
+ * @param store Pointer to the VectorStore holding the name table.
+ * @param v The vector.
+ * @return The null-terminated name, valid until the next name is stored.
+ */
+const char *vector_name(const VectorStore *store, const vector *v);
+
+/**
+ * @brief Resolves a handle to its vector without any name lookup.
+ * @param store Pointer to the VectorStore that issued the handle.
+ * @param handle A handle from find_handle.
+ * @return A pointer to the vector, or NULL if the handle is no longer valid.
+ */
+vector *handle_vector(VectorStore *store, vector_handle handle);
+
+/**
+ * @brief Looks up a vector for reading, first recomputing it if it is a
+ * formula whose inputs changed.
+ * @param store Pointer to the VectorStore to search.
+ * @param name The name of the vector to read.
+ * @return A pointer to the current vector, or NULL if not found.
+ */
+vector *read_vector(VectorStore *store, const char *name);
+
+/**
+ * @brief Recomputes every formula whose inputs changed, so the whole
+ * store can be read (list, save, reductions, bulk updates).
+ * @param store Pointer to the VectorStore to bring up to date.
+ * @return 1 if successful, 0 if some formula lost an input.
+ */
+int refresh_vectors(VectorStore *store);
+
+/**
+ * @brief Finds the k stored vectors closest to a point.
+ *
+ * Backed by a k-d tree that is built by the first query and then kept
+ * current as vectors are added or replaced, so a query costs O(log N)
+ * rather than a scan of the whole store.
+ *
+ * @param store Pointer to the VectorStore to search.
+ * @param q The query point (its name is ignored).
+ * @param k Number of neighbours wanted.
+ * @param out Receives up to k pointers into the store, nearest first.
+ * @param dist Receives the Euclidean distance of each result.
+ * @return The number of results (min(k, count)), or -1 on allocation failure.
+ */
+int nearest_vectors(VectorStore *store, vector q, int k, vector **out, float *dist);
+
+/**
+ * @brief Tells the store's derived indexes that vectors were modified in
+ * place, e.g., by a bulk update.
+ * @param store Pointer to the VectorStore that changed.
+ * @param slot Position of the single vector that changed, or -1 for many.
+ */
+void note_vector_change(VectorStore *store, int slot);
+
 /** 
  * @brief Removes all vectors from the vector store. 
+ * The memory is kept for reuse; shrink_vectors gives it back.
+ * A confirmation line is printed unless store->quiet is set.
  * @param store Pointer to the VectorStore to clear. 
  */
 void clear_vectors(VectorStore *store);
@@ -135,7 +372,9 @@ void list_vectors(const VectorStore *store);
 /** 
  * @brief Evaluates a vector expression such as "a + b", "a x b", or "2 * a". 
  * Supports addition, subtraction, dot and cross products, 
- * and scalar multiplication between defined vectors. 
+ * and scalar multiplication between defined vectors, chained with the
+ * usual precedence and parentheses (e.g., "(a + b) x c * 2 - e").
+ * A scalar result is returned in x with y and z set to 0.
  * @param store Pointer to the VectorStore containing available vectors. 
  * @param expr The expression string to evaluate. 
  * @param result Pointer to a vector where the result is stored. 
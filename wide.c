@@ -0,0 +1,255 @@
+/**
+ * @file      : wide.c
+ * @brief     : Defines the kernels for vectors of any dimension, stored
+ *              as contiguous aligned rows.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#include "wide.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WIDE_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * The dot product accumulates element i into lane i % WIDE_LANES. AVX-512
+ * holds the lanes in one register, AVX2 in two, SSE in four and the scalar
+ * fallback in an array; products are rounded before they are added (no
+ * FMA), so every kernel performs the same IEEE operations per lane.
+ */
+#define WIDE_LANES 16
+
+/* ==================== Kernel Implementations ==================== */
+
+/** Signature of the element-wise add/sub kernels. */
+typedef void (*binop_fn)(const float *a, const float *b, float *out, int n);
+
+/** Signature of the scaling kernels. */
+typedef void (*scale_fn)(float s, const float *a, float *out, int n);
+
+/** Signature of the lane-wise dot product kernels. */
+typedef void (*dot_fn)(const float *a, const float *b, int n, float *lanes);
+
+/**
+ * @brief One complete set of kernels for a single instruction set.
+ */
+typedef struct {
+    simd_level_t level;
+    binop_fn add;
+    binop_fn sub;
+    scale_fn scale;
+    dot_fn dot;
+} WideKernels;
+
+// Scalar fallbacks, also used for the tails of the SIMD loops
+#define SCALAR_BINOP(name, op)                                              \
+    static void name(const float *a, const float *b, float *out, int n) {   \
+        for (int i = 0; i < n; i++) {                                       \
+            out[i] = a[i] op b[i];                                          \
+        }                                                                   \
+    }
+
+SCALAR_BINOP(scalar_add, +)
+SCALAR_BINOP(scalar_sub, -)
+
+static void scalar_scale(float s, const float *a, float *out, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = s * a[i];
+    }
+}
+
+// Adds a[i] * b[i] to lane i % WIDE_LANES; n need not be a multiple
+static void scalar_dot(const float *a, const float *b, int n, float *lanes) {
+    for (int i = 0; i < n; i++) {
+        float product = a[i] * b[i];
+        lanes[i % WIDE_LANES] += product;
+    }
+}
+
+static const WideKernels scalar_kernels = {
+    SIMD_SCALAR, scalar_add, scalar_sub, scalar_scale, scalar_dot
+};
+
+#ifdef WIDE_X86
+
+/*
+ * The SSE, AVX2 and AVX-512 kernels are stamped out from the same
+ * templates; only the register type, lane count and intrinsics differ.
+ * Dot kernels keep WIDE_LANES / lanes accumulators.
+ */
+#define SIMD_BINOP(name, isa, type, lanes, load, store, intr, op)           \
+    __attribute__((target(isa)))                                           \
+    static void name(const float *a, const float *b, float *out, int n) {     \
+        int i = 0;                                                            \
+        for (; i + lanes <= n; i += lanes) {                                  \
+            store(out + i, intr(load(a + i), load(b + i)));                   \
+        }                                                                     \
+        for (; i < n; i++) {                                                  \
+            out[i] = a[i] op b[i];                                            \
+        }                                                                     \
+    }
+
+#define SIMD_SCALE(name, isa, type, lanes, load, store, set1, mul)          \
+    __attribute__((target(isa)))                                           \
+    static void name(float s, const float *a, float *out, int n) {            \
+        type vs = set1(s);                                                    \
+        int i = 0;                                                            \
+        for (; i + lanes <= n; i += lanes) {                                  \
+            store(out + i, mul(vs, load(a + i)));                             \
+        }                                                                     \
+        scalar_scale(s, a + i, out + i, n - i);                               \
+    }
+
+#define SIMD_DOT(name, isa, type, lanes, load, store, mul, addp)            \
+    __attribute__((target(isa)))                                           \
+    static void name(const float *a, const float *b, int n, float *acc) {     \
+        enum { REGS = WIDE_LANES / lanes };                                   \
+        type sum[REGS];                                                       \
+        for (int r = 0; r < REGS; r++) {                                      \
+            sum[r] = load(acc + r * lanes);                                   \
+        }                                                                     \
+        int i = 0;                                                            \
+        for (; i + WIDE_LANES <= n; i += WIDE_LANES) {                        \
+            for (int r = 0; r < REGS; r++) {                                  \
+                const float *pa = a + i + r * lanes;                          \
+                const float *pb = b + i + r * lanes;                          \
+                sum[r] = addp(sum[r], mul(load(pa), load(pb)));               \
+            }                                                                 \
+        }                                                                     \
+        for (int r = 0; r < REGS; r++) {                                      \
+            store(acc + r * lanes, sum[r]);                                   \
+        }                                                                     \
+        /* The tail starts at a multiple of WIDE_LANES, so lanes line up */   \
+        scalar_dot(a + i, b + i, n - i, acc);                                 \
+    }
+
+SIMD_BINOP(sse_add, "sse2", __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_add_ps, +)
+SIMD_BINOP(sse_sub, "sse2", __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_sub_ps, -)
+SIMD_SCALE(sse_scale, "sse2", __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_mul_ps)
+SIMD_DOT(sse_dot, "sse2", __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_mul_ps, _mm_add_ps)
+
+SIMD_BINOP(avx2_add, "avx2", __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, +)
+SIMD_BINOP(avx2_sub, "avx2", __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_sub_ps, -)
+SIMD_SCALE(avx2_scale, "avx2", __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps,
+           _mm256_mul_ps)
+SIMD_DOT(avx2_dot, "avx2", __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_mul_ps,
+         _mm256_add_ps)
+
+SIMD_BINOP(avx512_add, "avx512f", __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, +)
+SIMD_BINOP(avx512_sub, "avx512f", __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_sub_ps, -)
+SIMD_SCALE(avx512_scale, "avx512f", __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps,
+           _mm512_set1_ps, _mm512_mul_ps)
+SIMD_DOT(avx512_dot, "avx512f", __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_mul_ps,
+         _mm512_add_ps)
+
+static const WideKernels sse_kernels = {
+    SIMD_SSE, sse_add, sse_sub, sse_scale, sse_dot
+};
+
+static const WideKernels avx2_kernels = {
+    SIMD_AVX2, avx2_add, avx2_sub, avx2_scale, avx2_dot
+};
+
+static const WideKernels avx512_kernels = {
+    SIMD_AVX512, avx512_add, avx512_sub, avx512_scale, avx512_dot
+};
+
+#endif /* WIDE_X86 */
+
+/**
+ * @brief Picks the widest kernel set the CPU supports.
+ * @return Pointer to the kernel table to use for this process.
+ */
+static const WideKernels *kernels(void) {
+#ifdef WIDE_X86
+    simd_level_t level = simd_level();
+    if (level >= SIMD_AVX512) {
+        return &avx512_kernels;
+    }
+    if (level >= SIMD_AVX2) {
+        return &avx2_kernels;
+    }
+    if (level >= SIMD_SSE) {
+        return &sse_kernels;
+    }
+#endif
+    return &scalar_kernels;
+}
+
+/* ==================== Public Kernels ==================== */
+
+/**
+ * @brief Returns the distance between consecutive rows, in floats.
+ * @param dim - Components per vector.
+ * @return Floats per row.
+ */
+int wide_stride(int dim) {
+    int line = WIDE_ALIGNMENT / (int)sizeof(float);
+    return (dim + line - 1) / line * line;
+}
+
+/**
+ * @brief Adds two rows (out = a + b).
+ * @param a - First row.
+ * @param b - Second row.
+ * @param out - Receives the sum.
+ * @param dim - Components per row.
+ */
+void wide_add(const float *a, const float *b, float *out, int dim) {
+    kernels()->add(a, b, out, dim);
+}
+
+/**
+ * @brief Subtracts two rows (out = a - b).
+ * @param a - Row to subtract from.
+ * @param b - Row to subtract.
+ * @param out - Receives the difference.
+ * @param dim - Components per row.
+ */
+void wide_sub(const float *a, const float *b, float *out, int dim) {
+    kernels()->sub(a, b, out, dim);
+}
+
+/**
+ * @brief Scales a row (out = s * a).
+ * @param s - The scale factor.
+ * @param a - The row.
+ * @param out - Receives the scaled row.
+ * @param dim - Components per row.
+ */
+void wide_scale(float s, const float *a, float *out, int dim) {
+    kernels()->scale(s, a, out, dim);
+}
+
+/**
+ * @brief Computes the dot product of two rows.
+ * @param a - First row.
+ * @param b - Second row.
+ * @param dim - Components per row.
+ * @return The dot product.
+ */
+float wide_dot(const float *a, const float *b, int dim) {
+    float lanes[WIDE_LANES] = {0};
+    kernels()->dot(a, b, dim, lanes);
+    // Pairwise combination in a fixed order
+    for (int width = WIDE_LANES / 2; width > 0; width /= 2) {
+        for (int i = 0; i < width; i++) {
+            lanes[i] += lanes[i + width];
+        }
+    }
+    return lanes[0];
+}
+
+/**
+ * @brief Returns the instruction set the kernels dispatch to.
+ * @return The simd_level_t chosen at runtime.
+ */
+simd_level_t wide_kernel_level(void) {
+    return kernels()->level;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file      : wide.h
+ * @brief     : Declares the kernels for vectors of any dimension, stored
+ *              as contiguous aligned rows.
+ *
+ * Name       : rostj@msoe.edu <Jesse Rost>
+ * Date       : 10/15/26
+ * Course     : CPE 2600
+ * Assignment : Lab 7
+ * Section    : 112
+ */
+
+#ifndef WIDE_H
+#define WIDE_H
+
+#include "simd.h"
+
+#define WIDE_ALIGNMENT 64     /**< Rows start on a cache line boundary. */
+#define WIDE_MAX_DIM   4096   /**< Largest supported dimension. */
+
+/**
+ * @brief Returns the distance between consecutive rows, in floats.
+ * The dimension is rounded up to a whole number of cache lines, so every
+ * row of a WIDE_ALIGNMENT-aligned block starts aligned.
+ * @param dim Components per vector.
+ * @return Floats per row.
+ */
+int wide_stride(int dim);
+
+/*
+ * The kernels below take the dimension once per call and never check it
+ * per element; out may alias an input.
+ */
+
+/**
+ * @brief Adds two rows (out = a + b).
+ */
+void wide_add(const float *a, const float *b, float *out, int dim);
+
+/**
+ * @brief Subtracts two rows (out = a - b).
+ */
+void wide_sub(const float *a, const float *b, float *out, int dim);
+
+/**
+ * @brief Scales a row (out = s * a).
+ */
+void wide_scale(float s, const float *a, float *out, int dim);
+
+/**
+ * @brief Computes the dot product of two rows.
+ *
+ * Products are accumulated in WIDE_LANES lanes that are combined in a
+ * fixed order, so every kernel returns the same bits.
+ *
+ * @return The dot product.
+ */
+float wide_dot(const float *a, const float *b, int dim);
+
+/**
+ * @brief Returns the instruction set the kernels dispatch to.
+ * @return The simd_level_t chosen at runtime (AVX-512, AVX2, SSE or scalar).
+ */
+simd_level_t wide_kernel_level(void);
+
+#endif /* WIDE_H */